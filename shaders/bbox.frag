@@ -0,0 +1,5 @@
+#version 450
+
+// Occlusion test boxes only count samples passing the depth test; colour writes are masked off
+void main() {
+}
@@ -0,0 +1,28 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform Box {
+    vec4 boxMin;
+    vec4 boxMax;
+} box;
+
+// Two triangles per face; corner bits are x = 1, y = 2, z = 4
+const int CORNERS[36] = int[36](
+    0, 2, 6, 0, 6, 4,   // -x
+    1, 5, 7, 1, 7, 3,   // +x
+    0, 4, 5, 0, 5, 1,   // -y
+    2, 3, 7, 2, 7, 6,   // +y
+    0, 1, 3, 0, 3, 2,   // -z
+    4, 6, 7, 4, 7, 5    // +z
+);
+
+void main() {
+    int corner = CORNERS[gl_VertexIndex];
+    vec3 t = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+    gl_Position = ubo.proj * ubo.view * vec4(mix(box.boxMin.xyz, box.boxMax.xyz, t), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 450
+
+// cull_bench: draws the culled chunk list with rasterization off and records, per chunk slot,
+// the vertex range vkCmdDrawIndirectCount actually ran. gl_InstanceIndex is the slot
+// (cull.comp puts it in firstInstance).
+
+// Lowest gl_VertexIndex seen; cleared to 0xffffffff
+layout(std430, set = 0, binding = 0) buffer DrawnFirst {
+    uint drawnFirst[];
+};
+
+// Highest gl_VertexIndex + 1; cleared to 0
+layout(std430, set = 0, binding = 1) buffer DrawnEnd {
+    uint drawnEnd[];
+};
+
+void main() {
+    atomicMin(drawnFirst[gl_InstanceIndex], uint(gl_VertexIndex));
+    atomicMax(drawnEnd[gl_InstanceIndex], uint(gl_VertexIndex) + 1u);
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+}
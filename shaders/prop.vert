@@ -0,0 +1,30 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Prop mesh (same format as terrain vertices)
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// Per instance, see PropInstance in src/scatter.h
+layout(location = 2) in vec3 instancePosition;
+layout(location = 3) in vec2 instanceYawScale;  // Unorm: turns, scale / MAX_PROP_SCALE
+
+layout(location = 0) out vec3 fragColor;
+
+// Set from MAX_PROP_SCALE in src/scatter.h when the pipeline is created
+layout(constant_id = 0) const float MAX_PROP_SCALE = 2.0;
+
+void main() {
+    float yaw = instanceYawScale.x * 6.28318530718;
+    float scale = instanceYawScale.y * MAX_PROP_SCALE;
+    vec3 p = inPosition * scale;
+    p.xz = mat2(cos(yaw), sin(yaw), -sin(yaw), cos(yaw)) * p.xz;
+    gl_Position = ubo.proj * ubo.view * vec4(instancePosition + p, 1.0);
+    // Size variation shows up as a slight brightness change too
+    fragColor = inColor * (0.85 + 0.3 * instanceYawScale.y);
+}
@@ -1,5 +1,6 @@
 #include "camera.h"
 #include "chunk_manager.h"
+#include "navigation.h"
 #include <algorithm>
 #include <iostream>
 
@@ -164,20 +165,18 @@ void Camera::jump() {
 }
 
 // Sample SDF at a world position
-float sampleSDF(const ChunkManager& chunkManager, glm::vec3 worldPos) {
+float sampleSDF(ChunkManager& chunkManager, glm::vec3 worldPos) {
     ChunkCoord chunkCoord = worldToChunkCoord(worldPos);
 
-    // Find the chunk
+    // Find the chunk; without a generated one, evaluate the terrain directly so fast
+    // travel can't outrun the chunk pipeline and fall through the world
     const auto& chunks = chunkManager.getChunks();
     auto it = chunks.find(chunkCoord);
-    if (it == chunks.end()) {
-        return -10.0f;  // No chunk = air
+    if (it == chunks.end() || !it->second->sdfReady.load()) {
+        return chunkManager.getCollisionFallback().sample(worldPos);
     }
 
     const VolumeChunk* chunk = it->second.get();
-    if (!chunk->sdfReady.load()) {
-        return -10.0f;  // Chunk not generated yet
-    }
     glm::vec3 chunkWorldPos = chunkToWorldPos(chunkCoord);
     glm::vec3 localPos = worldPos - chunkWorldPos;
 
@@ -188,35 +187,19 @@ float sampleSDF(const ChunkManager& chunkManager, glm::vec3 worldPos) {
     if (voxelPos.x < 0 || voxelPos.x >= CHUNK_SIZE - 1 ||
         voxelPos.y < 0 || voxelPos.y >= CHUNK_SIZE - 1 ||
         voxelPos.z < 0 || voxelPos.z >= CHUNK_SIZE - 1) {
-        return -10.0f;
+        return chunkManager.getCollisionFallback().sample(worldPos);  // Rounded onto the far face
     }
 
     // Trilinear interpolation
     int x0 = (int)voxelPos.x;
     int y0 = (int)voxelPos.y;
     int z0 = (int)voxelPos.z;
-    int x1 = x0 + 1;
-    int y1 = y0 + 1;
-    int z1 = z0 + 1;
-
-    float fx = voxelPos.x - x0;
-    float fy = voxelPos.y - y0;
-    float fz = voxelPos.z - z0;
-
-    // Interpolate
-    float c00 = chunk->sdf[x0][y0][z0] * (1 - fx) + chunk->sdf[x1][y0][z0] * fx;
-    float c01 = chunk->sdf[x0][y0][z1] * (1 - fx) + chunk->sdf[x1][y0][z1] * fx;
-    float c10 = chunk->sdf[x0][y1][z0] * (1 - fx) + chunk->sdf[x1][y1][z0] * fx;
-    float c11 = chunk->sdf[x0][y1][z1] * (1 - fx) + chunk->sdf[x1][y1][z1] * fx;
 
-    float c0 = c00 * (1 - fy) + c10 * fy;
-    float c1 = c01 * (1 - fy) + c11 * fy;
-
-    return c0 * (1 - fz) + c1 * fz;
+    return chunk->sdfTrilinear(x0, y0, z0, voxelPos.x - x0, voxelPos.y - y0, voxelPos.z - z0);
 }
 
 // Helper: Calculate SDF gradient (surface normal)
-glm::vec3 calculateSDFNormal(const ChunkManager& chunkManager, glm::vec3 pos) {
+glm::vec3 calculateSDFNormal(ChunkManager& chunkManager, glm::vec3 pos) {
     float step = 0.1f;
     float dx = sampleSDF(chunkManager, pos + glm::vec3(step, 0, 0)) -
                sampleSDF(chunkManager, pos - glm::vec3(step, 0, 0));
@@ -257,10 +240,8 @@ void Camera::updatePhysics(float deltaTime, ChunkManager& chunkManager) {
         // Near or in ground - calculate ground normal
         groundNormal = -calculateSDFNormal(chunkManager, feetPos);  // Invert (points away from solid)
 
-        // Check slope angle
-        float slopeAngle = glm::degrees(std::acos(glm::clamp(glm::dot(groundNormal, glm::vec3(0, 1, 0)), -1.0f, 1.0f)));
-
-        if (slopeAngle <= maxWalkableSlope) {
+        // Check slope angle (the same rule builds the AI navigation graphs)
+        if (isWalkableSlope(groundNormal, maxWalkableSlope)) {
             // Walkable slope
             onGround = true;
             jumpsRemaining = 2;  // Reset double jump when on ground
@@ -1,10 +1,14 @@
 #pragma once
 
-#include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <cstdint>
 #include <functional>
 #include <atomic>
+#include <memory>
+#include <array>
+#include "sdf_grid.h"
+#include "occlusion.h"
+#include "vertex_arena.h"
 
 // Chunk size constants
 constexpr int CHUNK_CUBES = 32;     // 32x32x32 marching cubes grid
@@ -12,6 +16,24 @@ constexpr int CHUNK_SIZE = CHUNK_CUBES + 1;  // 33x33x33 voxel grid (need +1 for
 constexpr float CHUNK_WORLD_SIZE = 16.0f;  // 16 meters per chunk
 constexpr float VOXEL_SIZE = CHUNK_WORLD_SIZE / CHUNK_CUBES;  // Size of each cube (0.5m)
 
+// Props scattered over chunk surfaces (see scatter.h); each type is one instanced draw
+enum class PropType {
+    Rock,
+    Shrub,
+    Count
+};
+constexpr int PROP_TYPE_COUNT = static_cast<int>(PropType::Count);
+
+// SDF storage order, picked at build time (CMake option SDF_LAYOUT)
+#if defined(SDF_LAYOUT_TILED4)
+using ChunkSdfLayout = Tiled4Layout<CHUNK_CUBES>;
+#elif defined(SDF_LAYOUT_MORTON)
+using ChunkSdfLayout = MortonLayout<CHUNK_CUBES>;
+#else
+using ChunkSdfLayout = RowMajorLayout<CHUNK_CUBES>;
+#endif
+using ChunkSdfGrid = SdfGrid<ChunkSdfLayout>;
+
 // Chunk coordinate in chunk space (not world space)
 struct ChunkCoord {
     int x, y, z;
@@ -25,6 +47,19 @@ struct ChunkCoord {
     }
 };
 
+// Column coordinate in chunk space (a vertical stack of chunks sharing x/z)
+struct ColumnCoord {
+    int x, z;
+
+    bool operator==(const ColumnCoord& other) const {
+        return x == other.x && z == other.z;
+    }
+
+    bool operator!=(const ColumnCoord& other) const {
+        return !(*this == other);
+    }
+};
+
 // Hash function for ChunkCoord (for unordered_map)
 namespace std {
     template<>
@@ -37,41 +72,127 @@ namespace std {
             return h1 ^ (h2 << 1) ^ (h3 << 2);
         }
     };
+
+    template<>
+    struct hash<ColumnCoord> {
+        size_t operator()(const ColumnCoord& c) const {
+            size_t h1 = hash<int>()(c.x);
+            size_t h2 = hash<int>()(c.z);
+            return h1 ^ (h2 << 1);
+        }
+    };
 }
 
+// Vertical chunk faces, as indexed in HeightfieldData::border
+enum class ChunkFace {
+    MinX,  // x = 0, along z
+    MaxX,  // x = CHUNK_CUBES, along z
+    MinZ,  // z = 0, along x
+    MaxZ,  // z = CHUNK_CUBES, along x
+    Count
+};
+
+// 2.5D stand-in for the SDF of a chunk where every column crosses the surface exactly
+// once, all in the same direction (no overhangs). Keeps the two samples bracketing each
+// crossing plus the full columns on the four vertical faces, about 27 KB instead of 144 KB.
+struct HeightfieldData {
+    uint8_t cell[CHUNK_SIZE][CHUNK_SIZE];   // [x][z]: surface lies between y = cell and cell + 1
+    float below[CHUNK_SIZE][CHUNK_SIZE];    // SDF at y = cell
+    float above[CHUNK_SIZE][CHUNK_SIZE];    // SDF at y = cell + 1
+    // [face][position along the face][y]. A volumetric neighbour's cube mesher also puts
+    // vertices on the horizontal edges of the shared face, where at() is only right in sign;
+    // the heightfield mesher takes them from here so the two meshes meet exactly.
+    float border[static_cast<int>(ChunkFace::Count)][CHUNK_SIZE][CHUNK_SIZE];
+
+    // Each column extrapolated linearly through its crossing. Exact on the two bracketing
+    // samples and has the right sign everywhere else.
+    float at(int x, int y, int z) const {
+        return below[x][z] + (above[x][z] - below[x][z]) * static_cast<float>(y - cell[x][z]);
+    }
+
+    // Same interface as SdfGrid::trilinear; linear in y, so only the four columns are read
+    float trilinear(int x0, int y0, int z0, float fx, float fy, float fz) const {
+        float y = y0 + fy;
+        auto column = [&](int x, int z) {
+            return below[x][z] + (above[x][z] - below[x][z]) * (y - cell[x][z]);
+        };
+        float c0 = column(x0, z0) * (1 - fx) + column(x0 + 1, z0) * fx;
+        float c1 = column(x0, z0 + 1) * (1 - fx) + column(x0 + 1, z0 + 1) * fx;
+        return c0 * (1 - fz) + c1 * fz;
+    }
+};
+
 // Chunk containing SDF volume data
 struct VolumeChunk {
     ChunkCoord coord;
 
-    // SDF volume data: positive = inside solid, negative = air, 0 = surface
-    float sdf[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
+    // SDF volume data: positive = inside solid, negative = air, 0 = surface.
+    // Released when the chunk is compacted to a heightfield; exactly one of the two is set.
+    std::unique_ptr<ChunkSdfGrid> sdf;
+    std::unique_ptr<HeightfieldData> heightfield;
 
-    // Vulkan mesh data (generated from SDF)
-    VkBuffer vertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+    // Mesh data (generated from SDF): vertices, then prop instances, in the shared vertex arena
+    ArenaRange mesh;
     uint32_t vertexCount = 0;
+    uint32_t trianglesRemoved = 0;  // Degenerate/sliver triangles the mesher dropped
+    // Prop instances, stored in `mesh` after the vertices and grouped by type (render thread only)
+    std::array<uint32_t, PROP_TYPE_COUNT> propCounts{};
+    ChunkVisibility visibility;     // Occlusion culling history (render thread only)
+    bool culled = false;            // Skipped by frustum/occlusion culling last frame (render thread only)
+    // Culling (render thread only): bounds of what the chunk draws, props included, and how far
+    // up from its bottom the SDF is solid everywhere (see countSolidBase, for the horizon)
+    glm::vec3 drawnMin{0.0f};
+    glm::vec3 drawnMax{0.0f};
+    int solidBase = 0;
+
+    // Last generation and meshing cost, for the streaming overlay
+    std::atomic<float> generationMs{0.0f};
+    std::atomic<float> meshMs{0.0f};
 
     // State flags
     bool meshGenerated = false;
     bool meshUploaded = false;
+    bool meshCoarse = false;         // Drawing the first-pass coarse mesh (render thread only)
+    bool fullMeshSubmitted = false;  // Full-resolution mesh uploading or installed (render thread only)
     std::atomic<bool> sdfReady{false};
+    std::atomic<bool> sdfClaimed{false};  // Set by whichever path (queue or urgent lane) fills the SDF
     std::atomic<bool> generationQueued{false};
     std::atomic<bool> generationInProgress{false};
     std::atomic<bool> uploadInProgress{false};
 
+    // Residency tiers: render-tier chunks get a mesh; collision residency (keeping the SDF)
+    // is decided separately by distance, see VulkanApp::updateResidencyTiers
+    std::atomic<bool> renderTier{true};
+    std::atomic<bool> meshBuilt{false};  // Mesh made from the current SDF (claimed by whoever meshes)
+
     // Bounding box in world space
     glm::vec3 worldMin;
     glm::vec3 worldMax;
 
     VolumeChunk() {
-        // Initialize SDF to "air" everywhere
-        for (int x = 0; x < CHUNK_SIZE; x++) {
-            for (int y = 0; y < CHUNK_SIZE; y++) {
-                for (int z = 0; z < CHUNK_SIZE; z++) {
-                    sdf[x][y][z] = -1.0f;  // Air
-                }
-            }
+        resetSdf();
+    }
+
+    // Full SDF initialised to "air" everywhere, dropping any heightfield (before (re)generation)
+    void resetSdf() {
+        if (!sdf) {
+            sdf = std::make_unique<ChunkSdfGrid>();
         }
+        sdf->fill(-1.0f);
+        heightfield.reset();
+    }
+
+    // SDF sample from whichever representation the chunk holds
+    float sdfAt(int x, int y, int z) const {
+        return sdf ? sdf->at(x, y, z) : heightfield->at(x, y, z);
+    }
+
+    float sdfTrilinear(int x0, int y0, int z0, float fx, float fy, float fz) const {
+        return sdf ? sdf->trilinear(x0, y0, z0, fx, fy, fz) : heightfield->trilinear(x0, y0, z0, fx, fy, fz);
+    }
+
+    size_t sdfMemoryBytes() const {
+        return (sdf ? sizeof(ChunkSdfGrid) : 0) + (heightfield ? sizeof(HeightfieldData) : 0);
     }
 };
 
@@ -1,5 +1,6 @@
 #include "chunk_manager.h"
 #include <iostream>
+#include <algorithm>
 
 ChunkManager::ChunkManager() {
 }
@@ -30,20 +31,49 @@ VolumeChunk* ChunkManager::getChunk(ChunkCoord coord) {
     return nullptr;
 }
 
-std::vector<VolumeChunk*> ChunkManager::updateChunks(glm::vec3 cameraPos, int loadRadius, int unloadRadius) {
+const ColumnSurfaceBounds& ChunkManager::getColumnBounds(ColumnCoord column) {
+    auto it = columnBounds.find(column);
+    if (it != columnBounds.end()) {
+        return it->second;
+    }
+    return columnBounds.emplace(column, generator.estimateColumnBounds(column)).first->second;
+}
+
+std::vector<VolumeChunk*> ChunkManager::updateChunks(glm::vec3 cameraPos, int loadRadius, int unloadRadius,
+                                                     int collisionRadius) {
     ChunkCoord cameraChunk = worldToChunkCoord(cameraPos);
     std::vector<VolumeChunk*> newChunks;
 
-    // Load chunks - use smaller vertical radius (don't need chunks far above/below)
-    int verticalRadius = 1;  // Only load 1 chunk above/below
+    // Always keep the camera's own band loaded (physics needs it even inside caves)
+    int verticalRadius = 1;
+    // Surface chunks are loaded up to the vertical unload radius so they don't thrash
+    int verticalUnloadRadius = unloadRadius * 2;
+
     for (int dx = -loadRadius; dx <= loadRadius; dx++) {
-        for (int dy = -verticalRadius; dy <= verticalRadius; dy++) {
-            for (int dz = -loadRadius; dz <= loadRadius; dz++) {
-                ChunkCoord coord = {
-                    cameraChunk.x + dx,
-                    cameraChunk.y + dy,
-                    cameraChunk.z + dz
-                };
+        for (int dz = -loadRadius; dz <= loadRadius; dz++) {
+            ColumnCoord column = {cameraChunk.x + dx, cameraChunk.z + dz};
+            const ColumnSurfaceBounds& bounds = getColumnBounds(column);
+
+            // Chunk y-range that can contain surface, clipped to the vertical window
+            int surfaceMinY = cameraChunk.y + 1;
+            int surfaceMaxY = cameraChunk.y;
+            if (bounds.hasSurface) {
+                surfaceMinY = std::max(worldToChunkCoord(glm::vec3(0.0f, bounds.minY, 0.0f)).y,
+                                       cameraChunk.y - verticalUnloadRadius);
+                surfaceMaxY = std::min(worldToChunkCoord(glm::vec3(0.0f, bounds.maxY, 0.0f)).y,
+                                       cameraChunk.y + verticalUnloadRadius);
+            }
+
+            int minY = std::min(surfaceMinY, cameraChunk.y - verticalRadius);
+            int maxY = std::max(surfaceMaxY, cameraChunk.y + verticalRadius);
+            for (int y = minY; y <= maxY; y++) {
+                bool inCameraBand = abs(y - cameraChunk.y) <= verticalRadius;
+                bool inSurfaceRange = y >= surfaceMinY && y <= surfaceMaxY;
+                if (!inCameraBand && !inSurfaceRange) {
+                    continue;
+                }
+
+                ChunkCoord coord = {column.x, y, column.z};
 
                 // Check if chunk already exists
                 auto it = chunks.find(coord);
@@ -51,14 +81,41 @@ std::vector<VolumeChunk*> ChunkManager::updateChunks(glm::vec3 cameraPos, int lo
                     // New chunk - create and add to list
                     VolumeChunk* chunk = getOrCreateChunk(coord);
                     newChunks.push_back(chunk);
+                } else if (!it->second->renderTier.exchange(true)) {
+                    // Was loaded for collision only; it needs a mesh now
+                    newChunks.push_back(it->second.get());
+                }
+            }
+        }
+    }
+
+    // Collision tier: everything physics may touch, meshed only if it is also in the pattern above
+    for (int dx = -collisionRadius; dx <= collisionRadius; dx++) {
+        for (int dy = -collisionRadius; dy <= collisionRadius; dy++) {
+            for (int dz = -collisionRadius; dz <= collisionRadius; dz++) {
+                ChunkCoord coord = {cameraChunk.x + dx, cameraChunk.y + dy, cameraChunk.z + dz};
+                if (chunks.find(coord) == chunks.end()) {
+                    VolumeChunk* chunk = getOrCreateChunk(coord);
+                    chunk->renderTier.store(false);
+                    newChunks.push_back(chunk);
                 }
             }
         }
     }
 
-    // Unload distant chunks (use larger vertical unload radius)
+    // Generate nearest chunks first
+    std::sort(newChunks.begin(), newChunks.end(), [&](const VolumeChunk* a, const VolumeChunk* b) {
+        auto distSq = [&](const ChunkCoord& c) {
+            int dx = c.x - cameraChunk.x;
+            int dy = c.y - cameraChunk.y;
+            int dz = c.z - cameraChunk.z;
+            return dx * dx + dy * dy + dz * dz;
+        };
+        return distSq(a->coord) < distSq(b->coord);
+    });
+
+    // Unload distant chunks (use larger vertical unload radius to prevent thrashing)
     std::vector<ChunkCoord> toRemove;
-    int verticalUnloadRadius = unloadRadius * 2;  // Keep more chunks vertically to prevent thrashing
     for (const auto& [coord, chunk] : chunks) {
         int dx = coord.x - cameraChunk.x;
         int dy = coord.y - cameraChunk.y;
@@ -78,6 +135,15 @@ std::vector<VolumeChunk*> ChunkManager::updateChunks(glm::vec3 cameraPos, int lo
         chunks.erase(coord);
     }
 
+    // Drop cached column estimates outside the unload radius
+    for (auto it = columnBounds.begin(); it != columnBounds.end(); ) {
+        if (abs(it->first.x - cameraChunk.x) > unloadRadius || abs(it->first.z - cameraChunk.z) > unloadRadius) {
+            it = columnBounds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     // Log summary if anything changed
     if (!newChunks.empty() || !toRemove.empty()) {
         std::cout << "Chunk update: +" << newChunks.size() << " loaded, -" << toRemove.size()
@@ -89,4 +155,5 @@ std::vector<VolumeChunk*> ChunkManager::updateChunks(glm::vec3 cameraPos, int lo
 
 void ChunkManager::clear() {
     chunks.clear();
+    columnBounds.clear();
 }
@@ -2,6 +2,8 @@
 
 #include "chunk.h"
 #include "volume_generator.h"
+#include "heightfield.h"
+#include "collision_fallback.h"
 #include <unordered_map>
 #include <memory>
 
@@ -15,11 +17,44 @@ public:
     // Get chunk without creating
     VolumeChunk* getChunk(ChunkCoord coord);
 
-    // Load chunks around a position and unload distant ones
-    // Returns newly loaded chunks (for mesh generation)
-    std::vector<VolumeChunk*> updateChunks(glm::vec3 cameraPos, int loadRadius, int unloadRadius);
+    // Load chunks around a position and unload distant ones. Chunks within collisionRadius
+    // (a cube, all axes) are loaded too; those outside the render pattern are collision-only.
+    // Returns chunks that need generating or (collision-only chunks joining the render tier) meshing.
+    std::vector<VolumeChunk*> updateChunks(glm::vec3 cameraPos, int loadRadius, int unloadRadius, int collisionRadius);
 
-    void generateChunkSdf(VolumeChunk& chunk) { generator.generateChunk(chunk); }
+    void generateChunkSdf(VolumeChunk& chunk) {
+        beginChunkSdf(chunk);
+        generateChunkSdfSlab(chunk, 0, CHUNK_SIZE);
+        finishChunkSdf(chunk);
+    }
+
+    // Split generation: begin once, then fill disjoint x-slabs from any thread, then finish
+    // once before setting sdfReady
+    void beginChunkSdf(VolumeChunk& chunk) {
+        if (!chunk.sdf) {
+            chunk.resetSdf();  // Regenerating a heightfield chunk
+        }
+        generator.initChunkBounds(chunk);
+    }
+    void generateChunkSdfSlab(VolumeChunk& chunk, int xBegin, int xEnd) { generator.generateSlab(chunk, xBegin, xEnd); }
+    void finishChunkSdf(VolumeChunk& chunk) {
+        if (heightfieldChunks) {
+            compactChunkToHeightfield(chunk);
+        }
+    }
+
+    // Store overhang-free chunks as heightfields (applies to chunks generated afterwards)
+    void setHeightfieldChunks(bool enabled) { heightfieldChunks = enabled; }
+    bool getHeightfieldChunks() const { return heightfieldChunks; }
+
+    // Estimated surface height range for a chunk column (cached after first query)
+    const ColumnSurfaceBounds& getColumnBounds(ColumnCoord column);
+    void invalidateColumnBounds() { columnBounds.clear(); }
+
+    VolumeGenerator& getGenerator() { return generator; }
+
+    // Collision samples where no generated chunk covers the position
+    CollisionFallback& getCollisionFallback() { return collisionFallback; }
 
     // Get all loaded chunks
     const std::unordered_map<ChunkCoord, std::unique_ptr<VolumeChunk>>& getChunks() const {
@@ -36,5 +71,8 @@ public:
 
 private:
     std::unordered_map<ChunkCoord, std::unique_ptr<VolumeChunk>> chunks;
+    std::unordered_map<ColumnCoord, ColumnSurfaceBounds> columnBounds;
     VolumeGenerator generator;
+    CollisionFallback collisionFallback{generator};
+    bool heightfieldChunks = true;
 };
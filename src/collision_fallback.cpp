@@ -0,0 +1,66 @@
+#include "collision_fallback.h"
+#include <cmath>
+
+namespace {
+    constexpr size_t CACHE_ENTRIES = 4096;  // Power of two; ~64 KB
+
+    size_t cacheSlot(glm::ivec3 lattice) {
+        uint32_t hash = static_cast<uint32_t>(lattice.x) * 73856093u ^
+                        static_cast<uint32_t>(lattice.y) * 19349663u ^
+                        static_cast<uint32_t>(lattice.z) * 83492791u;
+        return hash & (CACHE_ENTRIES - 1);
+    }
+}
+
+CollisionFallback::CollisionFallback(const VolumeGenerator& generator)
+    : generator(generator)
+    , entries(CACHE_ENTRIES) {
+}
+
+float CollisionFallback::sample(glm::vec3 worldPos) {
+    glm::vec3 voxelPos = worldPos / VOXEL_SIZE;
+    glm::vec3 base = glm::floor(voxelPos);
+    glm::vec3 f = voxelPos - base;
+    glm::ivec3 p(base);
+
+    float c000 = latticeValue(p);
+    float c100 = latticeValue(p + glm::ivec3(1, 0, 0));
+    float c010 = latticeValue(p + glm::ivec3(0, 1, 0));
+    float c110 = latticeValue(p + glm::ivec3(1, 1, 0));
+    float c001 = latticeValue(p + glm::ivec3(0, 0, 1));
+    float c101 = latticeValue(p + glm::ivec3(1, 0, 1));
+    float c011 = latticeValue(p + glm::ivec3(0, 1, 1));
+    float c111 = latticeValue(p + glm::ivec3(1, 1, 1));
+
+    float c00 = c000 + (c100 - c000) * f.x;
+    float c10 = c010 + (c110 - c010) * f.x;
+    float c01 = c001 + (c101 - c001) * f.x;
+    float c11 = c011 + (c111 - c011) * f.x;
+    float c0 = c00 + (c10 - c00) * f.y;
+    float c1 = c01 + (c11 - c01) * f.y;
+    return c0 + (c1 - c0) * f.z;
+}
+
+void CollisionFallback::clear() {
+    for (Entry& entry : entries) {
+        entry.valid = false;
+    }
+}
+
+uint32_t CollisionFallback::takeEvaluationCount() {
+    uint32_t count = evaluations;
+    evaluations = 0;
+    return count;
+}
+
+float CollisionFallback::latticeValue(glm::ivec3 lattice) {
+    Entry& entry = entries[cacheSlot(lattice)];
+    if (!entry.valid || entry.lattice != lattice) {
+        // Lattice points are multiples of VOXEL_SIZE, exactly the voxel positions chunks sample
+        entry.lattice = lattice;
+        entry.value = generator.generateSDF(glm::vec3(lattice) * VOXEL_SIZE);
+        entry.valid = true;
+        evaluations++;
+    }
+    return entry.value;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "volume_generator.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Collision SDF for places whose chunk isn't generated yet. Evaluates the generator at the
+// corners of the voxel-lattice cell around a query, the same points (and values) a chunk
+// stores, so collision doesn't change when the chunk arrives. Corner values are kept in a
+// small direct-mapped cache: the player only ever probes a few cells per frame.
+class CollisionFallback {
+public:
+    explicit CollisionFallback(const VolumeGenerator& generator);
+
+    // Trilinear SDF at a world position
+    float sample(glm::vec3 worldPos);
+
+    // Call after anything that changes generateSDF (octaves, tiled fields, stamps)
+    void clear();
+
+    // Generator evaluations since the last call
+    uint32_t takeEvaluationCount();
+
+private:
+    struct Entry {
+        glm::ivec3 lattice;
+        float value;
+        bool valid = false;
+    };
+
+    const VolumeGenerator& generator;
+    std::vector<Entry> entries;
+    uint32_t evaluations = 0;
+
+    float latticeValue(glm::ivec3 lattice);
+};
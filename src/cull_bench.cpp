@@ -0,0 +1,1152 @@
+// Headless check and benchmark of GPU-driven chunk culling (shaders/cull.comp). Needs a
+// Vulkan 1.2 device with drawIndirectCount but no window, so it also runs on lavapipe.
+//
+// Usage: cull_bench [largest grid side in chunk columns]
+//
+// Chunk boxes in a grid of columns around the camera are culled on the GPU, against the
+// frustum alone and then also against a Hi-Z pyramid built from the depth of the previous
+// camera position (raycast on the CPU against the ground and a ring of hills). The compacted
+// commands are drawn with vkCmdDrawIndirectCount, rasterization off, by a vertex shader that
+// records the vertex range each chunk slot really drew. Both the command list and the drawn
+// ranges are compared with gpuCullVisible(), the CPU reference. Reported per chunk count:
+//   GPU       pyramid and cull pass times from timestamps (if the queue has them)
+//   record    CPU time to record pyramid, cull and draw: flat in the chunk count
+//   CPU ref   the same culling done on the CPU, for scale
+// Exits with 1 if GPU and CPU disagree anywhere float rounding at a box edge can't explain.
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include "chunk.h"
+#include "gpu_culling.h"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <random>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Depth buffer the pyramid is built from; 720 halves to odd sizes on the way down
+constexpr int DEPTH_WIDTH = 1280;
+constexpr int DEPTH_HEIGHT = 720;
+constexpr int CHUNK_LAYERS = 4;          // Chunk rows from y = -2 to 1, the ground at y = 0
+constexpr float EYE_HEIGHT = 6.0f;
+constexpr float PREVIOUS_FRAME_STEP = 1.0f;  // Camera motion between the depth and the cull
+constexpr int VIEW_COUNT = 4;
+
+// A GPU/CPU disagreement only counts if moving the box faces this far doesn't explain it
+constexpr float EDGE_TOLERANCE = 0.01f;
+
+double msSince(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::vector<char> readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    return buffer;
+}
+
+// Host-visible, coherent and persistently mapped, so results are read back in place.
+// A real frame would keep the chunk records and commands in device-local memory.
+struct MappedBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void* mapped = nullptr;
+    VkDeviceSize size = 0;
+};
+
+struct VulkanContext {
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    float timestampPeriodNs = 0.0f;  // 0 = the queue has no timestamps
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+        throw std::runtime_error("Failed to find suitable memory type!");
+    }
+
+    MappedBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage) const {
+        MappedBuffer result;
+        result.size = size;
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &result.buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(device, result.buffer, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &result.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate buffer memory!");
+        }
+        vkBindBufferMemory(device, result.buffer, result.memory, 0);
+        vkMapMemory(device, result.memory, 0, size, 0, &result.mapped);
+        return result;
+    }
+
+    void destroyBuffer(MappedBuffer& buffer) const {
+        if (buffer.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, buffer.buffer, nullptr);
+            vkFreeMemory(device, buffer.memory, nullptr);
+        }
+        buffer = MappedBuffer{};
+    }
+
+    VkShaderModule createShaderModule(const std::string& path) const {
+        std::vector<char> code = readFile(path);
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shader module!");
+        }
+        return shaderModule;
+    }
+};
+
+VulkanContext createContext() {
+    VulkanContext ctx;
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Cull Bench";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+
+    if (vkCreateInstance(&createInfo, nullptr, &ctx.instance) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create Vulkan instance!");
+    }
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, nullptr);
+    if (deviceCount == 0) {
+        throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+    }
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, devices.data());
+
+    // Prefer real GPUs, but take whatever is there (lavapipe reports itself as a CPU device)
+    auto rank = [](VkPhysicalDevice device) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+        switch (properties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 0;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 1;
+            default: return 2;
+        }
+    };
+    ctx.physicalDevice = *std::min_element(devices.begin(), devices.end(),
+                                           [&](VkPhysicalDevice a, VkPhysicalDevice b) { return rank(a) < rank(b); });
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice, &properties);
+    std::cout << "Device: " << properties.deviceName << std::endl;
+    vkGetPhysicalDeviceMemoryProperties(ctx.physicalDevice, &ctx.memoryProperties);
+
+    // The indirect count draw, plus slot numbers in firstInstance and stores from the check shader
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported12;
+    if (properties.apiVersion >= VK_API_VERSION_1_2) {
+        vkGetPhysicalDeviceFeatures2(ctx.physicalDevice, &supported);
+    }
+    if (!supported12.drawIndirectCount || !supported.features.multiDrawIndirect ||
+        !supported.features.drawIndirectFirstInstance || !supported.features.vertexPipelineStoresAndAtomics) {
+        throw std::runtime_error("Needs Vulkan 1.2 with drawIndirectCount, multiDrawIndirect, "
+                                 "drawIndirectFirstInstance and vertexPipelineStoresAndAtomics!");
+    }
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &familyCount, families.data());
+    uint32_t family = UINT32_MAX;
+    for (uint32_t i = 0; i < familyCount; i++) {
+        if ((families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+            family = i;
+            break;
+        }
+    }
+    if (family == UINT32_MAX) {
+        throw std::runtime_error("Failed to find a graphics and compute queue!");
+    }
+    if (families[family].timestampValidBits > 0) {
+        ctx.timestampPeriodNs = properties.limits.timestampPeriod;
+    }
+
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueCreateInfo{};
+    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfo.queueFamilyIndex = family;
+    queueCreateInfo.queueCount = 1;
+    queueCreateInfo.pQueuePriorities = &queuePriority;
+
+    VkPhysicalDeviceVulkan12Features enabled12{};
+    enabled12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabled12.drawIndirectCount = VK_TRUE;
+    VkPhysicalDeviceFeatures2 enabled{};
+    enabled.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    enabled.pNext = &enabled12;
+    enabled.features.multiDrawIndirect = VK_TRUE;
+    enabled.features.drawIndirectFirstInstance = VK_TRUE;
+    enabled.features.vertexPipelineStoresAndAtomics = VK_TRUE;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = &enabled;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueCreateInfo;
+
+    if (vkCreateDevice(ctx.physicalDevice, &deviceInfo, nullptr, &ctx.device) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create logical device!");
+    }
+    vkGetDeviceQueue(ctx.device, family, 0, &ctx.queue);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = family;
+    if (vkCreateCommandPool(ctx.device, &poolInfo, nullptr, &ctx.commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create command pool!");
+    }
+
+    return ctx;
+}
+
+void destroyContext(VulkanContext& ctx) {
+    vkDestroyCommandPool(ctx.device, ctx.commandPool, nullptr);
+    vkDestroyDevice(ctx.device, nullptr);
+    vkDestroyInstance(ctx.instance, nullptr);
+}
+
+// Vulkan-style projection, as VulkanApp::projectionMatrix
+glm::mat4 projection() {
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), DEPTH_WIDTH / static_cast<float>(DEPTH_HEIGHT), 0.1f, 1000.0f);
+    proj[1][1] *= -1;
+    return proj;
+}
+
+struct View {
+    glm::mat4 viewProj;
+    glm::mat4 previousViewProj;  // One step back along the view direction
+};
+
+View makeView(int index) {
+    float yaw = glm::radians(20.0f + 360.0f * index / VIEW_COUNT);
+    glm::vec3 forward(std::cos(yaw) * std::cos(glm::radians(-8.0f)), std::sin(glm::radians(-8.0f)),
+                      std::sin(yaw) * std::cos(glm::radians(-8.0f)));
+    glm::vec3 eye(0.3f, EYE_HEIGHT, 0.7f);
+    glm::vec3 previous = eye - forward * PREVIOUS_FRAME_STEP;
+    glm::vec3 up(0.0f, 1.0f, 0.0f);
+    return {projection() * glm::lookAt(eye, eye + forward, up),
+            projection() * glm::lookAt(previous, previous + forward, up)};
+}
+
+// Ground at y = 0 and a ring of hills around the camera
+struct Occluders {
+    std::vector<glm::vec3> boxMin;
+    std::vector<glm::vec3> boxMax;
+
+    Occluders() {
+        for (int i = 0; i < 8; i++) {
+            float angle = glm::radians(45.0f * i + 10.0f);
+            glm::vec3 center(std::cos(angle) * 40.0f, 0.0f, std::sin(angle) * 40.0f);
+            boxMin.push_back(center - glm::vec3(12.0f, 0.0f, 12.0f));
+            boxMax.push_back(center + glm::vec3(12.0f, 18.0f, 12.0f));
+        }
+    }
+
+    // Nearest hit along from + t * dir for t in [0, 1], or 2 for none
+    float raycast(glm::vec3 from, glm::vec3 dir) const {
+        float nearest = 2.0f;
+        if (dir.y < 0.0f && from.y > 0.0f) {
+            nearest = std::min(nearest, -from.y / dir.y);
+        }
+        for (size_t i = 0; i < boxMin.size(); i++) {
+            float tEnter = 0.0f;
+            float tExit = 1.0f;
+            for (int axis = 0; axis < 3; axis++) {
+                if (std::abs(dir[axis]) < 1e-9f) {
+                    if (from[axis] < boxMin[i][axis] || from[axis] > boxMax[i][axis]) {
+                        tEnter = 2.0f;
+                    }
+                    continue;
+                }
+                float t0 = (boxMin[i][axis] - from[axis]) / dir[axis];
+                float t1 = (boxMax[i][axis] - from[axis]) / dir[axis];
+                tEnter = std::max(tEnter, std::min(t0, t1));
+                tExit = std::min(tExit, std::max(t0, t1));
+            }
+            if (tEnter <= tExit) {
+                nearest = std::min(nearest, tEnter);
+            }
+        }
+        return nearest;
+    }
+};
+
+// What last frame's depth buffer would hold: per pixel centre, the depth of the nearest occluder
+std::vector<float> raycastDepth(const Occluders& occluders, const glm::mat4& viewProj) {
+    glm::mat4 inverse = glm::inverse(viewProj);
+    std::vector<float> depth(static_cast<size_t>(DEPTH_WIDTH) * DEPTH_HEIGHT, 1.0f);
+    for (int y = 0; y < DEPTH_HEIGHT; y++) {
+        for (int x = 0; x < DEPTH_WIDTH; x++) {
+            glm::vec2 ndc((x + 0.5f) / DEPTH_WIDTH * 2.0f - 1.0f, (y + 0.5f) / DEPTH_HEIGHT * 2.0f - 1.0f);
+            glm::vec4 nearPoint = inverse * glm::vec4(ndc.x, ndc.y, 0.0f, 1.0f);
+            glm::vec4 farPoint = inverse * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+            glm::vec3 from = glm::vec3(nearPoint) / nearPoint.w;
+            glm::vec3 dir = glm::vec3(farPoint) / farPoint.w - from;
+            float t = occluders.raycast(from, dir);
+            if (t <= 1.0f) {
+                glm::vec4 clip = viewProj * glm::vec4(from + dir * t, 1.0f);
+                depth[static_cast<size_t>(y) * DEPTH_WIDTH + x] = std::clamp(clip.z / clip.w, 0.0f, 1.0f);
+            }
+        }
+    }
+    return depth;
+}
+
+// side x side columns of CHUNK_LAYERS chunks. Boxes are trimmed like drawn mesh bounds, and
+// some slots are left empty as after unloads. Draw ranges are packed into one vertex range.
+std::vector<GpuCullChunk> makeChunks(int side) {
+    std::mt19937 rng(12345u + static_cast<uint32_t>(side));
+    std::uniform_real_distribution<float> trim(0.0f, CHUNK_WORLD_SIZE * 0.3f);
+    std::uniform_int_distribution<uint32_t> triangles(1, 2000);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    std::vector<GpuCullChunk> chunks;
+    uint32_t firstVertex = 0;
+    for (int x = -side / 2; x < side - side / 2; x++) {
+        for (int z = -side / 2; z < side - side / 2; z++) {
+            for (int y = -CHUNK_LAYERS / 2; y < CHUNK_LAYERS - CHUNK_LAYERS / 2; y++) {
+                GpuCullChunk chunk{};
+                glm::vec3 corner = glm::vec3(x, y, z) * CHUNK_WORLD_SIZE;
+                chunk.boxMin = glm::vec4(corner + glm::vec3(0.0f, trim(rng), 0.0f), 0.0f);
+                chunk.boxMax = glm::vec4(corner + glm::vec3(CHUNK_WORLD_SIZE, CHUNK_WORLD_SIZE - trim(rng), CHUNK_WORLD_SIZE), 0.0f);
+                chunk.firstVertex = firstVertex;
+                chunk.vertexCount = percent(rng) < 10 ? 0 : 3 * triangles(rng);
+                firstVertex += chunk.vertexCount;
+                chunks.push_back(chunk);
+            }
+        }
+    }
+    return chunks;
+}
+
+// Pipelines and the depth/pyramid images; the per-chunk-count buffers live in CullScene
+class GpuCuller {
+public:
+    explicit GpuCuller(const VulkanContext& ctx) : ctx(ctx) {
+        levelCount = hiZLevelCount({DEPTH_WIDTH, DEPTH_HEIGHT});
+        createImages();
+        createLayouts();
+        createPipelines();
+        createDescriptorSets();
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = ctx.commandPool;
+        allocInfo.commandBufferCount = 1;
+        vkAllocateCommandBuffers(ctx.device, &allocInfo, &commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vkCreateFence(ctx.device, &fenceInfo, nullptr, &fence);
+
+        if (ctx.timestampPeriodNs > 0.0f) {
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = 3;
+            if (vkCreateQueryPool(ctx.device, &queryPoolInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+                timestampPool = VK_NULL_HANDLE;
+            }
+        }
+
+        depthStaging = ctx.createBuffer(sizeof(float) * DEPTH_WIDTH * DEPTH_HEIGHT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        paramsBuffer = ctx.createBuffer(sizeof(GpuCullParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    }
+
+    ~GpuCuller() {
+        vkDeviceWaitIdle(ctx.device);
+        destroyScene();
+        ctx.destroyBuffer(depthStaging);
+        ctx.destroyBuffer(paramsBuffer);
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(ctx.device, timestampPool, nullptr);
+        }
+        vkDestroyFence(ctx.device, fence, nullptr);
+        vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &commandBuffer);
+        vkDestroyDescriptorPool(ctx.device, descriptorPool, nullptr);
+        vkDestroyPipeline(ctx.device, cullPipeline, nullptr);
+        vkDestroyPipeline(ctx.device, reducePipeline, nullptr);
+        vkDestroyPipeline(ctx.device, checkPipeline, nullptr);
+        vkDestroyPipelineLayout(ctx.device, cullPipelineLayout, nullptr);
+        vkDestroyPipelineLayout(ctx.device, reducePipelineLayout, nullptr);
+        vkDestroyPipelineLayout(ctx.device, checkPipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(ctx.device, cullSetLayout, nullptr);
+        vkDestroyDescriptorSetLayout(ctx.device, reduceSetLayout, nullptr);
+        vkDestroyDescriptorSetLayout(ctx.device, checkSetLayout, nullptr);
+        vkDestroyFramebuffer(ctx.device, framebuffer, nullptr);
+        vkDestroyRenderPass(ctx.device, renderPass, nullptr);
+        vkDestroySampler(ctx.device, sampler, nullptr);
+        for (VkImageView view : levelViews) {
+            vkDestroyImageView(ctx.device, view, nullptr);
+        }
+        vkDestroyImageView(ctx.device, pyramidView, nullptr);
+        vkDestroyImage(ctx.device, pyramidImage, nullptr);
+        vkFreeMemory(ctx.device, pyramidMemory, nullptr);
+        vkDestroyImageView(ctx.device, depthView, nullptr);
+        vkDestroyImage(ctx.device, depthImage, nullptr);
+        vkFreeMemory(ctx.device, depthMemory, nullptr);
+    }
+
+    // Chunk records go up once per chunk count; the app rewrites its records every frame
+    void setChunks(const std::vector<GpuCullChunk>& chunks) {
+        vkDeviceWaitIdle(ctx.device);
+        destroyScene();
+        chunkCount = static_cast<uint32_t>(chunks.size());
+        chunkBuffer = ctx.createBuffer(sizeof(GpuCullChunk) * chunkCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        drawBuffer = ctx.createBuffer(sizeof(VkDrawIndirectCommand) * chunkCount,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+        countBuffer = ctx.createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+        firstBuffer = ctx.createBuffer(sizeof(uint32_t) * chunkCount,
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+        endBuffer = ctx.createBuffer(sizeof(uint32_t) * chunkCount,
+                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+        memcpy(chunkBuffer.mapped, chunks.data(), sizeof(GpuCullChunk) * chunkCount);
+
+        VkDescriptorBufferInfo params{paramsBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo records{chunkBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo draws{drawBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo count{countBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo firsts{firstBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo ends{endBuffer.buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorImageInfo pyramid{sampler, pyramidView, VK_IMAGE_LAYOUT_GENERAL};
+
+        std::vector<VkWriteDescriptorSet> writes;
+        writes.push_back(bufferWrite(cullSet, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &params));
+        writes.push_back(bufferWrite(cullSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &records));
+        writes.push_back(bufferWrite(cullSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &draws));
+        writes.push_back(bufferWrite(cullSet, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &count));
+        writes.push_back(imageWrite(cullSet, 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &pyramid));
+        writes.push_back(bufferWrite(checkSet, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &firsts));
+        writes.push_back(bufferWrite(checkSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &ends));
+        vkUpdateDescriptorSets(ctx.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    struct FrameResult {
+        std::vector<VkDrawIndirectCommand> draws;
+        std::vector<uint32_t> drawnFirst;  // Per slot, from the check shader
+        std::vector<uint32_t> drawnEnd;
+        double pyramidGpuMs = 0.0;
+        double cullGpuMs = 0.0;
+        double recordMs = 0.0;
+    };
+
+    // One frame: optional pyramid from `depth`, cull, indirect-count draw; waits for the result
+    FrameResult run(const GpuCullParams& params, const std::vector<float>* depth) {
+        memcpy(paramsBuffer.mapped, &params, sizeof(params));
+        if (depth) {
+            memcpy(depthStaging.mapped, depth->data(), sizeof(float) * depth->size());
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        // Setup outside the timed part: last frame's depth, counters cleared
+        if (depth) {
+            uploadDepth();
+        }
+        vkCmdFillBuffer(commandBuffer, countBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+        vkCmdFillBuffer(commandBuffer, firstBuffer.buffer, 0, VK_WHOLE_SIZE, 0xffffffffu);
+        vkCmdFillBuffer(commandBuffer, endBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+        memoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, timestampPool, 0, 3);
+        }
+
+        auto recordStart = Clock::now();
+        writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+        if (depth) {
+            recordPyramid();
+        }
+        writeTimestamp(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 1);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullSet, 0, nullptr);
+        vkCmdDispatch(commandBuffer, (chunkCount + 63) / 64, 1, 1);
+        writeTimestamp(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 2);
+
+        memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = framebuffer;
+        renderPassInfo.renderArea.extent = {1, 1};
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, checkPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, checkPipelineLayout, 0, 1, &checkSet, 0, nullptr);
+        vkCmdDrawIndirectCount(commandBuffer, drawBuffer.buffer, 0, countBuffer.buffer, 0, chunkCount,
+                               sizeof(VkDrawIndirectCommand));
+        vkCmdEndRenderPass(commandBuffer);
+        double recordMs = msSince(recordStart, Clock::now());
+
+        memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                      VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        vkQueueSubmit(ctx.queue, 1, &submitInfo, fence);
+        vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(ctx.device, 1, &fence);
+        vkResetCommandBuffer(commandBuffer, 0);
+
+        FrameResult result;
+        result.recordMs = recordMs;
+        uint32_t drawCount = std::min(*static_cast<const uint32_t*>(countBuffer.mapped), chunkCount);
+        const auto* draws = static_cast<const VkDrawIndirectCommand*>(drawBuffer.mapped);
+        result.draws.assign(draws, draws + drawCount);
+        const auto* firsts = static_cast<const uint32_t*>(firstBuffer.mapped);
+        const auto* ends = static_cast<const uint32_t*>(endBuffer.mapped);
+        result.drawnFirst.assign(firsts, firsts + chunkCount);
+        result.drawnEnd.assign(ends, ends + chunkCount);
+
+        uint64_t timestamps[3] = {};
+        if (timestampPool != VK_NULL_HANDLE &&
+            vkGetQueryPoolResults(ctx.device, timestampPool, 0, 3, sizeof(timestamps), timestamps, sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+            result.pyramidGpuMs = (timestamps[1] - timestamps[0]) * ctx.timestampPeriodNs / 1e6;
+            result.cullGpuMs = (timestamps[2] - timestamps[1]) * ctx.timestampPeriodNs / 1e6;
+        }
+        return result;
+    }
+
+    uint32_t hiZLevels() const { return levelCount; }
+
+private:
+    const VulkanContext& ctx;
+    uint32_t levelCount = 0;
+    uint32_t chunkCount = 0;
+
+    VkImage depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory depthMemory = VK_NULL_HANDLE;
+    VkImageView depthView = VK_NULL_HANDLE;
+    VkImage pyramidImage = VK_NULL_HANDLE;
+    VkDeviceMemory pyramidMemory = VK_NULL_HANDLE;
+    VkImageView pyramidView = VK_NULL_HANDLE;   // Every level, for cull.comp
+    std::vector<VkImageView> levelViews;        // One level each, for hiz_reduce.comp
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout reduceSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout checkSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout reducePipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout checkPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+    VkPipeline reducePipeline = VK_NULL_HANDLE;
+    VkPipeline checkPipeline = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;  // No attachments: the check draw only writes buffers
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet cullSet = VK_NULL_HANDLE;
+    VkDescriptorSet checkSet = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> reduceSets;    // Per level: level below (or depth) -> level
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;
+
+    MappedBuffer depthStaging;
+    MappedBuffer paramsBuffer;
+    MappedBuffer chunkBuffer;
+    MappedBuffer drawBuffer;
+    MappedBuffer countBuffer;
+    MappedBuffer firstBuffer;
+    MappedBuffer endBuffer;
+
+    struct ReducePushConstants {
+        glm::ivec2 srcSize;
+        glm::ivec2 dstSize;
+        uint32_t reduce;
+    };
+
+    static glm::ivec2 levelSize(uint32_t level) {
+        return {std::max(DEPTH_WIDTH >> level, 1), std::max(DEPTH_HEIGHT >> level, 1)};
+    }
+
+    static VkWriteDescriptorSet bufferWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type,
+                                            const VkDescriptorBufferInfo* info) {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = binding;
+        write.descriptorCount = 1;
+        write.descriptorType = type;
+        write.pBufferInfo = info;
+        return write;
+    }
+
+    static VkWriteDescriptorSet imageWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type,
+                                           const VkDescriptorImageInfo* info) {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = binding;
+        write.descriptorCount = 1;
+        write.descriptorType = type;
+        write.pImageInfo = info;
+        return write;
+    }
+
+    void destroyScene() {
+        ctx.destroyBuffer(chunkBuffer);
+        ctx.destroyBuffer(drawBuffer);
+        ctx.destroyBuffer(countBuffer);
+        ctx.destroyBuffer(firstBuffer);
+        ctx.destroyBuffer(endBuffer);
+    }
+
+    void createImage(VkFormat format, uint32_t mipLevels, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {static_cast<uint32_t>(DEPTH_WIDTH), static_cast<uint32_t>(DEPTH_HEIGHT), 1};
+        imageInfo.mipLevels = mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = usage;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateImage(ctx.device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(ctx.device, image, &memRequirements);
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = ctx.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(ctx.device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate image memory!");
+        }
+        vkBindImageMemory(ctx.device, image, memory, 0);
+    }
+
+    VkImageView createView(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t baseLevel, uint32_t levels) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = aspect;
+        viewInfo.subresourceRange.baseMipLevel = baseLevel;
+        viewInfo.subresourceRange.levelCount = levels;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView view;
+        if (vkCreateImageView(ctx.device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image view!");
+        }
+        return view;
+    }
+
+    // Depth stands in for the app's depth attachment, which the app samples after its render pass.
+    // The pyramid stays in GENERAL: every level is both written (storage) and read (sampled).
+    void createImages() {
+        createImage(VK_FORMAT_D32_SFLOAT, 1, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                    depthImage, depthMemory);
+        depthView = createView(depthImage, VK_FORMAT_D32_SFLOAT, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1);
+
+        createImage(VK_FORMAT_R32_SFLOAT, levelCount, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+                    pyramidImage, pyramidMemory);
+        pyramidView = createView(pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            levelViews.push_back(createView(pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1));
+        }
+
+        // Only texelFetch reads through it
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(ctx.device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create sampler!");
+        }
+
+        // The pyramid goes to GENERAL once; the depth image is re-uploaded every frame
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = ctx.commandPool;
+        allocInfo.commandBufferCount = 1;
+        VkCommandBuffer setup;
+        vkAllocateCommandBuffers(ctx.device, &allocInfo, &setup);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(setup, &beginInfo);
+        VkImageMemoryBarrier barrier = imageBarrier(pyramidImage, VK_IMAGE_ASPECT_COLOR_BIT, levelCount,
+                                                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                                    0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(setup, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        vkEndCommandBuffer(setup);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &setup;
+        vkQueueSubmit(ctx.queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(ctx.queue);
+        vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &setup);
+    }
+
+    static VkImageMemoryBarrier imageBarrier(VkImage image, VkImageAspectFlags aspect, uint32_t levels,
+                                             VkImageLayout oldLayout, VkImageLayout newLayout,
+                                             VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = aspect;
+        barrier.subresourceRange.levelCount = levels;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        return barrier;
+    }
+
+    void memoryBarrier(VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                       VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void writeTimestamp(VkPipelineStageFlagBits stage, uint32_t query) {
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, stage, timestampPool, query);
+        }
+    }
+
+    VkDescriptorSetLayout createSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        VkDescriptorSetLayout layout;
+        if (vkCreateDescriptorSetLayout(ctx.device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create descriptor set layout!");
+        }
+        return layout;
+    }
+
+    VkPipelineLayout createPipelineLayout(VkDescriptorSetLayout setLayout, const VkPushConstantRange* pushConstants) {
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = pushConstants ? 1 : 0;
+        pipelineLayoutInfo.pPushConstantRanges = pushConstants;
+
+        VkPipelineLayout layout;
+        if (vkCreatePipelineLayout(ctx.device, &pipelineLayoutInfo, nullptr, &layout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline layout!");
+        }
+        return layout;
+    }
+
+    void createLayouts() {
+        const VkShaderStageFlags compute = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullSetLayout = createSetLayout({
+            {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, compute, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, compute, nullptr},
+        });
+        reduceSetLayout = createSetLayout({
+            {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, compute, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, compute, nullptr},
+        });
+        checkSetLayout = createSetLayout({
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+        });
+
+        VkPushConstantRange reducePushConstants{compute, 0, sizeof(ReducePushConstants)};
+        cullPipelineLayout = createPipelineLayout(cullSetLayout, nullptr);
+        reducePipelineLayout = createPipelineLayout(reduceSetLayout, &reducePushConstants);
+        checkPipelineLayout = createPipelineLayout(checkSetLayout, nullptr);
+    }
+
+    VkPipeline createComputePipeline(const std::string& path, VkPipelineLayout layout) {
+        VkShaderModule shaderModule = ctx.createShaderModule(path);
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = layout;
+
+        VkPipeline pipeline;
+        if (vkCreateComputePipelines(ctx.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute pipeline: " + path);
+        }
+        vkDestroyShaderModule(ctx.device, shaderModule, nullptr);
+        return pipeline;
+    }
+
+    void createPipelines() {
+        cullPipeline = createComputePipeline("build/shaders/cull.comp.spv", cullPipelineLayout);
+        reducePipeline = createComputePipeline("build/shaders/hiz_reduce.comp.spv", reducePipelineLayout);
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+        if (vkCreateRenderPass(ctx.device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render pass!");
+        }
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass;
+        framebufferInfo.width = 1;
+        framebufferInfo.height = 1;
+        framebufferInfo.layers = 1;
+        if (vkCreateFramebuffer(ctx.device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create framebuffer!");
+        }
+
+        // Vertex shader only: with rasterization discarded nothing else runs
+        VkShaderModule vertShaderModule = ctx.createShaderModule("build/shaders/cull_check.vert.spv");
+        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vertShaderStageInfo.module = vertShaderModule;
+        vertShaderStageInfo.pName = "main";
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkPipelineRasterizationStateCreateInfo rasterizer{};
+        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.rasterizerDiscardEnable = VK_TRUE;
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterizer.lineWidth = 1.0f;
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 1;
+        pipelineInfo.pStages = &vertShaderStageInfo;
+        pipelineInfo.pVertexInputState = &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.layout = checkPipelineLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+        if (vkCreateGraphicsPipelines(ctx.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &checkPipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create check pipeline!");
+        }
+        vkDestroyShaderModule(ctx.device, vertShaderModule, nullptr);
+    }
+
+    void createDescriptorSets() {
+        VkDescriptorPoolSize poolSizes[] = {
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 + levelCount},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelCount},
+        };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 4;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 2 + levelCount;
+        if (vkCreateDescriptorPool(ctx.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create descriptor pool!");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(levelCount, reduceSetLayout);
+        layouts.push_back(cullSetLayout);
+        layouts.push_back(checkSetLayout);
+        std::vector<VkDescriptorSet> sets(layouts.size());
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.device, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate descriptor sets!");
+        }
+        reduceSets.assign(sets.begin(), sets.begin() + levelCount);
+        cullSet = sets[levelCount];
+        checkSet = sets[levelCount + 1];
+
+        // The images never change, so the reduce sets are written once
+        std::vector<VkDescriptorImageInfo> sources(levelCount);
+        std::vector<VkDescriptorImageInfo> destinations(levelCount);
+        std::vector<VkWriteDescriptorSet> writes;
+        for (uint32_t level = 0; level < levelCount; level++) {
+            sources[level] = level == 0 ? VkDescriptorImageInfo{sampler, depthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}
+                                        : VkDescriptorImageInfo{sampler, levelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+            destinations[level] = {VK_NULL_HANDLE, levelViews[level], VK_IMAGE_LAYOUT_GENERAL};
+            writes.push_back(imageWrite(reduceSets[level], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &sources[level]));
+            writes.push_back(imageWrite(reduceSets[level], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &destinations[level]));
+        }
+        vkUpdateDescriptorSets(ctx.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void uploadDepth() {
+        VkImageMemoryBarrier toTransfer = imageBarrier(depthImage, VK_IMAGE_ASPECT_DEPTH_BIT, 1,
+                                                       VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                       0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {static_cast<uint32_t>(DEPTH_WIDTH), static_cast<uint32_t>(DEPTH_HEIGHT), 1};
+        vkCmdCopyBufferToImage(commandBuffer, depthStaging.buffer, depthImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImageMemoryBarrier toSampled = imageBarrier(depthImage, VK_IMAGE_ASPECT_DEPTH_BIT, 1,
+                                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toSampled);
+    }
+
+    // Level 0 copies the depth buffer, each further level reduces the one below it
+    void recordPyramid() {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            ReducePushConstants pc{levelSize(level == 0 ? 0 : level - 1), levelSize(level), level == 0 ? 0u : 1u};
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipelineLayout, 0, 1,
+                                    &reduceSets[level], 0, nullptr);
+            vkCmdPushConstants(commandBuffer, reducePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+            vkCmdDispatch(commandBuffer, (pc.dstSize.x + 7) / 8, (pc.dstSize.y + 7) / 8, 1);
+            memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+};
+
+struct Check {
+    uint32_t visible = 0;
+    uint32_t edgeCases = 0;  // Disagreements explained by float rounding at a box edge
+    uint32_t errors = 0;
+    double referenceMs = 0.0;
+};
+
+// The GPU's command list and drawn ranges against gpuCullVisible() for every slot
+Check verify(const std::vector<GpuCullChunk>& chunks, const GpuCullParams& params, const HiZPyramid* pyramid,
+             const GpuCuller::FrameResult& frame) {
+    Check check;
+    std::vector<uint8_t> gpuVisible(chunks.size(), 0);
+    for (const VkDrawIndirectCommand& draw : frame.draws) {
+        uint32_t slot = draw.firstInstance;
+        if (slot >= chunks.size() || gpuVisible[slot] || draw.instanceCount != 1 ||
+            draw.vertexCount != chunks[slot].vertexCount || draw.firstVertex != chunks[slot].firstVertex) {
+            check.errors++;
+            continue;
+        }
+        gpuVisible[slot] = 1;
+    }
+
+    std::vector<uint8_t> cpuVisible(chunks.size());
+    auto start = Clock::now();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        cpuVisible[i] = gpuCullVisible(chunks[i], params, pyramid);
+    }
+    check.referenceMs = msSince(start, Clock::now());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const GpuCullChunk& chunk = chunks[i];
+        if (gpuVisible[i] != cpuVisible[i]) {
+            GpuCullChunk grown = chunk;
+            GpuCullChunk shrunk = chunk;
+            grown.boxMin -= glm::vec4(EDGE_TOLERANCE);
+            grown.boxMax += glm::vec4(EDGE_TOLERANCE);
+            shrunk.boxMin += glm::vec4(EDGE_TOLERANCE);
+            shrunk.boxMax -= glm::vec4(EDGE_TOLERANCE);
+            if (gpuCullVisible(grown, params, pyramid) != gpuCullVisible(shrunk, params, pyramid)) {
+                check.edgeCases++;
+            } else {
+                check.errors++;
+            }
+        }
+        // What the indirect draw really ran must match the command list exactly
+        bool drawn = frame.drawnFirst[i] != 0xffffffffu;
+        if (drawn != (gpuVisible[i] != 0) ||
+            (drawn && (frame.drawnFirst[i] != chunk.firstVertex ||
+                       frame.drawnEnd[i] != chunk.firstVertex + chunk.vertexCount))) {
+            check.errors++;
+        }
+        check.visible += gpuVisible[i];
+    }
+    return check;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int largestSide = argc > 1 ? std::max(8, std::atoi(argv[1])) : 128;
+
+    try {
+        VulkanContext ctx = createContext();
+        uint32_t totalErrors = 0;
+        {
+            GpuCuller culler(ctx);
+            Occluders occluders;
+
+            // Last frame's depth and its pyramid for each view, shared by every chunk count
+            std::vector<View> views;
+            std::vector<std::vector<float>> depths;
+            std::vector<HiZPyramid> pyramids;
+            for (int i = 0; i < VIEW_COUNT; i++) {
+                views.push_back(makeView(i));
+                depths.push_back(raycastDepth(occluders, views.back().previousViewProj));
+                pyramids.push_back(HiZPyramid::build(depths.back(), {DEPTH_WIDTH, DEPTH_HEIGHT}));
+            }
+
+            std::cout << std::fixed << std::setprecision(3);
+            std::cout << "Hi-Z: " << DEPTH_WIDTH << "x" << DEPTH_HEIGHT << ", " << culler.hiZLevels()
+                      << " levels; averages over " << VIEW_COUNT << " views" << std::endl;
+            for (int side = 16; side <= largestSide; side *= 2) {
+                std::vector<GpuCullChunk> chunks = makeChunks(side);
+                culler.setChunks(chunks);
+                uint32_t chunkCount = static_cast<uint32_t>(chunks.size());
+                std::cout << "=== " << chunkCount << " chunks (" << side << "x" << side << " columns) ===" << std::endl;
+
+                for (bool hiZ : {false, true}) {
+                    Check total;
+                    double pyramidGpuMs = 0.0;
+                    double cullGpuMs = 0.0;
+                    double recordMs = 0.0;
+                    for (int i = 0; i < VIEW_COUNT; i++) {
+                        GpuCullParams params = makeGpuCullParams(views[i].viewProj, views[i].previousViewProj,
+                                                                 {DEPTH_WIDTH, DEPTH_HEIGHT},
+                                                                 hiZ ? culler.hiZLevels() : 0, chunkCount);
+                        GpuCuller::FrameResult frame = culler.run(params, hiZ ? &depths[i] : nullptr);
+                        Check check = verify(chunks, params, &pyramids[i], frame);
+                        total.visible += check.visible;
+                        total.edgeCases += check.edgeCases;
+                        total.errors += check.errors;
+                        total.referenceMs += check.referenceMs;
+                        pyramidGpuMs += frame.pyramidGpuMs;
+                        cullGpuMs += frame.cullGpuMs;
+                        recordMs += frame.recordMs;
+                    }
+                    totalErrors += total.errors;
+                    std::cout << "  " << std::setw(13) << std::left << (hiZ ? "frustum+Hi-Z" : "frustum") << std::right
+                              << "drawn " << std::setw(6) << total.visible / VIEW_COUNT
+                              << "   GPU pyramid " << std::setw(7) << pyramidGpuMs / VIEW_COUNT
+                              << " + cull " << std::setw(7) << cullGpuMs / VIEW_COUNT << " ms"
+                              << "   record " << std::setw(6) << recordMs * 1000.0 / VIEW_COUNT << " us"
+                              << "   CPU ref " << std::setw(7) << total.referenceMs / VIEW_COUNT << " ms"
+                              << "   mismatches " << total.errors << " (+" << total.edgeCases << " at edges)" << std::endl;
+                }
+            }
+        }
+        destroyContext(ctx);
+
+        if (totalErrors > 0) {
+            std::cerr << "GPU culling disagrees with the CPU reference" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
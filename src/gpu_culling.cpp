@@ -0,0 +1,124 @@
+#include "gpu_culling.h"
+#include "occlusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Corners closer to the camera plane than this can't be projected reliably
+    constexpr float MIN_CLIP_W = 1e-4f;
+
+    bool hiZHidden(const GpuCullChunk& chunk, const GpuCullParams& params, const HiZPyramid& pyramid) {
+        glm::vec2 uvMin(1e30f);
+        glm::vec2 uvMax(-1e30f);
+        float nearest = 1.0f;
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec4 p((corner & 1) ? chunk.boxMax.x : chunk.boxMin.x,
+                        (corner & 2) ? chunk.boxMax.y : chunk.boxMin.y,
+                        (corner & 4) ? chunk.boxMax.z : chunk.boxMin.z, 1.0f);
+            glm::vec4 clip = params.hiZViewProj * p;
+            if (clip.w <= MIN_CLIP_W) {
+                return false;
+            }
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            glm::vec2 uv = glm::vec2(ndc) * 0.5f + 0.5f;
+            uvMin = glm::min(uvMin, uv);
+            uvMax = glm::max(uvMax, uv);
+            nearest = std::min(nearest, ndc.z);
+        }
+        // Nothing is known about what was outside last frame's view
+        if (nearest <= 0.0f || uvMin.x < 0.0f || uvMin.y < 0.0f || uvMax.x > 1.0f || uvMax.y > 1.0f) {
+            return false;
+        }
+
+        glm::vec2 pixelMin = uvMin * params.hiZSize;
+        glm::vec2 pixelMax = uvMax * params.hiZSize;
+        uint32_t level = std::min(hiZLevelFor(std::max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y)),
+                                  params.hiZLevels - 1);
+        glm::ivec2 last = pyramid.sizes[level] - 1;
+        float scale = 1.0f / static_cast<float>(1u << level);
+        glm::ivec2 lo = glm::clamp(glm::ivec2(glm::floor(pixelMin * scale)), glm::ivec2(0), last);
+        glm::ivec2 hi = glm::clamp(glm::ivec2(glm::floor(pixelMax * scale)), glm::ivec2(0), last);
+        float farthest = 0.0f;
+        for (int y = lo.y; y <= hi.y; y++) {
+            for (int x = lo.x; x <= hi.x; x++) {
+                farthest = std::max(farthest, pyramid.texel(level, {x, y}));
+            }
+        }
+        return nearest > farthest;
+    }
+}
+
+GpuCullParams makeGpuCullParams(const glm::mat4& viewProj, const glm::mat4& hiZViewProj,
+                                glm::ivec2 hiZSize, uint32_t hiZLevels, uint32_t chunkCount) {
+    Frustum frustum = Frustum::fromMatrix(viewProj);
+    GpuCullParams params{};
+    std::copy(std::begin(frustum.planes), std::end(frustum.planes), params.planes);
+    params.hiZViewProj = hiZViewProj;
+    params.hiZSize = glm::vec2(hiZSize);
+    params.hiZLevels = hiZLevels;
+    params.chunkCount = chunkCount;
+    return params;
+}
+
+uint32_t hiZLevelCount(glm::ivec2 size) {
+    uint32_t levels = 1;
+    while ((std::max(size.x, size.y) >> levels) > 0) {
+        levels++;
+    }
+    return levels;
+}
+
+HiZPyramid HiZPyramid::build(const std::vector<float>& depth, glm::ivec2 size) {
+    HiZPyramid pyramid;
+    uint32_t levelCount = hiZLevelCount(size);
+    pyramid.sizes.push_back(size);
+    pyramid.levels.push_back(depth);
+    for (uint32_t level = 1; level < levelCount; level++) {
+        glm::ivec2 src = pyramid.sizes.back();
+        glm::ivec2 dst = glm::max(size >> static_cast<int>(level), glm::ivec2(1));
+        std::vector<float> texels(static_cast<size_t>(dst.x) * dst.y);
+        for (int y = 0; y < dst.y; y++) {
+            for (int x = 0; x < dst.x; x++) {
+                glm::ivec2 base(x * 2, y * 2);
+                glm::ivec2 end = glm::min(base + 1, src - 1);
+                if (x == dst.x - 1) {
+                    end.x = src.x - 1;
+                }
+                if (y == dst.y - 1) {
+                    end.y = src.y - 1;
+                }
+                float farthest = 0.0f;
+                for (int sy = base.y; sy <= end.y; sy++) {
+                    for (int sx = base.x; sx <= end.x; sx++) {
+                        farthest = std::max(farthest, pyramid.levels.back()[static_cast<size_t>(sy) * src.x + sx]);
+                    }
+                }
+                texels[static_cast<size_t>(y) * dst.x + x] = farthest;
+            }
+        }
+        pyramid.sizes.push_back(dst);
+        pyramid.levels.push_back(std::move(texels));
+    }
+    return pyramid;
+}
+
+uint32_t hiZLevelFor(float pixels) {
+    int extent = static_cast<int>(std::ceil(pixels));
+    uint32_t level = 0;
+    while (level < 31 && (1 << level) < extent) {
+        level++;
+    }
+    return level;
+}
+
+bool gpuCullVisible(const GpuCullChunk& chunk, const GpuCullParams& params, const HiZPyramid* pyramid) {
+    if (chunk.vertexCount == 0) {
+        return false;
+    }
+    Frustum frustum;
+    std::copy(std::begin(params.planes), std::end(params.planes), frustum.planes);
+    if (!frustum.intersectsBox(glm::vec3(chunk.boxMin), glm::vec3(chunk.boxMax))) {
+        return false;
+    }
+    return params.hiZLevels == 0 || !pyramid || !hiZHidden(chunk, params, *pyramid);
+}
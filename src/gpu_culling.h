@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// CPU side of the GPU-driven chunk culling in shaders/cull.comp. The structs match the
+// shader's buffer layouts byte for byte; gpuCullVisible() is the same test in C++, used as
+// the reference the GPU output is checked against (see cull_bench).
+
+// One chunk mesh as cull.comp reads it (std430 storage buffer element)
+struct GpuCullChunk {
+    glm::vec4 boxMin;      // xyz = drawn bounds, w unused
+    glm::vec4 boxMax;
+    uint32_t firstVertex;  // Draw range in the shared vertex buffer
+    uint32_t vertexCount;  // 0 = empty slot, never drawn
+    uint32_t padding[2];
+};
+static_assert(sizeof(GpuCullChunk) == 48, "must match the std430 Chunk struct in cull.comp");
+
+// Per-frame inputs of cull.comp (std140 uniform block)
+struct GpuCullParams {
+    glm::vec4 planes[6];      // Frustum::planes of this frame's camera
+    glm::mat4 hiZViewProj;    // The matrix the Hi-Z depth was drawn with, i.e. last frame's
+    glm::vec2 hiZSize;        // Mip 0 size in texels
+    uint32_t hiZLevels;       // 0 = frustum test only
+    uint32_t chunkCount;
+};
+static_assert(sizeof(GpuCullParams) == 176, "must match the std140 CullParams block in cull.comp");
+
+GpuCullParams makeGpuCullParams(const glm::mat4& viewProj, const glm::mat4& hiZViewProj,
+                                glm::ivec2 hiZSize, uint32_t hiZLevels, uint32_t chunkCount);
+
+// Levels down to 1x1 for a depth buffer of this size
+uint32_t hiZLevelCount(glm::ivec2 size);
+
+// Farthest depth (0..1, 1 = far plane) under each texel of each level. Level sizes halve
+// rounding down like Vulkan mips, so on odd sizes the last texel of a row or column also
+// covers the leftover texel of the level below. Same reduction as shaders/hiz_reduce.comp.
+struct HiZPyramid {
+    std::vector<glm::ivec2> sizes;
+    std::vector<std::vector<float>> levels;
+
+    static HiZPyramid build(const std::vector<float>& depth, glm::ivec2 size);
+
+    float texel(uint32_t level, glm::ivec2 at) const {
+        return levels[level][static_cast<size_t>(at.y) * sizes[level].x + at.x];
+    }
+};
+
+// Mip whose texels are at least as large as a `pixels`-wide footprint, so the footprint
+// touches at most 2x2 of them
+uint32_t hiZLevelFor(float pixels);
+
+// cull.comp for one chunk: inside the frustum and, when params.hiZLevels > 0, not behind the
+// depth in `pyramid`. The Hi-Z test is conservative: boxes it can't project (crossing the
+// near plane, or off last frame's screen) are kept.
+bool gpuCullVisible(const GpuCullChunk& chunk, const GpuCullParams& params, const HiZPyramid* pyramid);
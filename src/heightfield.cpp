@@ -0,0 +1,60 @@
+#include "heightfield.h"
+
+bool buildHeightfield(const ChunkSdfGrid& grid, HeightfieldData& out) {
+    // Same inside test as the mesher: a sample is air when it is below the iso level
+    int direction = 0;  // +1 solid below the surface, -1 solid above
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            bool previousAir = grid.at(x, 0, z) < 0.0f;
+            int crossing = -1;
+            for (int y = 1; y < CHUNK_SIZE; y++) {
+                bool air = grid.at(x, y, z) < 0.0f;
+                if (air == previousAir) {
+                    continue;
+                }
+                if (crossing >= 0) {
+                    return false;
+                }
+                crossing = y - 1;
+                previousAir = air;
+            }
+            if (crossing < 0) {
+                return false;
+            }
+
+            int columnDirection = previousAir ? 1 : -1;
+            if (direction == 0) {
+                direction = columnDirection;
+            } else if (direction != columnDirection) {
+                return false;
+            }
+
+            out.cell[x][z] = static_cast<uint8_t>(crossing);
+            out.below[x][z] = grid.at(x, crossing, z);
+            out.above[x][z] = grid.at(x, crossing + 1, z);
+        }
+    }
+
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            out.border[static_cast<int>(ChunkFace::MinX)][i][y] = grid.at(0, y, i);
+            out.border[static_cast<int>(ChunkFace::MaxX)][i][y] = grid.at(CHUNK_CUBES, y, i);
+            out.border[static_cast<int>(ChunkFace::MinZ)][i][y] = grid.at(i, y, 0);
+            out.border[static_cast<int>(ChunkFace::MaxZ)][i][y] = grid.at(i, y, CHUNK_CUBES);
+        }
+    }
+    return true;
+}
+
+bool compactChunkToHeightfield(VolumeChunk& chunk) {
+    if (!chunk.sdf) {
+        return false;
+    }
+    auto field = std::make_unique<HeightfieldData>();
+    if (!buildHeightfield(*chunk.sdf, *field)) {
+        return false;
+    }
+    chunk.heightfield = std::move(field);
+    chunk.sdf.reset();
+    return true;
+}
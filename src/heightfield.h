@@ -0,0 +1,12 @@
+#pragma once
+
+#include "chunk.h"
+
+// Fill `out` from a chunk SDF if every column has exactly one surface crossing, all in the
+// same direction. Returns false (contents of `out` unspecified) for chunks with overhangs,
+// caves, columns with no crossing, or solid-above columns next to solid-below ones.
+bool buildHeightfield(const ChunkSdfGrid& grid, HeightfieldData& out);
+
+// Replace the chunk's SDF with a heightfield when buildHeightfield succeeds.
+// Call after the SDF is complete and before sdfReady is set.
+bool compactChunkToHeightfield(VolumeChunk& chunk);
@@ -0,0 +1,192 @@
+#include "horizon_culling.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+    // Directions are "diamond angles": monotonic in the true angle like atan2, but only a divide.
+    // Opposite directions are half a turn apart, and sectors needn't be equal true angles.
+    constexpr float FULL_TURN = 4.0f;
+    constexpr float INSIDE_MARGIN = 0.01f;  // A camera on a box's edge counts as inside it
+
+    float diamondAngle(float dx, float dz) {
+        float p = dx / (std::abs(dx) + std::abs(dz));
+        return dz >= 0.0f ? 1.0f - p : 3.0f + p;
+    }
+
+    float wrapAngle(float angle) {
+        if (angle > FULL_TURN * 0.5f) {
+            return angle - FULL_TURN;
+        }
+        if (angle <= -FULL_TURN * 0.5f) {
+            return angle + FULL_TURN;
+        }
+        return angle;
+    }
+
+    // Directions [lo, hi] (lo in [0, FULL_TURN), hi may pass it) and nearest/farthest distances of
+    // an xz rectangle seen from `eye`. False if the eye is inside it, where it spans every direction.
+    bool rectSpan(glm::vec3 eye, glm::vec2 rectMin, glm::vec2 rectMax,
+                  float& lo, float& hi, float& nearDist, float& farDist) {
+        if (eye.x > rectMin.x - INSIDE_MARGIN && eye.x < rectMax.x + INSIDE_MARGIN &&
+            eye.z > rectMin.y - INSIDE_MARGIN && eye.z < rectMax.y + INSIDE_MARGIN) {
+            return false;
+        }
+        glm::vec2 center = (rectMin + rectMax) * 0.5f;
+        float centerAngle = diamondAngle(center.x - eye.x, center.y - eye.z);
+        float minDelta = 0.0f;
+        float maxDelta = 0.0f;
+        farDist = 0.0f;
+        for (int corner = 0; corner < 4; corner++) {
+            float x = (corner & 1) ? rectMax.x : rectMin.x;
+            float z = (corner & 2) ? rectMax.y : rectMin.y;
+            float delta = wrapAngle(diamondAngle(x - eye.x, z - eye.z) - centerAngle);
+            minDelta = std::min(minDelta, delta);
+            maxDelta = std::max(maxDelta, delta);
+            farDist = std::max(farDist, (x - eye.x) * (x - eye.x) + (z - eye.z) * (z - eye.z));
+        }
+        farDist = std::sqrt(farDist);
+        float dx = std::max({rectMin.x - eye.x, 0.0f, eye.x - rectMax.x});
+        float dz = std::max({rectMin.y - eye.z, 0.0f, eye.z - rectMax.y});
+        nearDist = std::sqrt(dx * dx + dz * dz);
+
+        lo = centerAngle + minDelta;
+        if (lo < 0.0f) {
+            lo += FULL_TURN;
+        }
+        hi = lo + (maxDelta - minDelta);
+        return true;
+    }
+
+    // Over distances [nearDist, farDist]: the lowest and highest of height / distance
+    float minSlope(float height, float nearDist, float farDist) {
+        return height >= 0.0f ? height / farDist : height / std::max(nearDist, 1e-3f);
+    }
+
+    float maxSlope(float height, float nearDist, float farDist) {
+        return height >= 0.0f ? height / std::max(nearDist, 1e-3f) : height / farDist;
+    }
+}
+
+int countSolidBase(const VolumeChunk& chunk) {
+    int solid = CHUNK_SIZE;
+    for (int x = 0; x < CHUNK_SIZE && solid > 0; x++) {
+        for (int z = 0; z < CHUNK_SIZE && solid > 0; z++) {
+            int y = 0;
+            while (y < solid && chunk.sdfAt(x, y, z) > 0.0f) {
+                y++;
+            }
+            solid = y;
+        }
+    }
+    return solid;
+}
+
+void buildHorizonColumns(std::vector<HorizonChunk>& chunks, std::vector<HorizonColumn>& columns) {
+    columns.clear();
+    std::sort(chunks.begin(), chunks.end(), [](const HorizonChunk& a, const HorizonChunk& b) {
+        return std::tie(a.coord.x, a.coord.z, a.coord.y) < std::tie(b.coord.x, b.coord.z, b.coord.y);
+    });
+
+    size_t i = 0;
+    while (i < chunks.size()) {
+        size_t end = i;
+        while (end < chunks.size() && chunks[end].coord.x == chunks[i].coord.x &&
+               chunks[end].coord.z == chunks[i].coord.z) {
+            end++;
+        }
+
+        // Climb from the lowest chunk while the chunks are stacked without gaps and solid throughout
+        float floorY = chunks[i].coord.y * CHUNK_WORLD_SIZE;
+        float groundY = floorY;
+        int expectedY = chunks[i].coord.y;
+        for (size_t k = i; k < end && chunks[k].coord.y == expectedY; k++, expectedY++) {
+            float bottom = chunks[k].coord.y * CHUNK_WORLD_SIZE;
+            if (chunks[k].solidBase < CHUNK_SIZE) {
+                if (chunks[k].solidBase > 0) {
+                    groundY = bottom + (chunks[k].solidBase - 1) * VOXEL_SIZE;
+                }
+                break;
+            }
+            groundY = bottom + CHUNK_WORLD_SIZE;
+        }
+        if (groundY > floorY) {
+            columns.push_back({{chunks[i].coord.x, chunks[i].coord.z}, floorY, groundY});
+        }
+        i = end;
+    }
+}
+
+void HorizonCuller::build(glm::vec3 camera, const std::vector<HorizonColumn>& columns, const HorizonSettings& settings) {
+    eye = camera;
+    active = true;
+    int sectorCount = std::max(settings.sectors, 8);
+    sectorWidth = FULL_TURN / sectorCount;
+    steps.resize(sectorCount);
+    for (std::vector<Step>& sector : steps) {
+        sector.clear();
+    }
+
+    struct Occluder {
+        float lo, hi, nearDist, farDist, slope, floorSlope;
+    };
+    std::vector<Occluder> occluders;
+    occluders.reserve(columns.size());
+    for (const HorizonColumn& column : columns) {
+        glm::vec2 rectMin(column.column.x * CHUNK_WORLD_SIZE, column.column.z * CHUNK_WORLD_SIZE);
+        Occluder o;
+        if (!rectSpan(eye, rectMin, rectMin + glm::vec2(CHUNK_WORLD_SIZE), o.lo, o.hi, o.nearDist, o.farDist)) {
+            if (eye.y > column.floorY && eye.y < column.groundY) {
+                active = false;
+            }
+            continue;
+        }
+        o.slope = minSlope(column.groundY - eye.y, o.nearDist, o.farDist);
+        o.floorSlope = maxSlope(column.floorY - eye.y, o.nearDist, o.farDist);
+        occluders.push_back(o);
+    }
+
+    // Outward sweep: a column only raises the horizon of the sectors it covers completely
+    std::sort(occluders.begin(), occluders.end(),
+              [](const Occluder& a, const Occluder& b) { return a.farDist < b.farDist; });
+    for (const Occluder& o : occluders) {
+        int first = static_cast<int>(std::ceil(o.lo / sectorWidth));
+        int last = static_cast<int>(std::floor(o.hi / sectorWidth)) - 1;
+        for (int s = first; s <= last; s++) {
+            std::vector<Step>& sector = steps[s % sectorCount];
+            if (sector.empty() || o.slope > sector.back().slope) {
+                sector.push_back({o.farDist, o.slope, o.floorSlope});
+            }
+        }
+    }
+}
+
+bool HorizonCuller::isHidden(glm::vec3 boxMin, glm::vec3 boxMax) const {
+    if (!active) {
+        return false;
+    }
+    float lo, hi, nearDist, farDist;
+    if (!rectSpan(eye, glm::vec2(boxMin.x, boxMin.z), glm::vec2(boxMax.x, boxMax.z), lo, hi, nearDist, farDist)) {
+        return false;
+    }
+    float topSlope = maxSlope(boxMax.y - eye.y, nearDist, farDist);
+    float bottomSlope = minSlope(boxMin.y - eye.y, nearDist, farDist);
+
+    int sectorCount = static_cast<int>(steps.size());
+    int first = static_cast<int>(std::floor(lo / sectorWidth));
+    int last = static_cast<int>(std::floor(hi / sectorWidth));
+    for (int s = first; s <= last; s++) {
+        const std::vector<Step>& sector = steps[s % sectorCount];
+        // The horizon of the columns wholly nearer than the box
+        auto after = std::lower_bound(sector.begin(), sector.end(), nearDist,
+                                      [](const Step& step, float d) { return step.distance < d; });
+        if (after == sector.begin()) {
+            return false;
+        }
+        const Step& horizon = *(after - 1);
+        if (topSlope >= horizon.slope || bottomSlope < horizon.floorSlope) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "chunk.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// Consecutive solid samples from the bottom of a chunk's SDF, fewest over all its columns:
+// 0 if any column starts in air, CHUNK_SIZE if the chunk is solid throughout. Any thread.
+int countSolidBase(const VolumeChunk& chunk);
+
+// A resident chunk as the horizon map sees it
+struct HorizonChunk {
+    ChunkCoord coord;
+    int solidBase;  // countSolidBase, or 0 if unknown
+};
+
+// Where a chunk column is certainly solid: from the bottom of its lowest resident chunk
+// up to groundY, over its whole footprint
+struct HorizonColumn {
+    ColumnCoord column;
+    float floorY;
+    float groundY;
+};
+
+// One entry per column whose lowest resident chunk starts solid. Sorts `chunks`.
+void buildHorizonColumns(std::vector<HorizonChunk>& chunks, std::vector<HorizonColumn>& columns);
+
+struct HorizonSettings {
+    int sectors = 256;  // Angular resolution around the camera
+};
+
+// Horizon occlusion for the mostly-heightfield outdoors: the columns are swept outward from
+// the camera in angular sectors, each sector keeping its running horizon elevation (as a
+// slope) against distance. A box is hidden when, in every sector it spans, a nearer column
+// blocks all sight lines to it: they pass below that column's ground and above its floor.
+class HorizonCuller {
+public:
+    void build(glm::vec3 camera, const std::vector<HorizonColumn>& columns, const HorizonSettings& settings);
+
+    bool isHidden(glm::vec3 boxMin, glm::vec3 boxMax) const;
+
+    // False when the camera is inside a solid column (noclip), which hides nothing
+    bool isActive() const { return active; }
+
+private:
+    // The horizon from `distance` on: rises with distance within a sector
+    struct Step {
+        float distance;    // Far edge of the column that raised it
+        float slope;       // Lowest (ground - eye) / distance over that column
+        float floorSlope;  // Sight lines must stay above this to hit the column's solid
+    };
+
+    glm::vec3 eye{0.0f};
+    bool active = false;
+    float sectorWidth = 0.0f;
+    std::vector<std::vector<Step>> steps;  // Per sector; inner vectors keep their capacity
+};
@@ -11,6 +11,7 @@
 #include <vector>
 #include <stdexcept>
 #include <cstdlib>
+#include <cmath>
 #include <optional>
 #include <set>
 #include <algorithm>
@@ -25,14 +26,52 @@
 #include <condition_variable>
 #include <queue>
 #include <atomic>
+#include <memory>
 
 #include "camera.h"
 #include "chunk_manager.h"
+#include "gpu_culling.h"
 #include "marching_cubes.h"
+#include "occlusion.h"
+#include "upload_scheduler.h"
+#include "memory_governor.h"
+#include "horizon_culling.h"
+#include "sampling_profiler.h"
+#include "stream_debug.h"
+#include "thread_topology.h"
+#include "scatter.h"
+#include "navigation.h"
+#include "tuning.h"
+#include "vertex_arena.h"
+// Last: reroutes the vk* calls below through the call counters
+#include "vk_counters.h"
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
-const int MAX_FRAMES_IN_FLIGHT = 2;
+const int MAX_FRAMES_IN_FLIGHT = 3;  // Per-frame resources allocated; framesInFlight picks how many are used
+const char* TUNING_FILE = "tuning.cfg";
+const char* STAMP_FILE = "stamps.txt";  // Hand-placed primitives, reread on regenerate
+const char* TERRAIN_TILE_FILE = "terrain.ntile";  // Noise tile caches for tiled_noise
+const char* CAVE_TILE_FILE = "caves.ntile";
+
+// Occlusion queries per frame in flight; chunks beyond this are drawn untested
+const uint32_t MAX_OCCLUSION_QUERIES = 4096;
+// Query boxes are grown by this much so a chunk's own surface can't hide its box
+const float OCCLUSION_BOX_MARGIN = VOXEL_SIZE;
+const uint32_t MAX_DEBUG_LINE_VERTICES = 65536;  // 24 per chunk box
+
+// One device-local buffer holds every chunk mesh (vertices, then prop instances). A mesh that
+// doesn't fit waits in readyMeshes until unloads free a large enough range.
+const uint64_t MESH_ARENA_BYTES = 256ull << 20;
+// Hi-Z pyramid levels with a reduce descriptor set each: enough for a 32768 pixel swapchain
+const uint32_t MAX_HIZ_LEVELS = 16;
+
+// Chunk SDFs are filled in x-slabs so several threads can share one chunk
+const int GENERATION_SLAB_WIDTH = 4;
+const int GENERATION_SLAB_COUNT = (CHUNK_SIZE + GENERATION_SLAB_WIDTH - 1) / GENERATION_SLAB_WIDTH;
+
+// New chunks first get a mesh from every COARSE_STRIDE-th sample (9^3 instead of 33^3)
+const int COARSE_STRIDE = 4;
 
 struct Vertex {
     glm::vec3 pos;
@@ -129,23 +168,98 @@ struct SwapChainSupportDetails {
 struct PendingMeshUpload {
     ChunkCoord coord;
     std::vector<MarchingCubesVertex> vertices;
+    MeshStats stats;
+    bool coarse = false;  // First-pass mesh, shown until the full-resolution one is uploaded
+    ChunkProps props;     // Uploaded after the vertices (none for coarse meshes)
+    int solidBase = 0;    // countSolidBase of the chunk's SDF (0 for coarse meshes)
+    ArenaRange range;     // Arena space, allocated by the main thread when the upload is chosen
+};
+
+// A chunk the player needs for collision right now, split across every idle thread
+struct UrgentGenerationJob {
+    VolumeChunk* chunk = nullptr;
+    std::atomic<int> nextSlab{0};
+    std::atomic<int> slabsDone{0};
+    std::chrono::steady_clock::time_point requestTime;
+};
+
+// Bounding box of an occlusion query, drawn by shaders/bbox.vert
+struct BoxPushConstants {
+    glm::vec4 boxMin;
+    glm::vec4 boxMax;
+};
+
+// A chunk to draw this frame, optionally inside an occlusion query
+struct ChunkDraw {
+    VolumeChunk* chunk;
+    bool query;
 };
 
 struct PendingUpload {
     ChunkCoord coord;
+    // Installed in the chunk once the copy is done; until then the chunk keeps drawing its old mesh
+    ArenaRange range;
+    uint32_t vertexCount = 0;
+    bool coarse = false;
+    std::array<uint32_t, PROP_TYPE_COUNT> propCounts{};
+};
+
+// One frame's uploads: every mesh packed into one staging buffer, copied by one command buffer
+struct UploadBatch {
     VkBuffer stagingBuffer = VK_NULL_HANDLE;
     VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
     VkFence fence = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;  // Start and end of the copies, if the queue has timestamps
+    uint64_t bytes = 0;
+    std::vector<PendingUpload> uploads;
+};
+
+// An arena range replaced while frames that draw it may still be in flight
+struct RetiredRange {
+    ArenaRange range;
+    uint64_t frame;  // renderFrameIndex when it was replaced
+};
+
+// One frame in flight's buffers for shaders/cull.comp. The parameters, chunk records and
+// count are host-visible: planChunkDraws writes the records in place and the stats read the
+// count back once the frame's fence has signalled. The commands never leave the GPU.
+struct GpuCullFrame {
+    uint32_t capacity = 0;  // Chunk records the chunk and draw buffers hold
+    VkBuffer paramsBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory paramsMemory = VK_NULL_HANDLE;
+    void* paramsMapped = nullptr;
+    VkBuffer chunkBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory chunkMemory = VK_NULL_HANDLE;
+    void* chunkMapped = nullptr;
+    VkBuffer drawBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory drawMemory = VK_NULL_HANDLE;
+    VkBuffer countBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory countMemory = VK_NULL_HANDLE;
+    void* countMapped = nullptr;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    uint32_t chunkCount = 0;    // Records in the cull last recorded in this slot
+    uint32_t liveCount = 0;     // Of those, records with vertices (not hidden by the horizon)
+    bool countPending = false;  // countBuffer holds a result the stats haven't read
+};
+
+// hiz_reduce.comp push constants
+struct HiZReducePushConstants {
+    glm::ivec2 srcSize;
+    glm::ivec2 dstSize;
+    uint32_t reduce;  // 0 = copy the depth buffer into level 0
 };
 
 class VulkanApp {
 public:
     void run() {
+        startSamplingProfiler(profilerHz);
+        registerProfiledThread("main");
         initWindow();
         initVulkan();
         mainLoop();
         cleanup();
+        stopSamplingProfiler(".");
     }
 
 private:
@@ -189,6 +303,69 @@ private:
     VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
     VkImageView depthImageView = VK_NULL_HANDLE;
 
+    // Every chunk mesh is a range of this one buffer; chunks draw with firstVertex into it
+    VkBuffer meshArenaBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory meshArenaMemory = VK_NULL_HANDLE;
+    VertexArena meshArena;
+    bool meshArenaFullWarned = false;
+
+    // GPU-driven culling: cull.comp turns the chunk records into draw commands for
+    // vkCmdDrawIndirectCount, optionally testing them against a Hi-Z pyramid of last frame's
+    // depth. Needs Vulkan 1.2 or VK_KHR_draw_indirect_count plus multiDrawIndirect and
+    // drawIndirectFirstInstance; without them every frame takes the CPU path in planChunkDraws.
+    uint32_t instanceApiVersion = VK_API_VERSION_1_0;
+    bool gpuCullingSupported = false;
+    bool drawIndirectCountCore = false;  // Core 1.2 entry point, else the KHR extension
+    bool hiZSupported = false;           // The depth format can be sampled
+    uint32_t maxDrawIndirectCount = 0;   // More chunks than this fall back to the CPU path
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+    VkDescriptorPool cullDescriptorPool = VK_NULL_HANDLE;
+    std::array<GpuCullFrame, MAX_FRAMES_IN_FLIGHT> cullFrames{};
+    // Hi-Z pyramid: farthest depth per texel on every level, sized like the swapchain
+    VkDescriptorSetLayout reduceSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout reducePipelineLayout = VK_NULL_HANDLE;
+    VkPipeline reducePipeline = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, MAX_HIZ_LEVELS> reduceSets{};  // Level below (or depth) -> level
+    VkSampler hiZSampler = VK_NULL_HANDLE;
+    VkImage hiZImage = VK_NULL_HANDLE;
+    VkDeviceMemory hiZImageMemory = VK_NULL_HANDLE;
+    VkImageView hiZView = VK_NULL_HANDLE;       // Every level, for cull.comp
+    std::vector<VkImageView> hiZLevelViews;     // One level each, for hiz_reduce.comp
+    VkImageAspectFlags hiZDepthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    uint32_t hiZLevels = 0;
+    bool hiZValid = false;      // Built at least once since the swapchain was (re)created
+    glm::mat4 hiZViewProj{1.0f};  // The matrix the pyramid's depth was drawn with
+
+    // Occlusion culling: bounding-box pipeline, one query pool per frame in flight, and the
+    // chunk each query in flight belongs to (results are read when the frame's fence is waited on)
+    VkPipelineLayout bboxPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline bboxPipeline = VK_NULL_HANDLE;
+    std::array<VkQueryPool, MAX_FRAMES_IN_FLIGHT> occlusionQueryPools{};
+    std::array<std::vector<ChunkCoord>, MAX_FRAMES_IN_FLIGHT> occlusionQueryChunks;
+    // GPU time of the chunk draws and of the box queries: 3 timestamps per frame
+    std::array<VkQueryPool, MAX_FRAMES_IN_FLIGHT> timestampQueryPools{};
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> timestampsWritten{};
+    float timestampPeriodNs = 0.0f;  // 0 if the graphics queue can't write timestamps
+    uint64_t timestampMask = 0;
+    uint64_t renderFrameIndex = 0;
+    bool occlusionKeyWasPressed = false;
+
+    // Streaming overlay: lines rebuilt every frame into a mapped buffer per frame in flight
+    VkPipeline debugLinePipeline = VK_NULL_HANDLE;
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> debugLineBuffers{};
+    std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> debugLineBuffersMemory{};
+    std::array<void*, MAX_FRAMES_IN_FLIGHT> debugLineBuffersMapped{};
+    std::vector<MarchingCubesVertex> debugLines;
+    bool overlayKeyWasPressed = false;
+
+    // Scattered props: one shared mesh buffer, instances live in each chunk's arena range
+    VkPipeline propPipeline = VK_NULL_HANDLE;
+    VkBuffer propMeshBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory propMeshBufferMemory = VK_NULL_HANDLE;
+    PropMeshes propMeshes;
+
     std::chrono::steady_clock::time_point startTime;
     std::chrono::steady_clock::time_point lastFpsTime;
     uint32_t frameCount = 0;
@@ -202,22 +379,92 @@ private:
     // Chunk system
     ChunkManager chunkManager;
     MarchingCubes marchingCubes;
-
-    std::thread generationThread;
+    // Agents walk by the player's slope and height limits
+    NavWorld navWorld{NavSettings{camera.maxWalkableSlope, camera.playerHeight}};
+
+    std::vector<std::thread> generationThreads;
+    CpuTopology cpuTopology;  // Detected before the main thread is pinned
+    ThreadPolicy threadPolicy;
+    ThreadLayout threadLayout;
+    bool threadPolicyDirty = false;
+    std::atomic<bool> workerPolicyWarned{false};
     std::mutex generationMutex;
     std::condition_variable generationCv;
     std::queue<VolumeChunk*> generationQueue;
+    std::queue<ChunkCoord> coarseQueue;  // First-pass meshes, served before generationQueue
+    std::shared_ptr<UrgentGenerationJob> urgentJob;  // Guarded by generationMutex
+    std::atomic<bool> urgentPending{false};          // Urgent job has unclaimed slabs
+    std::atomic<float> lastUrgentLatencyMs{-1.0f};
 
     std::mutex completedMutex;
     std::queue<PendingMeshUpload> completedMeshes;
     std::atomic<bool> generationRunning{false};
 
-    std::vector<PendingUpload> pendingUploads;
+    std::vector<PendingMeshUpload> readyMeshes;  // Main thread: drained from completedMeshes, at most one per chunk
+    std::vector<UploadBatch> uploadBatches;
+    UploadThroughput uploadThroughput;
+    std::vector<RetiredRange> retiredRanges;
 
     float uploadWorkMsAccum = 0.0f;
     int uploadFramesAccum = 0;
     int uploadsSubmittedThisSecond = 0;
     int fencesCompletedThisSecond = 0;
+    uint32_t trianglesKeptThisSecond = 0;
+    uint32_t trianglesRemovedThisSecond = 0;
+    uint32_t chunksDrawnThisSecond = 0;
+    uint32_t frustumCulledThisSecond = 0;
+    uint32_t occludedThisSecond = 0;
+    uint32_t horizonCulledThisSecond = 0;
+    uint32_t gpuCulledThisSecond = 0;  // Records cull.comp dropped (frustum and Hi-Z)
+    float horizonMsAccum = 0.0f;
+    uint64_t trianglesOccludedThisSecond = 0;
+    uint32_t occlusionQueriesThisSecond = 0;
+    uint32_t propDrawsThisSecond = 0;
+    uint64_t propInstancesThisSecond = 0;
+    float drawGpuMsAccum = 0.0f;
+    float queryGpuMsAccum = 0.0f;
+    int gpuTimedFrames = 0;
+
+    // Runtime-tunable streaming and rendering knobs (see registerTuning)
+    TuningRegistry tuning;
+    float chunkUpdateInterval = 0.5f;
+    int loadRadius = 1;
+    int unloadRadius = 4;  // Vertical unload radius is twice this
+    UploadSchedulerSettings uploadSettings;
+    int framesInFlight = 2;
+    NoiseOctaves noiseOctaves;
+    int heightfieldChunks = 1;
+    int tiledNoise = 0;
+    bool generatorSettingsDirty = false;
+    int occlusionCulling = 1;
+    int gpuCulling = 1;  // Only used if gpuCullingSupported
+    OcclusionSettings occlusionSettings;
+    int horizonCulling = 1;
+    HorizonSettings horizonSettings;
+    HorizonCuller horizonCuller;
+    std::vector<HorizonChunk> horizonChunks;
+    std::vector<HorizonColumn> horizonColumns;
+    bool horizonColumnsDirty = true;  // Chunks loaded, unloaded or meshed since the columns were built
+    int collisionRadius = 1;          // Chunks (cube) that keep their SDF for physics
+    float collisionBudgetMb = 16.0f;  // Full SDFs resident for the collision tier
+    int streamOverlay = 0;            // StreamOverlayMode
+    int progressiveChunks = 1;        // Coarse mesh first, full resolution later
+    int drawProps = 1;
+    float propDrawDistance = 96.0f;   // Chunks farther than this draw no props
+    int navigation = 1;               // Build walkable graphs on the workers
+    int profilerHz = 997;             // Sampling profiler rate (builds with ENABLE_SAMPLING_PROFILER); off-round against periodic work
+    int memoryGovernorEnabled = 1;    // Shed caches and radii under cgroup/PSI memory pressure
+    MemoryGovernorSettings memorySettings;
+    MemoryGovernor memoryGovernor;
+    int coarseUploadsThisSecond = 0;
+    int vkTrace = 0;                    // Log every frame that creates or destroys Vulkan objects
+    VkFrameCounters vkThisSecond;
+    uint64_t vkReportFrames = 0;        // Frames since the last "vk" report
+
+    // Frame time spread over the last second, to see what the workers cost the main thread
+    double frameMsSum = 0.0;
+    double frameMsSumSq = 0.0;
+    float frameMsMax = 0.0f;
 
     static void framebufferResizeCallback(GLFWwindow* window, int /*width*/, int /*height*/) {
         auto app = reinterpret_cast<VulkanApp*>(glfwGetWindowUserPointer(window));
@@ -268,25 +515,34 @@ private:
         createRenderPass();
         createDescriptorSetLayout();
         createGraphicsPipeline();
+        createOcclusionResources();
         createCommandPool();
         createDepthResources();
         createFramebuffers();
         createVertexBuffer();
         createIndexBuffer();
+        createPropMeshBuffer();
+        createMeshArena();
         createUniformBuffers();
+        createDebugOverlayResources();
         createDescriptorPool();
         createDescriptorSets();
+        createGpuCullingResources();
         createCommandBuffers();
         createSyncObjects();
 
         startTime = std::chrono::steady_clock::now();
         lastFpsTime = startTime;
 
-        startGenerationWorker();
+        cpuTopology = CpuTopology::detect();
+        std::cout << "CPU topology: " << cpuTopology.describe() << std::endl;
+        registerTuning();
+        applyThreadPolicy();
+        startGenerationWorkers();
 
         // Generate initial chunks (start small, will load more as you move)
         std::cout << "\n=== Generating initial chunks ===" << std::endl;
-        auto newChunks = chunkManager.updateChunks(camera.position, 1, 4);  // Start with 1 chunk radius
+        auto newChunks = chunkManager.updateChunks(camera.position, loadRadius, unloadRadius, collisionRadius);
         std::cout << "Total chunks loaded: " << chunkManager.getChunks().size() << std::endl;
         std::cout << "===================================\n" << std::endl;
 
@@ -300,25 +556,293 @@ private:
         std::cout << "Space - Jump (press again in air for double jump!)" << std::endl;
         std::cout << "Mouse - Look around" << std::endl;
         std::cout << "N - Toggle noclip (free fly mode)" << std::endl;
+        std::cout << "O - Toggle occlusion culling" << std::endl;
+        std::cout << "F3 - Cycle streaming overlay (state / time / triangles / off)" << std::endl;
         std::cout << "ESC - Exit" << std::endl;
         std::cout << "Physics enabled! You'll fall to the ground." << std::endl;
         std::cout << "================\n" << std::endl;
     }
 
-    void startGenerationWorker() {
+    void registerTuning() {
+        tuning.addFloat("chunk_update_interval", &chunkUpdateInterval, 0.05f, 5.0f,
+                        "Seconds between chunk load/unload passes");
+        tuning.addInt("load_radius", &loadRadius, 1, 8, "Chunks loaded around the camera");
+        tuning.addInt("unload_radius", &unloadRadius, 2, 16, "Chunks kept before unloading (x2 vertically)");
+        tuning.addFloat("upload_budget_ms", &uploadSettings.cpuBudgetMs, 0.0f, 16.0f,
+                        "Main thread time for mesh uploads per frame (sets the byte budget)");
+        tuning.addFloat("upload_gpu_budget_ms", &uploadSettings.gpuBudgetMs, 0.1f, 16.0f,
+                        "GPU transfer time for mesh uploads per frame (sets the byte budget)");
+        tuning.addInt("max_uploads_per_frame", &uploadSettings.maxUploads, 0, 256, "Mesh uploads submitted per frame");
+        tuning.addInt("frames_in_flight", &framesInFlight, 1, MAX_FRAMES_IN_FLIGHT, "CPU frames queued ahead of the GPU",
+                      [this]() { currentFrame %= framesInFlight; });
+
+        // Generator changes regenerate every chunk; batch them so a file reload does it once
+        noiseOctaves = chunkManager.getGenerator().getOctaves();
+        auto markGeneratorDirty = [this]() { generatorSettingsDirty = true; };
+        tuning.addInt("terrain_octaves", &noiseOctaves.terrain, 1, 8, "Fractal octaves of the terrain field", markGeneratorDirty);
+        tuning.addInt("cave_octaves", &noiseOctaves.caves, 1, 6, "Fractal octaves of the cave field", markGeneratorDirty);
+        tuning.addInt("detail_octaves", &noiseOctaves.detail, 1, 6, "Fractal octaves of the detail field", markGeneratorDirty);
+        tuning.addInt("heightfield_chunks", &heightfieldChunks, 0, 1, "Store overhang-free chunks as 2.5D heightfields",
+                      markGeneratorDirty);
+        tuning.addInt("tiled_noise", &tiledNoise, 0, 1,
+                      "Sample terrain and cave noise from periodic tiles (baked once, cached in *.ntile)", markGeneratorDirty);
+
+        tuning.addInt("collision_radius", &collisionRadius, 0, 8, "Chunks around the camera that keep their SDF");
+        tuning.addInt("memory_governor", &memoryGovernorEnabled, 0, 1,
+                      "Shed chunk caches, heightfields, collision SDFs and load radius under memory pressure");
+        tuning.addFloat("memory_usage_start", &memorySettings.usageStart, 0.3f, 0.98f,
+                        "Fraction of the memory limit where shedding starts");
+        tuning.addFloat("memory_pressure_start", &memorySettings.pressureStart, 0.5f, 50.0f,
+                        "PSI memory stall % (some avg10) where shedding starts");
+        tuning.addFloat("collision_budget_mb", &collisionBudgetMb, 1.0f, 1024.0f,
+                        "Memory for full SDFs of collision chunks, nearest first");
+        tuning.addInt("draw_props", &drawProps, 0, 1, "Draw scattered rocks and shrubs");
+#ifdef ENABLE_SAMPLING_PROFILER
+        tuning.addInt("profiler_hz", &profilerHz, 0, 10000, "Sampling profiler rate per thread (0 = paused)",
+                      [this]() { setSamplingRate(profilerHz); });
+#endif
+        tuning.addFloat("prop_draw_distance", &propDrawDistance, 0.0f, 1000.0f,
+                        "Distance to a chunk's box beyond which its props are skipped");
+        tuning.addInt("occlusion_culling", &occlusionCulling, 0, 1,
+                      "Skip chunks hidden behind terrain (GPU queries, or Hi-Z with gpu_culling)");
+        tuning.addInt("gpu_culling", &gpuCulling, 0, 1,
+                      "Cull chunks in cull.comp and draw them with one vkCmdDrawIndirectCount (if supported)");
+        tuning.addInt("horizon_culling", &horizonCulling, 0, 1, "Skip chunks below the terrain horizon (CPU)");
+        tuning.addInt("horizon_sectors", &horizonSettings.sectors, 32, 2048, "Angular sectors of the horizon around the camera");
+        tuning.addInt("occlusion_hide_frames", &occlusionSettings.hideAfterFrames, 1, 30,
+                      "Failed occlusion tests in a row before a chunk stops drawing");
+        tuning.addInt("occlusion_requery_interval", &occlusionSettings.visibleRequeryInterval, 1, 60,
+                      "Frames between occlusion re-tests of drawn chunks");
+        tuning.addInt("progressive_chunks", &progressiveChunks, 0, 1,
+                      "Show a coarse mesh of new chunks until the full-resolution one is ready");
+        tuning.addInt("stream_overlay", &streamOverlay, 0, static_cast<int>(StreamOverlayMode::Count) - 1,
+                      "Chunk boxes: 0 off, 1 lifecycle state, 2 gen+mesh time, 3 triangles");
+        auto markThreadPolicyDirty = [this]() { threadPolicyDirty = true; };
+        tuning.addInt("thread_pin_main", &threadPolicy.pinMainThread, 0, 1,
+                      "Pin the main thread to a physical core of its own", markThreadPolicyDirty);
+        tuning.addInt("thread_reserve_siblings", &threadPolicy.reserveSiblings, 0, 1,
+                      "Keep workers off the SMT siblings of the main thread's core", markThreadPolicyDirty);
+        tuning.addInt("worker_nice", &threadPolicy.workerNice, 0, 19, "Nice value of generation workers",
+                      markThreadPolicyDirty);
+        tuning.addInt("worker_sched_batch", &threadPolicy.workerSchedBatch, 0, 1,
+                      "Run generation workers under SCHED_BATCH", markThreadPolicyDirty);
+        tuning.addCommand("regenerate", "Reload stamps and regenerate every loaded chunk (saturates the workers)",
+                          [this]() { generatorSettingsDirty = true; });
+        tuning.addInt("navigation", &navigation, 0, 1, "Build navigation graphs for newly generated chunks");
+        tuning.addCommand("nav", "Print the navigation graph and time a path 30 m ahead of the camera",
+                          [this]() { printNavigationReport(); });
+        tuning.addCommand("chunks", "Print chunk states, the slowest chunks and a map around the camera",
+                          [this]() { printStreamReport(chunkManager, worldToChunkCoord(camera.position), streamRadii()); });
+        tuning.addCommand("vk", "Print Vulkan calls and time per frame by entry point since the last report", [this]() {
+            printVkCallReport(vkReportFrames);
+            vkReportFrames = 0;
+        });
+        tuning.addInt("vk_trace", &vkTrace, 0, 1, "Log each frame that creates or destroys Vulkan objects");
+
+        tuning.watchFile(TUNING_FILE);
+        if (generatorSettingsDirty) {
+            // Nothing generated yet, so the file's settings can go straight to the generator
+            applyGeneratorSettings();
+            generatorSettingsDirty = false;
+        }
+        loadStamps();  // Also before the workers start
+        threadPolicyDirty = false;  // Applied before the workers first start
+        tuning.startConsole();
+    }
+
+    // Not thread-safe: call with no chunk generating
+    void applyGeneratorSettings() {
+        VolumeGenerator& generator = chunkManager.getGenerator();
+        // Drop the tiles first so new octaves don't rebake them only to be replaced below
+        generator.useProceduralField(NoiseField::Terrain);
+        generator.useProceduralField(NoiseField::Caves);
+        generator.setOctaves(noiseOctaves);
+        if (tiledNoise) {
+            generator.useTiledField(NoiseField::Terrain, TERRAIN_TILE_RESOLUTION, TERRAIN_TILE_PERIOD, TERRAIN_TILE_FILE);
+            generator.useTiledField(NoiseField::Caves, CAVE_TILE_RESOLUTION, CAVE_TILE_PERIOD, CAVE_TILE_FILE);
+        }
+        chunkManager.setHeightfieldChunks(heightfieldChunks != 0);
+    }
+
+    // Not thread-safe, like the other generator settings: call with no chunk generating
+    void loadStamps() {
+        std::vector<SdfStamp> stamps;
+        loadStampFile(STAMP_FILE, stamps);
+        chunkManager.getGenerator().setStamps(std::move(stamps));
+    }
+
+    void applyTuning() {
+        tuning.update();
+
+        // Keep a band between loading and unloading so chunks don't thrash
+        if (unloadRadius <= loadRadius) {
+            unloadRadius = loadRadius + 1;
+            std::cout << "[tuning] unload_radius raised to " << unloadRadius << std::endl;
+        }
+        if (collisionRadius >= unloadRadius) {
+            collisionRadius = unloadRadius - 1;
+            std::cout << "[tuning] collision_radius lowered to " << collisionRadius << std::endl;
+        }
+
+        if (generatorSettingsDirty) {
+            generatorSettingsDirty = false;
+            if (threadPolicyDirty) {
+                // regenerateAllChunks restarts the workers anyway
+                threadPolicyDirty = false;
+                applyThreadPolicy();
+            }
+            regenerateAllChunks();
+        }
+        if (threadPolicyDirty) {
+            threadPolicyDirty = false;
+            restartGenerationWorkers();
+        }
+    }
+
+    // Pin the main thread and plan the workers' CPUs for the next startGenerationWorkers
+    void applyThreadPolicy() {
+        threadLayout = planThreadLayout(cpuTopology, threadPolicy);
+        if (!pinCurrentThread(threadLayout.mainCpus)) {
+            std::cout << "Could not set main thread affinity" << std::endl;
+        }
+        std::cout << "Main thread on CPU(s)";
+        for (int cpu : threadLayout.mainCpus) {
+            std::cout << " " << cpu;
+        }
+        std::cout << ", " << threadLayout.workerCount << " workers on";
+        for (int cpu : threadLayout.workerCpus) {
+            std::cout << " " << cpu;
+        }
+        std::cout << " (nice " << threadPolicy.workerNice << (threadPolicy.workerSchedBatch ? ", SCHED_BATCH)" : ")")
+                  << std::endl;
+    }
+
+    // New threads for a new policy; queued chunks carry over, chunks in progress finish first
+    void restartGenerationWorkers() {
+        std::queue<VolumeChunk*> queued;
+        std::queue<ChunkCoord> coarseQueued;
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            std::swap(queued, generationQueue);
+            std::swap(coarseQueued, coarseQueue);
+        }
+        stopGenerationWorkers();
+        applyThreadPolicy();
+        startGenerationWorkers();
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            std::swap(generationQueue, queued);
+            std::swap(coarseQueue, coarseQueued);
+        }
+        generationCv.notify_all();
+    }
+
+    // Throw away every chunk's SDF and mesh and generate them again with the current
+    // generator settings. Workers are stopped so nothing reads the noise while it changes.
+    void regenerateAllChunks() {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            while (!generationQueue.empty()) {
+                generationQueue.front()->generationQueued.store(false);
+                generationQueue.pop();
+            }
+            coarseQueue = std::queue<ChunkCoord>();
+        }
+        stopGenerationWorkers();
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            urgentJob.reset();
+            urgentPending.store(false);
+        }
+
+        vkDeviceWaitIdle(device);
+        flushPendingUploads();
+        freeRetiredRanges(true);
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completedMeshes = std::queue<PendingMeshUpload>();
+        }
+        readyMeshes.clear();
+
+        applyGeneratorSettings();
+        loadStamps();
+        chunkManager.invalidateColumnBounds();
+        chunkManager.getCollisionFallback().clear();
+        navWorld.clear();
+
+        std::vector<VolumeChunk*> toGenerate;
+        for (auto& [coord, chunk] : chunkManager.getChunks()) {
+            retireMesh(chunk->mesh);
+            chunk->mesh = ArenaRange{};
+            chunk->vertexCount = 0;
+            chunk->propCounts = {};
+            chunk->meshGenerated = false;
+            chunk->meshUploaded = false;
+            chunk->meshCoarse = false;
+            chunk->fullMeshSubmitted = false;
+            chunk->meshBuilt.store(false);
+            chunk->sdfReady.store(false);
+            chunk->sdfClaimed.store(false);
+            chunk->generationInProgress.store(false);
+            toGenerate.push_back(chunk.get());
+        }
+
+        ChunkCoord cameraChunk = worldToChunkCoord(camera.position);
+        std::sort(toGenerate.begin(), toGenerate.end(), [&](const VolumeChunk* a, const VolumeChunk* b) {
+            auto distSq = [&](const ChunkCoord& c) {
+                int dx = c.x - cameraChunk.x;
+                int dy = c.y - cameraChunk.y;
+                int dz = c.z - cameraChunk.z;
+                return dx * dx + dy * dy + dz * dz;
+            };
+            return distSq(a->coord) < distSq(b->coord);
+        });
+
+        startGenerationWorkers();
+        for (VolumeChunk* chunk : toGenerate) {
+            enqueueChunkGeneration(chunk);
+        }
+
+        std::cout << "Regenerating " << toGenerate.size() << " chunks (reset took "
+                  << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count()
+                  << " ms)" << std::endl;
+    }
+
+    void startGenerationWorkers() {
+        // Worker count and CPUs come from the thread policy (see applyThreadPolicy)
+        unsigned int workerCount = threadLayout.workerCount;
+
         generationRunning.store(true);
-        generationThread = std::thread([this]() { generationWorkerLoop(); });
+        for (unsigned int i = 0; i < workerCount; i++) {
+            generationThreads.emplace_back([this, cpus = threadLayout.workerCpus, policy = threadPolicy]() {
+                bool pinned = pinCurrentThread(cpus);
+                bool lowered = setCurrentThreadBackground(policy.workerNice, policy.workerSchedBatch != 0);
+                if ((!pinned || !lowered) && !workerPolicyWarned.exchange(true)) {
+                    std::cout << "Could not apply worker thread policy (affinity "
+                              << (pinned ? "ok" : "failed") << ", priority " << (lowered ? "ok" : "failed") << ")"
+                              << std::endl;
+                }
+                registerProfiledThread("generation");
+                generationWorkerLoop();
+                unregisterProfiledThread();
+            });
+        }
+        std::cout << "Started " << workerCount << " generation workers" << std::endl;
     }
 
-    void stopGenerationWorker() {
+    void stopGenerationWorkers() {
         {
             std::lock_guard<std::mutex> lock(generationMutex);
             generationRunning.store(false);
         }
         generationCv.notify_all();
-        if (generationThread.joinable()) {
-            generationThread.join();
+        for (std::thread& thread : generationThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
         }
+        generationThreads.clear();
     }
 
     void enqueueChunkGeneration(VolumeChunk* chunk) {
@@ -329,107 +853,465 @@ private:
         if (!chunk->generationQueued.compare_exchange_strong(expected, true)) {
             return;
         }
+        // Nothing on screen yet and the full mesh is a whole generation away: coarse pass first
+        bool coarse = progressiveChunks && chunk->renderTier.load() && !chunk->meshUploaded &&
+                      !chunk->fullMeshSubmitted && !chunk->sdfReady.load();
         {
             std::lock_guard<std::mutex> lock(generationMutex);
             generationQueue.push(chunk);
+            if (coarse) {
+                coarseQueue.push(chunk->coord);
+            }
         }
         generationCv.notify_one();
     }
 
+    // Fill one chunk with every worker (and the caller) instead of waiting for it in the queue.
+    // Only one urgent chunk is in flight at a time; returns false if nothing was started.
+    bool requestUrgentGeneration(VolumeChunk* chunk) {
+        if (!chunk || chunk->sdfReady.load()) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            if (urgentJob) {
+                return false;
+            }
+        }
+        // A worker is already generating it as a normal job. The request is dropped and the
+        // chunk arrives when that job finishes; there is no way to widen a job in flight.
+        if (chunk->sdfClaimed.exchange(true)) {
+            return false;
+        }
+
+        chunk->generationInProgress.store(true);
+        chunkManager.beginChunkSdf(*chunk);
+
+        auto job = std::make_shared<UrgentGenerationJob>();
+        job->chunk = chunk;
+        job->requestTime = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            urgentJob = job;
+            urgentPending.store(true);
+        }
+        generationCv.notify_all();
+        return true;
+    }
+
+    // Claim and fill slabs of the urgent chunk until none are left. Returns true if any work was done.
+    bool helpUrgentGeneration() {
+        if (!urgentPending.load()) {
+            return false;
+        }
+        std::shared_ptr<UrgentGenerationJob> job;
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            job = urgentJob;
+        }
+        if (!job) {
+            return false;
+        }
+
+        bool helped = false;
+        int slab;
+        while ((slab = job->nextSlab.fetch_add(1)) < GENERATION_SLAB_COUNT) {
+            if (slab == GENERATION_SLAB_COUNT - 1) {
+                urgentPending.store(false);
+            }
+            int xBegin = slab * GENERATION_SLAB_WIDTH;
+            int xEnd = std::min(CHUNK_SIZE, xBegin + GENERATION_SLAB_WIDTH);
+            chunkManager.generateChunkSdfSlab(*job->chunk, xBegin, xEnd);
+            helped = true;
+
+            // Whoever finishes the last slab publishes the chunk
+            if (job->slabsDone.fetch_add(1) + 1 == GENERATION_SLAB_COUNT) {
+                finishUrgentGeneration(job);
+            }
+        }
+        return helped;
+    }
+
+    void finishUrgentGeneration(const std::shared_ptr<UrgentGenerationJob>& job) {
+        VolumeChunk* chunk = job->chunk;
+        chunkManager.finishChunkSdf(*chunk);
+        chunk->sdfReady.store(true);
+        float latencyMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - job->requestTime).count();
+        chunk->generationMs.store(latencyMs);
+        lastUrgentLatencyMs.store(latencyMs);
+        {
+            std::lock_guard<std::mutex> lock(generationMutex);
+            if (urgentJob == job) {
+                urgentJob.reset();
+            }
+        }
+
+        // Meshing isn't on the collision path, so one thread does it
+        meshIfRenderTier(chunk);
+    }
+
+    // Mesh a chunk whose SDF is ready, unless it is collision-only or its mesh was already built
+    // (an SDF regenerated for collision). Clears generationInProgress either way.
+    void meshIfRenderTier(VolumeChunk* chunk) {
+        if (chunk->renderTier.load() && !chunk->meshBuilt.exchange(true)) {
+            publishChunkMesh(chunk);
+        } else {
+            chunk->generationInProgress.store(false);
+        }
+    }
+
+    void publishChunkMesh(VolumeChunk* chunk) {
+        MeshStats stats;
+        auto start = std::chrono::steady_clock::now();
+        auto vertices = marchingCubes.generateMesh(*chunk, &stats);
+        ChunkProps props;
+        if (!vertices.empty()) {
+            scatterChunkProps(*chunk, props);
+        }
+        if (navigation) {
+            auto graph = std::make_unique<ChunkNavGraph>();
+            buildChunkNavGraph(*chunk, navWorld.getSettings(), *graph);
+            navWorld.submit(std::move(graph));
+        }
+        chunk->meshMs.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completedMeshes.push(PendingMeshUpload{chunk->coord, std::move(vertices), stats, false, std::move(props),
+                                                   countSolidBase(*chunk), {}});
+        }
+
+        chunk->generationInProgress.store(false);
+    }
+
+    // Only needs the coordinate, so the chunk may be unloaded meanwhile; the main thread
+    // drops the mesh if it is, or if the full-resolution mesh got there first.
+    void publishCoarseMesh(ChunkCoord coord) {
+        SdfMipLevel level;
+        chunkManager.getGenerator().generateCoarseChunk(coord, COARSE_STRIDE, level);
+        MeshStats stats;
+        auto vertices = marchingCubes.generateMesh(level, level.origin, level.voxelSize, &stats);
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completedMeshes.push(PendingMeshUpload{coord, std::move(vertices), stats, true, {}, 0, {}});
+    }
+
+    // Call with generationMutex held
+    bool hasUrgentSlabs() const {
+        return urgentJob && urgentJob->nextSlab.load() < GENERATION_SLAB_COUNT;
+    }
+
     void generationWorkerLoop() {
         while (true) {
             VolumeChunk* chunk = nullptr;
+            ChunkCoord coarseCoord{};
+            bool coarse = false;
             {
+                // nextSlab advances outside the lock, so the urgent state is read once, in the
+                // predicate, and the choice below sticks to that snapshot
+                bool urgent = false;
                 std::unique_lock<std::mutex> lock(generationMutex);
-                generationCv.wait(lock, [this]() {
-                    return !generationQueue.empty() || !generationRunning.load();
+                generationCv.wait(lock, [this, &urgent]() {
+                    urgent = hasUrgentSlabs();
+                    return urgent || !coarseQueue.empty() || !generationQueue.empty() ||
+                           !generationRunning.load();
                 });
-                if (!generationRunning.load() && generationQueue.empty()) {
+                if (!generationRunning.load() && generationQueue.empty() && coarseQueue.empty()) {
                     break;
                 }
-                chunk = generationQueue.front();
-                generationQueue.pop();
+                if (!urgent) {
+                    if (!coarseQueue.empty()) {
+                        coarseCoord = coarseQueue.front();
+                        coarseQueue.pop();
+                        coarse = true;
+                    } else if (!generationQueue.empty()) {
+                        chunk = generationQueue.front();
+                        generationQueue.pop();
+                    } else {
+                        continue;
+                    }
+                }
             }
 
+            if (coarse) {
+                publishCoarseMesh(coarseCoord);
+                continue;
+            }
             if (!chunk) {
+                helpUrgentGeneration();
+                continue;
+            }
+
+            // Already generated: a collision-only chunk that joined the render tier only needs
+            // its mesh. Otherwise someone else meshed (or is meshing) it and there is nothing to do.
+            if (chunk->sdfReady.load()) {
+                if (chunk->renderTier.load() && !chunk->meshBuilt.exchange(true)) {
+                    chunk->generationInProgress.store(true);
+                    chunk->generationQueued.store(false);
+                    publishChunkMesh(chunk);
+                } else {
+                    chunk->generationQueued.store(false);
+                }
+                continue;
+            }
+
+            // The urgent lane may have taken this chunk while it sat in the queue
+            if (chunk->sdfClaimed.exchange(true)) {
+                chunk->generationQueued.store(false);
                 continue;
             }
 
             chunk->generationInProgress.store(true);
             chunk->generationQueued.store(false);
-            chunkManager.generateChunkSdf(*chunk);
+            // Includes any urgent slabs this worker helps with in between
+            auto start = std::chrono::steady_clock::now();
+            chunkManager.beginChunkSdf(*chunk);
+            for (int slab = 0; slab < GENERATION_SLAB_COUNT; slab++) {
+                // Urgent work preempts this chunk at slab boundaries
+                helpUrgentGeneration();
+
+                int xBegin = slab * GENERATION_SLAB_WIDTH;
+                int xEnd = std::min(CHUNK_SIZE, xBegin + GENERATION_SLAB_WIDTH);
+                chunkManager.generateChunkSdfSlab(*chunk, xBegin, xEnd);
+            }
+            chunkManager.finishChunkSdf(*chunk);
+            chunk->generationMs.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
             chunk->sdfReady.store(true);
 
-            auto vertices = marchingCubes.generateMesh(*chunk);
-            {
-                std::lock_guard<std::mutex> lock(completedMutex);
-                completedMeshes.push(PendingMeshUpload{chunk->coord, std::move(vertices)});
+            meshIfRenderTier(chunk);
+        }
+    }
+
+    // Collision tier: chunks within collisionRadius keep (or get back) their full SDF, nearest
+    // first, up to the collision budget. Other chunks only need their mesh, so their SDF is
+    // dropped once it is built; heightfields are kept unless the memory governor sheds them.
+    void updateResidencyTiers() {
+        ChunkCoord cameraChunk = worldToChunkCoord(camera.position);
+        int keepRadius = streamRadii().collision;
+        bool dropHeightfields = memoryShedLevel() >= MemoryShedLevel::CompactTiers;
+        std::vector<std::pair<int, VolumeChunk*>> collisionChunks;
+        for (auto& [coord, chunk] : chunkManager.getChunks()) {
+            int dx = coord.x - cameraChunk.x;
+            int dy = coord.y - cameraChunk.y;
+            int dz = coord.z - cameraChunk.z;
+            if (std::max({abs(dx), abs(dy), abs(dz)}) <= keepRadius) {
+                collisionChunks.push_back({dx * dx + dy * dy + dz * dz, chunk.get()});
+            } else {
+                releaseChunkSdf(chunk.get(), dropHeightfields);
+            }
+        }
+        std::sort(collisionChunks.begin(), collisionChunks.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        size_t budgetBytes = static_cast<size_t>(collisionBudgetMb * 1024.0f * 1024.0f);
+        size_t usedBytes = 0;
+        for (const auto& [distSq, chunk] : collisionChunks) {
+            // Chunks being generated may still turn into heightfields; count the worst case
+            usedBytes += chunk->sdfReady.load() && chunk->heightfield ? sizeof(HeightfieldData) : sizeof(ChunkSdfGrid);
+            if (usedBytes > budgetBytes) {
+                releaseChunkSdf(chunk);
+            } else if (!chunk->sdfReady.load() && !chunk->sdfClaimed.load()) {
+                // Released while render-only; meshBuilt keeps the worker from remeshing it
+                enqueueChunkGeneration(chunk);
             }
+        }
+    }
 
-            chunk->generationInProgress.store(false);
+    // Free the full SDF of a chunk once its mesh is built (or it has no use for one). Heightfields
+    // are small and normally kept; under memory pressure they go too.
+    void releaseChunkSdf(VolumeChunk* chunk, bool dropHeightfield = false) {
+        dropHeightfield = dropHeightfield && chunk->heightfield;
+        if (!chunk->sdfReady.load() || (!chunk->sdf && !dropHeightfield) ||
+            chunk->generationQueued.load() || chunk->generationInProgress.load()) {
+            return;
+        }
+        if (chunk->renderTier.load() && !chunk->meshBuilt.load()) {
+            return;
+        }
+        chunk->sdfReady.store(false);
+        chunk->sdfClaimed.store(false);
+        chunk->sdf.reset();
+        if (dropHeightfield) {
+            chunk->heightfield.reset();
+        }
+    }
+
+    // Physics treats missing chunks as air, so the chunk at the player's feet skips the queue
+    void ensureCollisionChunk() {
+        if (camera.noclip) {
+            return;
+        }
+        glm::vec3 feetPos = camera.position - glm::vec3(0, camera.playerHeight * 0.5f, 0);
+        VolumeChunk* chunk = chunkManager.getOrCreateChunk(worldToChunkCoord(feetPos));
+        if (chunk->sdfReady.load()) {
+            return;
+        }
+        if (!requestUrgentGeneration(chunk) && !chunk->sdfClaimed.load()) {
+            // Another urgent chunk is in flight; make sure this one is at least queued
+            enqueueChunkGeneration(chunk);
+        }
+        // The main thread would only be waiting on it anyway
+        helpUrgentGeneration();
+    }
+
+    // Worker results into readyMeshes. A newer mesh of a chunk replaces the one still waiting,
+    // so reordering can't install an older mesh last, and a waiting full mesh beats a coarse one.
+    void drainCompletedMeshes() {
+        std::queue<PendingMeshUpload> arrived;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            std::swap(arrived, completedMeshes);
+        }
+        for (; !arrived.empty(); arrived.pop()) {
+            PendingMeshUpload& job = arrived.front();
+            auto waiting = std::find_if(readyMeshes.begin(), readyMeshes.end(),
+                                        [&](const PendingMeshUpload& ready) { return ready.coord == job.coord; });
+            if (waiting == readyMeshes.end()) {
+                readyMeshes.push_back(std::move(job));
+            } else if (!job.coarse || waiting->coarse) {
+                *waiting = std::move(job);
+            }
+        }
+
+        // Unloaded chunks, and coarse meshes whose full mesh went up meanwhile
+        readyMeshes.erase(std::remove_if(readyMeshes.begin(), readyMeshes.end(), [this](const PendingMeshUpload& job) {
+            VolumeChunk* chunk = chunkManager.getChunk(job.coord);
+            return !chunk || (job.coarse && chunk->fullMeshSubmitted);
+        }), readyMeshes.end());
+    }
+
+    // Grows [boundsMin, boundsMax] over a mesh and its props
+    static void meshBounds(const PendingMeshUpload& job, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        for (const MarchingCubesVertex& vertex : job.vertices) {
+            boundsMin = glm::min(boundsMin, vertex.pos);
+            boundsMax = glm::max(boundsMax, vertex.pos);
+        }
+        const glm::vec3 propReach(PROP_MAX_EXTENT * MAX_PROP_SCALE);
+        for (const PropInstance& prop : job.props.instances) {
+            boundsMin = glm::min(boundsMin, prop.position - propReach);
+            boundsMax = glm::max(boundsMax, prop.position + propReach);
         }
     }
 
-    int processCompletedMeshes(float budgetMs, int maxUploads) {
-        if (budgetMs <= 0.0f || maxUploads <= 0) {
+    static uint64_t meshUploadBytes(const PendingMeshUpload& job) {
+        return sizeof(MarchingCubesVertex) * job.vertices.size() + sizeof(PropInstance) * job.props.instances.size();
+    }
+
+    // Uploads the most urgent ready meshes (in view, near, nothing drawn there yet) that fit this
+    // frame's byte budget and the mesh arena, all in one batch. Returns the number of meshes submitted.
+    int processCompletedMeshes() {
+        drainCompletedMeshes();
+        if (readyMeshes.empty() || uploadSettings.cpuBudgetMs <= 0.0f || uploadSettings.maxUploads <= 0) {
             return 0;
         }
-        auto start = std::chrono::steady_clock::now();
+
+        Frustum frustum = Frustum::fromMatrix(projectionMatrix() * camera.getViewMatrix());
+        std::vector<UploadCandidate> candidates;
+        candidates.reserve(readyMeshes.size());
+        for (uint32_t i = 0; i < readyMeshes.size(); i++) {
+            const PendingMeshUpload& job = readyMeshes[i];
+            const VolumeChunk* chunk = chunkManager.getChunk(job.coord);
+            glm::vec3 boxMin = chunkToWorldPos(job.coord);
+            glm::vec3 boxMax = boxMin + glm::vec3(CHUNK_WORLD_SIZE);
+            candidates.push_back(UploadCandidate{i, meshUploadBytes(job),
+                                                 glm::distance((boxMin + boxMax) * 0.5f, camera.position),
+                                                 frustum.intersectsBox(boxMin, boxMax),
+                                                 chunk->meshUploaded && chunk->vertexCount > 0});
+        }
+        size_t count = selectUploads(candidates, uploadThroughput.frameByteBudget(uploadSettings),
+                                     uploadSettings.maxUploads);
+
+        std::vector<bool> taken(readyMeshes.size(), false);
+        std::vector<PendingMeshUpload> batch;
         int submitted = 0;
-        for (int i = 0; i < maxUploads; ++i) {
-            auto now = std::chrono::steady_clock::now();
-            float elapsedMs = std::chrono::duration<float, std::milli>(now - start).count();
-            if (elapsedMs >= budgetMs) {
-                break;
-            }
-            PendingMeshUpload job;
-            {
-                std::lock_guard<std::mutex> lock(completedMutex);
-                if (completedMeshes.empty()) {
-                    break;
+        for (size_t i = 0; i < count; i++) {
+            PendingMeshUpload& job = readyMeshes[candidates[i].index];
+            if (!job.vertices.empty() && !meshArena.allocate(meshUploadBytes(job), job.range)) {
+                if (!meshArenaFullWarned) {
+                    std::cout << "[arena] No " << meshUploadBytes(job) / 1024 << " KB range free ("
+                              << meshArena.usedBytes() / (1024 * 1024) << " of " << meshArena.capacity() / (1024 * 1024)
+                              << " MB used, largest free " << meshArena.largestFreeRange() / 1024
+                              << " KB); meshes wait for unloads" << std::endl;
+                    meshArenaFullWarned = true;
                 }
-                job = std::move(completedMeshes.front());
-                completedMeshes.pop();
+                continue;
             }
-
+            taken[candidates[i].index] = true;
+            submitted++;
             VolumeChunk* chunk = chunkManager.getChunk(job.coord);
-            if (!chunk) {
-                continue;
+
+            if (job.coarse) {
+                coarseUploadsThisSecond++;
+            } else {
+                chunk->fullMeshSubmitted = true;
+                chunk->trianglesRemoved = job.stats.removed();
+                trianglesKeptThisSecond += job.stats.trianglesEmitted;
+                trianglesRemovedThisSecond += job.stats.removed();
             }
 
-            if (chunk->vertexBuffer != VK_NULL_HANDLE) {
-                vkDestroyBuffer(device, chunk->vertexBuffer, nullptr);
-                vkFreeMemory(device, chunk->vertexBufferMemory, nullptr);
-                chunk->vertexBuffer = VK_NULL_HANDLE;
-                chunk->vertexBufferMemory = VK_NULL_HANDLE;
+            if (!job.coarse && chunk->solidBase != job.solidBase) {
+                chunk->solidBase = job.solidBase;
+                horizonColumnsDirty = true;
+            }
+            if (!job.vertices.empty()) {
+                // A replaced mesh may draw a few frames longer, so grow the bounds until it's gone
+                bool replacing = chunk->meshUploaded && chunk->vertexCount > 0;
+                glm::vec3 boundsMin = replacing ? chunk->drawnMin : glm::vec3(std::numeric_limits<float>::max());
+                glm::vec3 boundsMax = replacing ? chunk->drawnMax : glm::vec3(std::numeric_limits<float>::lowest());
+                meshBounds(job, boundsMin, boundsMax);
+                chunk->drawnMin = boundsMin;
+                chunk->drawnMax = boundsMax;
             }
 
-            uploadChunkMesh(chunk, job.vertices);
-            submitted++;
+            chunk->meshGenerated = true;
+            if (job.vertices.empty()) {
+                installChunkMesh(chunk, ArenaRange{}, 0, {}, job.coarse);
+                chunk->uploadInProgress.store(hasPendingUpload(chunk->coord));
+            } else {
+                batch.push_back(std::move(job));
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < readyMeshes.size(); i++) {
+            if (!taken[i]) {
+                if (kept != i) {
+                    readyMeshes[kept] = std::move(readyMeshes[i]);
+                }
+                kept++;
+            }
+        }
+        readyMeshes.resize(kept);
+
+        if (!batch.empty()) {
+            uploadMeshBatch(batch);
         }
         return submitted;
     }
 
     int processUploadFences() {
         int completed = 0;
-        for (size_t i = 0; i < pendingUploads.size(); ) {
-            PendingUpload& upload = pendingUploads[i];
-            VkResult status = vkGetFenceStatus(device, upload.fence);
+        for (size_t i = 0; i < uploadBatches.size(); ) {
+            UploadBatch& batch = uploadBatches[i];
+            VkResult status = vkGetFenceStatus(device, batch.fence);
             if (status == VK_SUCCESS) {
-                vkFreeCommandBuffers(device, commandPool, 1, &upload.commandBuffer);
-                vkDestroyFence(device, upload.fence, nullptr);
-                vkDestroyBuffer(device, upload.stagingBuffer, nullptr);
-                vkFreeMemory(device, upload.stagingMemory, nullptr);
-
-                VolumeChunk* chunk = chunkManager.getChunk(upload.coord);
-                if (chunk) {
-                    chunk->meshUploaded = true;
-                    chunk->uploadInProgress.store(false);
+                if (batch.timestampPool != VK_NULL_HANDLE) {
+                    uint64_t timestamps[2];
+                    if (vkGetQueryPoolResults(device, batch.timestampPool, 0, 2, sizeof(timestamps), timestamps,
+                                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+                        uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+                        uploadThroughput.addGpuSample(batch.bytes, static_cast<float>(ticks * timestampPeriodNs * 1e-6));
+                    }
                 }
+                destroyUploadBatch(batch);
 
-                pendingUploads[i] = pendingUploads.back();
-                pendingUploads.pop_back();
-                completed++;
+                UploadBatch done = std::move(batch);
+                if (i + 1 != uploadBatches.size()) {
+                    batch = std::move(uploadBatches.back());
+                }
+                uploadBatches.pop_back();
+                for (const PendingUpload& upload : done.uploads) {
+                    installUpload(upload);
+                    completed++;
+                }
             } else {
                 ++i;
             }
@@ -437,31 +1319,107 @@ private:
         return completed;
     }
 
+    // Frees the batch's transfer resources; the destination buffers belong to its uploads
+    void destroyUploadBatch(UploadBatch& batch) {
+        if (batch.commandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(device, commandPool, 1, &batch.commandBuffer);
+        }
+        if (batch.fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, batch.fence, nullptr);
+        }
+        if (batch.timestampPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, batch.timestampPool, nullptr);
+        }
+        if (batch.stagingBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, batch.stagingBuffer, nullptr);
+        }
+        if (batch.stagingMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(device, batch.stagingMemory, nullptr);
+        }
+        batch.commandBuffer = VK_NULL_HANDLE;
+        batch.fence = VK_NULL_HANDLE;
+        batch.timestampPool = VK_NULL_HANDLE;
+        batch.stagingBuffer = VK_NULL_HANDLE;
+        batch.stagingMemory = VK_NULL_HANDLE;
+    }
+
     void flushPendingUploads() {
-        for (PendingUpload& upload : pendingUploads) {
-            if (upload.fence != VK_NULL_HANDLE) {
-                vkWaitForFences(device, 1, &upload.fence, VK_TRUE, UINT64_MAX);
+        for (UploadBatch& batch : uploadBatches) {
+            if (batch.fence != VK_NULL_HANDLE) {
+                vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
             }
-            if (upload.commandBuffer != VK_NULL_HANDLE) {
-                vkFreeCommandBuffers(device, commandPool, 1, &upload.commandBuffer);
-            }
-            if (upload.fence != VK_NULL_HANDLE) {
-                vkDestroyFence(device, upload.fence, nullptr);
-            }
-            if (upload.stagingBuffer != VK_NULL_HANDLE) {
-                vkDestroyBuffer(device, upload.stagingBuffer, nullptr);
+            destroyUploadBatch(batch);
+        }
+        std::vector<UploadBatch> done;
+        std::swap(done, uploadBatches);
+        for (const UploadBatch& batch : done) {
+            for (const PendingUpload& upload : batch.uploads) {
+                installUpload(upload);
             }
-            if (upload.stagingMemory != VK_NULL_HANDLE) {
-                vkFreeMemory(device, upload.stagingMemory, nullptr);
+        }
+    }
+
+    bool hasPendingUpload(ChunkCoord coord) const {
+        for (const UploadBatch& batch : uploadBatches) {
+            for (const PendingUpload& upload : batch.uploads) {
+                if (upload.coord == coord) {
+                    return true;
+                }
             }
+        }
+        return false;
+    }
+
+    size_t pendingUploadCount() const {
+        size_t count = 0;
+        for (const UploadBatch& batch : uploadBatches) {
+            count += batch.uploads.size();
+        }
+        return count;
+    }
 
-            VolumeChunk* chunk = chunkManager.getChunk(upload.coord);
-            if (chunk) {
-                chunk->meshUploaded = true;
-                chunk->uploadInProgress.store(false);
+    // Swaps a finished copy into its chunk. Call after removing its batch from uploadBatches.
+    void installUpload(const PendingUpload& upload) {
+        VolumeChunk* chunk = chunkManager.getChunk(upload.coord);
+        // A coarse copy finishing after the full one would replace the better mesh. No frame
+        // has drawn the range yet, so it can be reused right away.
+        if (!chunk || (upload.coarse && chunk->meshUploaded && !chunk->meshCoarse)) {
+            meshArena.free(upload.range);
+        } else {
+            installChunkMesh(chunk, upload.range, upload.vertexCount, upload.propCounts, upload.coarse);
+        }
+        if (chunk) {
+            chunk->uploadInProgress.store(hasPendingUpload(upload.coord));
+        }
+    }
+
+    void installChunkMesh(VolumeChunk* chunk, ArenaRange range, uint32_t vertexCount,
+                          const std::array<uint32_t, PROP_TYPE_COUNT>& propCounts, bool coarse) {
+        retireMesh(chunk->mesh);
+        chunk->mesh = range;
+        chunk->vertexCount = vertexCount;
+        chunk->propCounts = propCounts;
+        chunk->meshUploaded = true;
+        chunk->meshCoarse = coarse;
+    }
+
+    // The previous frames may still be drawing a replaced mesh, so its range isn't reused yet
+    void retireMesh(ArenaRange range) {
+        if (range.size > 0) {
+            retiredRanges.push_back(RetiredRange{range, renderFrameIndex});
+        }
+    }
+
+    void freeRetiredRanges(bool all) {
+        for (size_t i = 0; i < retiredRanges.size(); ) {
+            if (all || renderFrameIndex > retiredRanges[i].frame + MAX_FRAMES_IN_FLIGHT) {
+                meshArena.free(retiredRanges[i].range);
+                retiredRanges[i] = retiredRanges.back();
+                retiredRanges.pop_back();
+            } else {
+                ++i;
             }
         }
-        pendingUploads.clear();
     }
 
     void createInstance() {
@@ -471,7 +1429,15 @@ private:
         appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName = "No Engine";
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion = VK_API_VERSION_1_0;
+        // 1.2 where the loader has it, so vkCmdDrawIndirectCount can be core (see detectGpuCulling)
+        auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+            vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion"));
+        uint32_t loaderVersion = VK_API_VERSION_1_0;
+        if (enumerateInstanceVersion != nullptr) {
+            enumerateInstanceVersion(&loaderVersion);
+        }
+        instanceApiVersion = loaderVersion >= VK_API_VERSION_1_2 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+        appInfo.apiVersion = instanceApiVersion;
 
         VkInstanceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -524,6 +1490,60 @@ private:
         VkPhysicalDeviceProperties deviceProperties;
         vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
         std::cout << "Selected GPU: " << deviceProperties.deviceName << std::endl;
+
+        detectGpuCulling(deviceProperties);
+    }
+
+    // GPU culling needs vkCmdDrawIndirectCount (core since 1.2, where it is still an optional
+    // feature, or VK_KHR_draw_indirect_count) and firstInstance in indirect draws, which
+    // cull.comp uses for the chunk slot. Anything missing keeps the CPU path.
+    void detectGpuCulling(const VkPhysicalDeviceProperties& deviceProperties) {
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+        bool indirectFeatures = features.multiDrawIndirect && features.drawIndirectFirstInstance;
+
+        drawIndirectCountCore = false;
+        if (instanceApiVersion >= VK_API_VERSION_1_2 && deviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+            VkPhysicalDeviceVulkan12Features features12{};
+            features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &features12;
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+            drawIndirectCountCore = features12.drawIndirectCount == VK_TRUE;
+        }
+        bool drawIndirectCount = drawIndirectCountCore ||
+                                 hasDeviceExtension(physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        gpuCullingSupported = indirectFeatures && drawIndirectCount;
+        maxDrawIndirectCount = deviceProperties.limits.maxDrawIndirectCount;
+
+        // The pyramid is reduced from the depth attachment itself
+        VkFormatProperties depthProperties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, findDepthFormat(), &depthProperties);
+        hiZSupported = gpuCullingSupported &&
+                       (depthProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+
+        if (!gpuCullingSupported) {
+            std::cout << "[cull] GPU culling unavailable (" << (drawIndirectCount ? "no multiDrawIndirect/drawIndirectFirstInstance"
+                                                                                 : "no vkCmdDrawIndirectCount")
+                      << "); chunks are culled on the CPU" << std::endl;
+        } else {
+            std::cout << "[cull] GPU culling via " << (drawIndirectCountCore ? "Vulkan 1.2" : VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)
+                      << (hiZSupported ? ", Hi-Z occlusion" : ", depth not sampleable: frustum only") << std::endl;
+        }
+    }
+
+    bool hasDeviceExtension(VkPhysicalDevice device, const char* name) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+        for (const auto& extension : availableExtensions) {
+            if (strcmp(extension.extensionName, name) == 0) {
+                return true;
+            }
+        }
+        return false;
     }
 
     bool isDeviceSuitable(VkPhysicalDevice device) {
@@ -626,6 +1646,8 @@ private:
         }
 
         VkPhysicalDeviceFeatures deviceFeatures{};
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -634,6 +1656,16 @@ private:
         createInfo.pEnabledFeatures = &deviceFeatures;
 
         std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        if (gpuCullingSupported) {
+            deviceFeatures.multiDrawIndirect = VK_TRUE;
+            deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+            if (drawIndirectCountCore) {
+                features12.drawIndirectCount = VK_TRUE;
+                createInfo.pNext = &features12;
+            } else {
+                deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            }
+        }
         createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = deviceExtensions.data();
         createInfo.enabledLayerCount = 0;
@@ -645,6 +1677,16 @@ private:
         vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
         vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
 
+        if (gpuCullingSupported) {
+            drawIndirectCountProc = reinterpret_cast<PFN_vkCmdDrawIndirectCount>(
+                vkGetDeviceProcAddr(device, drawIndirectCountCore ? "vkCmdDrawIndirectCount" : "vkCmdDrawIndirectCountKHR"));
+            if (drawIndirectCountProc == nullptr) {
+                std::cout << "[cull] vkCmdDrawIndirectCount not found; chunks are culled on the CPU" << std::endl;
+                gpuCullingSupported = false;
+                hiZSupported = false;
+            }
+        }
+
         std::cout << "Logical device created!" << std::endl;
     }
 
@@ -806,7 +1848,8 @@ private:
         depthAttachment.format = findDepthFormat();
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        // Kept when the Hi-Z pyramid is reduced from it after the pass
+        depthAttachment.storeOp = hiZSupported ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1016,12 +2059,203 @@ private:
             throw std::runtime_error("Failed to create graphics pipeline!");
         }
 
+        // Streaming overlay: same shaders and vertex format as lines, drawn over the terrain
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        depthStencil.depthTestEnable = VK_FALSE;
+        depthStencil.depthWriteEnable = VK_FALSE;
+        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &debugLinePipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create debug line pipeline!");
+        }
+
+        // Props: terrain state and fragment shader, prop mesh per vertex plus PropInstance per instance
+        auto propShaderCode = readFile("build/shaders/prop.vert.spv");
+        VkShaderModule propShaderModule = createShaderModule(propShaderCode);
+        shaderStages[0].module = propShaderModule;
+
+        // The shader decodes PropInstance::scale with the same MAX_PROP_SCALE the scatterer encodes with
+        VkSpecializationMapEntry propScaleEntry{0, 0, sizeof(MAX_PROP_SCALE)};
+        VkSpecializationInfo propSpecialization{1, &propScaleEntry, sizeof(MAX_PROP_SCALE), &MAX_PROP_SCALE};
+        shaderStages[0].pSpecializationInfo = &propSpecialization;
+
+        VkVertexInputBindingDescription propBindings[2] = {bindingDescription, {}};
+        propBindings[1].binding = 1;
+        propBindings[1].stride = sizeof(PropInstance);
+        propBindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        VkVertexInputAttributeDescription propAttributes[4] = {attributeDescriptions[0], attributeDescriptions[1], {}, {}};
+        propAttributes[2].binding = 1;
+        propAttributes[2].location = 2;
+        propAttributes[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+        propAttributes[2].offset = offsetof(PropInstance, position);
+        propAttributes[3].binding = 1;
+        propAttributes[3].location = 3;
+        propAttributes[3].format = VK_FORMAT_R16G16_UNORM;
+        propAttributes[3].offset = offsetof(PropInstance, yaw);
+
+        vertexInputInfo.vertexBindingDescriptionCount = 2;
+        vertexInputInfo.pVertexBindingDescriptions = propBindings;
+        vertexInputInfo.vertexAttributeDescriptionCount = 4;
+        vertexInputInfo.pVertexAttributeDescriptions = propAttributes;
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &propPipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create prop pipeline!");
+        }
+        shaderStages[0].pSpecializationInfo = nullptr;
+
+        vkDestroyShaderModule(device, propShaderModule, nullptr);
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
         vkDestroyShaderModule(device, vertShaderModule, nullptr);
 
         std::cout << "Graphics pipeline created!" << std::endl;
     }
 
+    // Depth-tested, write-nothing pipeline for occlusion boxes, plus the query pools
+    void createOcclusionResources() {
+        auto vertShaderCode = readFile("build/shaders/bbox.vert.spv");
+        auto fragShaderCode = readFile("build/shaders/bbox.frag.spv");
+
+        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+
+        VkPipelineShaderStageCreateInfo shaderStages[2]{};
+        shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        shaderStages[0].module = vertShaderModule;
+        shaderStages[0].pName = "main";
+        shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStages[1].module = fragShaderModule;
+        shaderStages[1].pName = "main";
+
+        // Box corners come from gl_VertexIndex
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkPipelineViewportStateCreateInfo viewportState{};
+        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        std::vector<VkDynamicState> dynamicStates = {
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+        };
+
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        VkPipelineRasterizationStateCreateInfo rasterizer{};
+        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterizer.lineWidth = 1.0f;
+        rasterizer.cullMode = VK_CULL_MODE_NONE;  // Far faces still count when the camera is close
+        rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+        VkPipelineMultisampleStateCreateInfo multisampling{};
+        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        // Test against the terrain drawn so far, never write
+        VkPipelineDepthStencilStateCreateInfo depthStencil{};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_FALSE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = 0;
+        colorBlendAttachment.blendEnable = VK_FALSE;
+
+        VkPipelineColorBlendStateCreateInfo colorBlending{};
+        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlending.attachmentCount = 1;
+        colorBlending.pAttachments = &colorBlendAttachment;
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(BoxPushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &bboxPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bounding box pipeline layout!");
+        }
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = shaderStages;
+        pipelineInfo.pVertexInputState = &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = bboxPipelineLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+
+        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &bboxPipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bounding box pipeline!");
+        }
+
+        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+        // Binary occlusion queries (any sample passed) need no optional device features
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+            queryPoolInfo.queryCount = MAX_OCCLUSION_QUERIES;
+            if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &occlusionQueryPools[i]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create occlusion query pool!");
+            }
+        }
+
+        // Timestamps are optional; without them the overhead is reported as query counts only
+        QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        uint32_t validBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+        if (validBits > 0) {
+            timestampPeriodNs = deviceProperties.limits.timestampPeriod;
+            timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                VkQueryPoolCreateInfo queryPoolInfo{};
+                queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                queryPoolInfo.queryCount = 3;
+                if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &timestampQueryPools[i]) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create timestamp query pool!");
+                }
+            }
+        }
+
+        std::cout << "Occlusion culling resources created!" << std::endl;
+    }
+
     void createFramebuffers() {
         swapChainFramebuffers.resize(swapChainImageViews.size());
 
@@ -1049,14 +2283,15 @@ private:
     }
 
     void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
-                     VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+                     VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+                     uint32_t mipLevels = 1) {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
         imageInfo.extent.width = width;
         imageInfo.extent.height = height;
         imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
+        imageInfo.mipLevels = mipLevels;
         imageInfo.arrayLayers = 1;
         imageInfo.format = format;
         imageInfo.tiling = tiling;
@@ -1084,15 +2319,16 @@ private:
         vkBindImageMemory(device, image, imageMemory, 0);
     }
 
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+                                uint32_t baseMipLevel = 0, uint32_t levelCount = 1) {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = image;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
         viewInfo.format = format;
         viewInfo.subresourceRange.aspectMask = aspectFlags;
-        viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+        viewInfo.subresourceRange.levelCount = levelCount;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -1107,8 +2343,12 @@ private:
     void createDepthResources() {
         VkFormat depthFormat = findDepthFormat();
 
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (hiZSupported) {
+            usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
         createImage(swapChainExtent.width, swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                     depthImage, depthImageMemory);
         depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 
@@ -1140,6 +2380,37 @@ private:
         std::cout << "Vertex buffer created!" << std::endl;
     }
 
+    void createPropMeshBuffer() {
+        propMeshes = buildPropMeshes();
+        VkDeviceSize bufferSize = sizeof(MarchingCubesVertex) * propMeshes.vertices.size();
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagingBuffer, stagingBufferMemory);
+
+        void* data;
+        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, propMeshes.vertices.data(), (size_t) bufferSize);
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, propMeshBuffer, propMeshBufferMemory);
+
+        copyBuffer(stagingBuffer, propMeshBuffer, bufferSize);
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    }
+
+    void createMeshArena() {
+        createBuffer(MESH_ARENA_BYTES, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, meshArenaBuffer, meshArenaMemory);
+        meshArena.reset(MESH_ARENA_BYTES, sizeof(MarchingCubesVertex));
+        std::cout << "Mesh arena created (" << MESH_ARENA_BYTES / (1024 * 1024) << " MB)!" << std::endl;
+    }
+
     void createIndexBuffer() {
         VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
@@ -1165,83 +2436,98 @@ private:
         std::cout << "Index buffer created!" << std::endl;
     }
 
-    void uploadChunkMesh(VolumeChunk* chunk, const std::vector<MarchingCubesVertex>& vertices) {
-        if (vertices.empty()) {
-            chunk->vertexCount = 0;
-            chunk->meshGenerated = true;
-            chunk->meshUploaded = true;
-            chunk->uploadInProgress.store(false);
-            return;
+    // One staging buffer for every mesh in the batch (vertices, then prop instances, per chunk),
+    // one command buffer and one fence. Each mesh is copied to the arena range it was given.
+    void uploadMeshBatch(const std::vector<PendingMeshUpload>& jobs) {
+        auto start = std::chrono::steady_clock::now();
+        UploadBatch batch;
+        for (const PendingMeshUpload& job : jobs) {
+            batch.bytes += meshUploadBytes(job);
         }
 
-        // Create vertex buffer for this chunk
-        VkDeviceSize bufferSize = sizeof(MarchingCubesVertex) * vertices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        createBuffer(batch.bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     stagingBuffer, stagingBufferMemory);
+                     batch.stagingBuffer, batch.stagingMemory);
 
         void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), (size_t) bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        VkBuffer chunkVertexBuffer;
-        VkDeviceMemory chunkVertexBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, chunkVertexBuffer, chunkVertexBufferMemory);
+        vkMapMemory(device, batch.stagingMemory, 0, batch.bytes, 0, &data);
+        VkDeviceSize offset = 0;
+        for (const PendingMeshUpload& job : jobs) {
+            size_t vertexBytes = sizeof(MarchingCubesVertex) * job.vertices.size();
+            size_t instanceBytes = sizeof(PropInstance) * job.props.instances.size();
+            memcpy(static_cast<char*>(data) + offset, job.vertices.data(), vertexBytes);
+            if (instanceBytes > 0) {
+                memcpy(static_cast<char*>(data) + offset + vertexBytes, job.props.instances.data(), instanceBytes);
+            }
+            offset += vertexBytes + instanceBytes;
+        }
+        vkUnmapMemory(device, batch.stagingMemory);
 
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
         allocInfo.commandPool = commandPool;
         allocInfo.commandBufferCount = 1;
+        vkAllocateCommandBuffers(device, &allocInfo, &batch.commandBuffer);
 
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+
+        // GPU copy time feeds the byte budget
+        if (timestampPeriodNs > 0.0f) {
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = 2;
+            if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &batch.timestampPool) == VK_SUCCESS) {
+                vkCmdResetQueryPool(batch.commandBuffer, batch.timestampPool, 0, 2);
+                vkCmdWriteTimestamp(batch.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.timestampPool, 0);
+            } else {
+                batch.timestampPool = VK_NULL_HANDLE;
+            }
+        }
 
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        offset = 0;
+        for (const PendingMeshUpload& job : jobs) {
+            VkDeviceSize size = meshUploadBytes(job);
+            PendingUpload upload;
+            upload.coord = job.coord;
+            upload.vertexCount = static_cast<uint32_t>(job.vertices.size());
+            upload.coarse = job.coarse;
+            upload.propCounts = job.props.counts;
+            upload.range = job.range;
 
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = offset;
+            copyRegion.dstOffset = job.range.offset;
+            copyRegion.size = size;
+            vkCmdCopyBuffer(batch.commandBuffer, batch.stagingBuffer, meshArenaBuffer, 1, &copyRegion);
+            offset += size;
 
-        VkBufferCopy copyRegion{};
-        copyRegion.size = bufferSize;
-        vkCmdCopyBuffer(commandBuffer, stagingBuffer, chunkVertexBuffer, 1, &copyRegion);
+            chunkManager.getChunk(job.coord)->uploadInProgress.store(true);
+            batch.uploads.push_back(upload);
+        }
 
-        vkEndCommandBuffer(commandBuffer);
+        if (batch.timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, batch.timestampPool, 1);
+        }
+        vkEndCommandBuffer(batch.commandBuffer);
 
         VkFenceCreateInfo fenceInfo{};
         fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-
-        VkFence fence = VK_NULL_HANDLE;
-        vkCreateFence(device, &fenceInfo, nullptr, &fence);
+        vkCreateFence(device, &fenceInfo, nullptr, &batch.fence);
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.pCommandBuffers = &batch.commandBuffer;
+        vkQueueSubmit(graphicsQueue, 1, &submitInfo, batch.fence);
 
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
-
-        // Store in chunk
-        chunk->vertexBuffer = chunkVertexBuffer;
-        chunk->vertexBufferMemory = chunkVertexBufferMemory;
-        chunk->vertexCount = static_cast<uint32_t>(vertices.size());
-        chunk->meshGenerated = true;
-        chunk->meshUploaded = false;
-        chunk->uploadInProgress.store(true);
-
-        pendingUploads.push_back(PendingUpload{
-            chunk->coord,
-            stagingBuffer,
-            stagingBufferMemory,
-            fence,
-            commandBuffer
-        });
+        uploadThroughput.addCpuSample(batch.bytes,
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        uploadBatches.push_back(std::move(batch));
     }
 
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
@@ -1350,6 +2636,514 @@ private:
         std::cout << "Uniform buffers created!" << std::endl;
     }
 
+    void createDebugOverlayResources() {
+        VkDeviceSize bufferSize = sizeof(MarchingCubesVertex) * MAX_DEBUG_LINE_VERTICES;
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         debugLineBuffers[i], debugLineBuffersMemory[i]);
+            vkMapMemory(device, debugLineBuffersMemory[i], 0, bufferSize, 0, &debugLineBuffersMapped[i]);
+        }
+    }
+
+    bool useGpuCulling() const {
+        return gpuCullingSupported && gpuCulling && chunkManager.getChunks().size() <= maxDrawIndirectCount;
+    }
+
+    // Pipelines, per-frame buffers and descriptor sets of the GPU cull, and the Hi-Z pyramid
+    void createGpuCullingResources() {
+        if (!gpuCullingSupported) {
+            return;
+        }
+
+        auto createSetLayout = [this](const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+            VkDescriptorSetLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+            layoutInfo.pBindings = bindings.data();
+            VkDescriptorSetLayout layout;
+            if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create culling descriptor set layout!");
+            }
+            return layout;
+        };
+        const VkShaderStageFlags compute = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullSetLayout = createSetLayout({
+            {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, compute, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, compute, nullptr},
+            {4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, compute, nullptr},
+        });
+        reduceSetLayout = createSetLayout({
+            {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, compute, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, compute, nullptr},
+        });
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &cullSetLayout;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create culling pipeline layout!");
+        }
+        VkPushConstantRange reducePushConstants{compute, 0, sizeof(HiZReducePushConstants)};
+        pipelineLayoutInfo.pSetLayouts = &reduceSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &reducePushConstants;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &reducePipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create Hi-Z pipeline layout!");
+        }
+        cullPipeline = createComputePipeline("build/shaders/cull.comp.spv", cullPipelineLayout);
+        reducePipeline = createComputePipeline("build/shaders/hiz_reduce.comp.spv", reducePipelineLayout);
+
+        std::array<VkDescriptorPoolSize, 4> poolSizes{{
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_FRAMES_IN_FLIGHT},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * MAX_FRAMES_IN_FLIGHT},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_FRAMES_IN_FLIGHT + MAX_HIZ_LEVELS},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_HIZ_LEVELS},
+        }};
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT + MAX_HIZ_LEVELS;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &cullDescriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create culling descriptor pool!");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, cullSetLayout);
+        layouts.insert(layouts.end(), MAX_HIZ_LEVELS, reduceSetLayout);
+        std::vector<VkDescriptorSet> sets(layouts.size());
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = cullDescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate culling descriptor sets!");
+        }
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            cullFrames[i].descriptorSet = sets[i];
+        }
+        std::copy(sets.begin() + MAX_FRAMES_IN_FLIGHT, sets.end(), reduceSets.begin());
+
+        // Only texelFetch reads through it
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &hiZSampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create Hi-Z sampler!");
+        }
+
+        for (GpuCullFrame& cull : cullFrames) {
+            createBuffer(sizeof(GpuCullParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         cull.paramsBuffer, cull.paramsMemory);
+            vkMapMemory(device, cull.paramsMemory, 0, sizeof(GpuCullParams), 0, &cull.paramsMapped);
+            createBuffer(sizeof(uint32_t),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         cull.countBuffer, cull.countMemory);
+            vkMapMemory(device, cull.countMemory, 0, sizeof(uint32_t), 0, &cull.countMapped);
+            reserveCullRecords(cull, 1024);
+        }
+        createHiZPyramid();
+
+        std::cout << "GPU culling resources created!" << std::endl;
+    }
+
+    VkPipeline createComputePipeline(const std::string& path, VkPipelineLayout layout) {
+        VkShaderModule shaderModule = createShaderModule(readFile(path));
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = layout;
+
+        VkPipeline pipeline;
+        if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute pipeline: " + path);
+        }
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+        return pipeline;
+    }
+
+    static VkWriteDescriptorSet descriptorWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type,
+                                                const VkDescriptorBufferInfo* bufferInfo,
+                                                const VkDescriptorImageInfo* imageInfo) {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = binding;
+        write.descriptorCount = 1;
+        write.descriptorType = type;
+        write.pBufferInfo = bufferInfo;
+        write.pImageInfo = imageInfo;
+        return write;
+    }
+
+    // Grows a frame slot's chunk and draw buffers to hold `count` records (doubling, so chunk
+    // loads don't reallocate every frame). Only called while the slot's fence is signalled.
+    void reserveCullRecords(GpuCullFrame& cull, uint32_t count) {
+        if (count <= cull.capacity) {
+            return;
+        }
+        uint32_t capacity = std::max(cull.capacity, 1u);
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        if (cull.chunkBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, cull.chunkBuffer, nullptr);
+            vkFreeMemory(device, cull.chunkMemory, nullptr);
+            vkDestroyBuffer(device, cull.drawBuffer, nullptr);
+            vkFreeMemory(device, cull.drawMemory, nullptr);
+        }
+        cull.capacity = capacity;
+        createBuffer(sizeof(GpuCullChunk) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     cull.chunkBuffer, cull.chunkMemory);
+        vkMapMemory(device, cull.chunkMemory, 0, sizeof(GpuCullChunk) * capacity, 0, &cull.chunkMapped);
+        createBuffer(sizeof(VkDrawIndirectCommand) * capacity,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, cull.drawBuffer, cull.drawMemory);
+
+        VkDescriptorBufferInfo params{cull.paramsBuffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo records{cull.chunkBuffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo draws{cull.drawBuffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo drawCount{cull.countBuffer, 0, VK_WHOLE_SIZE};
+        std::array<VkWriteDescriptorSet, 4> writes = {
+            descriptorWrite(cull.descriptorSet, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &params, nullptr),
+            descriptorWrite(cull.descriptorSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &records, nullptr),
+            descriptorWrite(cull.descriptorSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &draws, nullptr),
+            descriptorWrite(cull.descriptorSet, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &drawCount, nullptr),
+        };
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    // Sized like the swapchain, so it's rebuilt with it. It stays in GENERAL: every level is both
+    // written (storage) and read (sampled). Without a sampleable depth format it is never built,
+    // but cull.comp's binding still needs an image.
+    void createHiZPyramid() {
+        glm::ivec2 size(static_cast<int>(swapChainExtent.width), static_cast<int>(swapChainExtent.height));
+        hiZLevels = std::min(hiZLevelCount(size), MAX_HIZ_LEVELS);
+        hiZValid = false;
+        // Layout transitions of a depth/stencil image have to name both aspects
+        hiZDepthAspect = findDepthFormat() == VK_FORMAT_D32_SFLOAT
+            ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+        createImage(swapChainExtent.width, swapChainExtent.height, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    hiZImage, hiZImageMemory, hiZLevels);
+        hiZView = createImageView(hiZImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, hiZLevels);
+        for (uint32_t level = 0; level < hiZLevels; level++) {
+            hiZLevelViews.push_back(createImageView(hiZImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1));
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        VkCommandBuffer commandBuffer;
+        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        VkImageMemoryBarrier barrier = imageBarrier(hiZImage, VK_IMAGE_ASPECT_COLOR_BIT, hiZLevels,
+                                                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                                    0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(graphicsQueue);
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+
+        std::vector<VkDescriptorImageInfo> images;
+        images.reserve(1 + 2 * hiZLevels);  // Writes point into it
+        std::vector<VkWriteDescriptorSet> writes;
+        images.push_back({hiZSampler, hiZView, VK_IMAGE_LAYOUT_GENERAL});
+        for (const GpuCullFrame& cull : cullFrames) {
+            writes.push_back(descriptorWrite(cull.descriptorSet, 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                             nullptr, &images.back()));
+        }
+        if (hiZSupported) {
+            for (uint32_t level = 0; level < hiZLevels; level++) {
+                if (level == 0) {
+                    images.push_back({hiZSampler, depthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL});
+                } else {
+                    images.push_back({hiZSampler, hiZLevelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL});
+                }
+                writes.push_back(descriptorWrite(reduceSets[level], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                 nullptr, &images.back()));
+                images.push_back({VK_NULL_HANDLE, hiZLevelViews[level], VK_IMAGE_LAYOUT_GENERAL});
+                writes.push_back(descriptorWrite(reduceSets[level], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                                 nullptr, &images.back()));
+            }
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void destroyHiZPyramid() {
+        for (VkImageView view : hiZLevelViews) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+        hiZLevelViews.clear();
+        vkDestroyImageView(device, hiZView, nullptr);
+        vkDestroyImage(device, hiZImage, nullptr);
+        vkFreeMemory(device, hiZImageMemory, nullptr);
+        hiZView = VK_NULL_HANDLE;
+        hiZImage = VK_NULL_HANDLE;
+        hiZImageMemory = VK_NULL_HANDLE;
+    }
+
+    void destroyGpuCullingResources() {
+        if (!gpuCullingSupported) {
+            return;
+        }
+        for (GpuCullFrame& cull : cullFrames) {
+            vkDestroyBuffer(device, cull.paramsBuffer, nullptr);
+            vkFreeMemory(device, cull.paramsMemory, nullptr);
+            vkDestroyBuffer(device, cull.countBuffer, nullptr);
+            vkFreeMemory(device, cull.countMemory, nullptr);
+            vkDestroyBuffer(device, cull.chunkBuffer, nullptr);
+            vkFreeMemory(device, cull.chunkMemory, nullptr);
+            vkDestroyBuffer(device, cull.drawBuffer, nullptr);
+            vkFreeMemory(device, cull.drawMemory, nullptr);
+        }
+        vkDestroySampler(device, hiZSampler, nullptr);
+        vkDestroyDescriptorPool(device, cullDescriptorPool, nullptr);
+        vkDestroyPipeline(device, cullPipeline, nullptr);
+        vkDestroyPipeline(device, reducePipeline, nullptr);
+        vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+        vkDestroyPipelineLayout(device, reducePipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, cullSetLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, reduceSetLayout, nullptr);
+    }
+
+    static VkImageMemoryBarrier imageBarrier(VkImage image, VkImageAspectFlags aspect, uint32_t levels,
+                                             VkImageLayout oldLayout, VkImageLayout newLayout,
+                                             VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = aspect;
+        barrier.subresourceRange.levelCount = levels;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        return barrier;
+    }
+
+    static void memoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                              VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    // cull.comp over this slot's records (written by planGpuCull); outside the render pass
+    void recordGpuCull(VkCommandBuffer commandBuffer) {
+        GpuCullFrame& cull = cullFrames[currentFrame];
+        vkCmdFillBuffer(commandBuffer, cull.countBuffer, 0, VK_WHOLE_SIZE, 0);
+        // Also orders last frame's Hi-Z reduce before the pyramid is read
+        memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        if (cull.chunkCount > 0) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1,
+                                    &cull.descriptorSet, 0, nullptr);
+            vkCmdDispatch(commandBuffer, (cull.chunkCount + 63) / 64, 1, 1);
+        }
+        // The count is also read back for the stats once the frame's fence has signalled
+        memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT);
+    }
+
+    // This frame's depth reduced into the Hi-Z pyramid for next frame's cull. The depth goes back
+    // to attachment layout afterwards, so the next render pass waits for the reads.
+    void recordHiZPyramid(VkCommandBuffer commandBuffer) {
+        VkImageMemoryBarrier toRead = imageBarrier(depthImage, hiZDepthAspect, 1,
+                                                   VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                                   VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        // This frame's cull has read the pyramid that is about to be overwritten
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toRead);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline);
+        glm::ivec2 srcSize(static_cast<int>(swapChainExtent.width), static_cast<int>(swapChainExtent.height));
+        for (uint32_t level = 0; level < hiZLevels; level++) {
+            glm::ivec2 dstSize = glm::max(srcSize >> static_cast<int>(level), glm::ivec2(1));
+            HiZReducePushConstants reduce{level == 0 ? dstSize : glm::max(srcSize >> static_cast<int>(level - 1), glm::ivec2(1)),
+                                          dstSize, level == 0 ? 0u : 1u};
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipelineLayout, 0, 1,
+                                    &reduceSets[level], 0, nullptr);
+            vkCmdPushConstants(commandBuffer, reducePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(reduce), &reduce);
+            vkCmdDispatch(commandBuffer, (dstSize.x + 7) / 8, (dstSize.y + 7) / 8, 1);
+            memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+
+        VkImageMemoryBarrier toAttachment = imageBarrier(depthImage, hiZDepthAspect, 1,
+                                                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                                                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 0,
+                                                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toAttachment);
+
+        hiZViewProj = projectionMatrix() * camera.getViewMatrix();
+        hiZValid = true;
+    }
+
+    MemoryShedLevel memoryShedLevel() const {
+        return memoryGovernorEnabled ? memoryGovernor.getLevel() : MemoryShedLevel::None;
+    }
+
+    // Tuned radii, cut back by the memory governor's shed level
+    StreamRadii streamRadii() const {
+        StreamRadii radii{loadRadius, unloadRadius, collisionRadius};
+        MemoryShedLevel shed = memoryShedLevel();
+        if (shed >= MemoryShedLevel::LoadRadius) {
+            radii.load = std::max(1, radii.load - 1);
+        }
+        if (shed >= MemoryShedLevel::ChunkCache) {
+            radii.unload = std::min(radii.unload, radii.load + 1);
+        }
+        if (shed >= MemoryShedLevel::CollisionSdf) {
+            radii.collision = 0;
+        }
+        radii.collision = std::min(radii.collision, radii.unload - 1);
+        return radii;
+    }
+
+    void updateMemoryGovernor() {
+        if (!memoryGovernorEnabled) {
+            return;
+        }
+        MemoryShedLevel before = memoryGovernor.getLevel();
+        MemoryShedLevel after = memoryGovernor.update(memorySettings);
+        if (after != before) {
+            std::cout << "[memory] " << (after > before ? "Shedding up to " : "Relaxed to ")
+                      << memoryShedLevelName(after) << ": " << memoryGovernor.describe() << std::endl;
+        }
+    }
+
+    // Closes the Vulkan counters of the frame just drawn
+    void countVulkanFrame() {
+        VkFrameCounters frame = takeVkFrameCounters();
+        vkThisSecond.add(frame);
+        vkReportFrames++;
+        if (vkTrace && (frame.totalCreated() > 0 || frame.totalDestroyed() > 0)) {
+            std::cout << "[vulkan] Frame " << renderFrameIndex << ": " << frame.calls << " calls";
+            printObjectChurn(frame);
+            std::cout << std::endl;
+        }
+    }
+
+    // " +created/-destroyed" per object kind that changed
+    static void printObjectChurn(const VkFrameCounters& counters) {
+        for (size_t kind = 1; kind < VK_OBJECT_KIND_COUNT; kind++) {
+            if (counters.created[kind] > 0 || counters.destroyed[kind] > 0) {
+                std::cout << ", " << vkObjectKindName(static_cast<VkObjectKind>(kind)) << " +"
+                          << counters.created[kind] << "/-" << counters.destroyed[kind];
+            }
+        }
+    }
+
+    // Stats line: calls and driver time per frame, with fence, acquire, present and idle waits
+    // shown separately, and objects made and freed over the second.
+    // Steady-state object churn here means something allocates per chunk or per frame.
+    void printVulkanChurn(uint32_t frames) {
+        std::cout << " | VK/frame: " << vkThisSecond.calls / std::max(frames, 1u) << " calls, "
+                  << vkThisSecond.ms / std::max(frames, 1u) << " ms (+"
+                  << vkThisSecond.waitMs / std::max(frames, 1u) << " ms waiting)";
+        if (vkThisSecond.totalCreated() > 0 || vkThisSecond.totalDestroyed() > 0) {
+            std::cout << " | VK objects/s";
+            printObjectChurn(vkThisSecond);
+        }
+        vkThisSecond = VkFrameCounters{};
+    }
+
+    void printNavigationReport() {
+        std::cout << "\n=== Navigation ===" << std::endl;
+        std::cout << "Chunks: " << navWorld.chunkCount() << " | Nodes: " << navWorld.nodeCount()
+                  << " | Border links: " << navWorld.linkCount() << std::endl;
+
+        glm::vec3 feet = camera.position - glm::vec3(0, camera.playerHeight * 0.5f, 0);
+        glm::vec3 forward = camera.getForward();
+        forward.y = 0.0f;
+        forward = glm::length(forward) > 0.001f ? glm::normalize(forward) : glm::vec3(0, 0, -1);
+        glm::vec3 goal = feet + forward * 30.0f;
+
+        std::vector<glm::vec3> path;
+        NavPathStats stats;
+        auto start = std::chrono::steady_clock::now();
+        bool found = navWorld.findPath(feet, goal, path, &stats);
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (found) {
+            float length = 0.0f;
+            for (size_t i = 1; i < path.size(); i++) {
+                length += glm::distance(path[i - 1], path[i]);
+            }
+            std::cout << "Path 30 m ahead: " << path.size() << " nodes, " << length << " m, ";
+        } else {
+            std::cout << "No path 30 m ahead, ";
+        }
+        std::cout << ms << " ms (" << stats.regionsExpanded << " regions, " << stats.nodesExpanded
+                  << " nodes expanded)" << std::endl;
+        std::cout << "==================\n" << std::endl;
+    }
+
+    // Chunk boxes and streaming boundaries on top of the terrain, if enabled
+    void recordStreamOverlay(VkCommandBuffer commandBuffer) {
+        auto mode = static_cast<StreamOverlayMode>(streamOverlay);
+        if (mode == StreamOverlayMode::Off) {
+            return;
+        }
+        buildStreamOverlay(chunkManager, worldToChunkCoord(camera.position), streamRadii(), mode,
+                           MAX_DEBUG_LINE_VERTICES, debugLines);
+        if (debugLines.empty()) {
+            return;
+        }
+        memcpy(debugLineBuffersMapped[currentFrame], debugLines.data(), debugLines.size() * sizeof(MarchingCubesVertex));
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, debugLinePipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+        VkBuffer vertexBuffers[] = {debugLineBuffers[currentFrame]};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdDraw(commandBuffer, static_cast<uint32_t>(debugLines.size()), 1, 0, 0);
+    }
+
     void createDescriptorPool() {
         VkDescriptorPoolSize poolSize{};
         poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -1449,6 +3243,28 @@ private:
             throw std::runtime_error("Failed to begin recording command buffer!");
         }
 
+        bool gpuCull = useGpuCulling();
+        std::vector<ChunkDraw> draws;
+        std::vector<const VolumeChunk*> boxQueries;
+        uint32_t queryCount = planChunkDraws(draws, boxQueries);
+
+        // Queries must be reset outside the render pass before they are reused
+        if (queryCount > 0) {
+            vkCmdResetQueryPool(commandBuffer, occlusionQueryPools[currentFrame], 0, queryCount);
+        }
+        VkQueryPool timestampPool = timestampQueryPools[currentFrame];
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, timestampPool, 0, 3);
+        }
+
+        // The cull pass runs before the render pass, so "draw" GPU time includes it
+        if (gpuCull) {
+            if (timestampPool != VK_NULL_HANDLE) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+            }
+            recordGpuCull(commandBuffer);
+        }
+
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassInfo.renderPass = renderPass;
@@ -1483,35 +3299,323 @@ private:
         // Bind descriptor sets (uniforms)
         vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
 
-        // Draw all chunks
-        VkDeviceSize offsets[] = {0};
-        for (const auto& [coord, chunk] : chunkManager.getChunks()) {
-            if (chunk->meshUploaded && chunk->vertexCount > 0 && chunk->vertexBuffer != VK_NULL_HANDLE) {
-                VkBuffer vertexBuffers[] = {chunk->vertexBuffer};
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-                vkCmdDraw(commandBuffer, chunk->vertexCount, 1, 0, 0);
+        if (!gpuCull && timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+        }
+
+        VkDeviceSize arenaOffset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &meshArenaBuffer, &arenaOffset);
+        VkQueryPool queryPool = occlusionQueryPools[currentFrame];
+        std::vector<ChunkCoord>& queryChunks = occlusionQueryChunks[currentFrame];
+        if (gpuCull) {
+            // Whatever cull.comp kept; `draws` only lists the chunks whose props to draw
+            GpuCullFrame& cull = cullFrames[currentFrame];
+            cmdDrawIndirectCount(commandBuffer, cull.drawBuffer, 0, cull.countBuffer, 0, cull.chunkCount,
+                                 sizeof(VkDrawIndirectCommand));
+        } else {
+            // Draw chunks that passed culling; some of them inside occlusion queries
+            for (const ChunkDraw& draw : draws) {
+                uint32_t firstVertex = static_cast<uint32_t>(draw.chunk->mesh.offset / sizeof(MarchingCubesVertex));
+                if (draw.query) {
+                    vkCmdBeginQuery(commandBuffer, queryPool, static_cast<uint32_t>(queryChunks.size()), 0);
+                    vkCmdDraw(commandBuffer, draw.chunk->vertexCount, 1, firstVertex, 0);
+                    vkCmdEndQuery(commandBuffer, queryPool, static_cast<uint32_t>(queryChunks.size()));
+                    queryChunks.push_back(draw.chunk->coord);
+                } else {
+                    vkCmdDraw(commandBuffer, draw.chunk->vertexCount, 1, firstVertex, 0);
+                }
+            }
+        }
+        recordProps(commandBuffer, draws);
+
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 1);
+        }
+
+        // Hidden chunks: test their boxes against the depth of everything drawn above
+        if (!boxQueries.empty()) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bboxPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bboxPipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+            for (const VolumeChunk* chunk : boxQueries) {
+                BoxPushConstants box{glm::vec4(chunk->drawnMin - OCCLUSION_BOX_MARGIN, 0.0f),
+                                     glm::vec4(chunk->drawnMax + OCCLUSION_BOX_MARGIN, 0.0f)};
+                vkCmdPushConstants(commandBuffer, bboxPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(box), &box);
+                vkCmdBeginQuery(commandBuffer, queryPool, static_cast<uint32_t>(queryChunks.size()), 0);
+                vkCmdDraw(commandBuffer, 36, 1, 0, 0);
+                vkCmdEndQuery(commandBuffer, queryPool, static_cast<uint32_t>(queryChunks.size()));
+                queryChunks.push_back(chunk->coord);
             }
         }
 
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 2);
+            timestampsWritten[currentFrame] = true;
+        }
+
+        recordStreamOverlay(commandBuffer);
+
         vkCmdEndRenderPass(commandBuffer);
 
+        // Next frame's cull tests against this frame's depth
+        if (gpuCull && hiZSupported && occlusionCulling) {
+            recordHiZPyramid(commandBuffer);
+        } else {
+            hiZValid = false;
+        }
+
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("Failed to record command buffer!");
         }
     }
 
+    // One instanced draw per prop type for each nearby chunk that survived culling. The
+    // instances sit in the chunk's arena range right after its vertices.
+    void recordProps(VkCommandBuffer commandBuffer, const std::vector<ChunkDraw>& draws) {
+        if (!drawProps) {
+            return;
+        }
+        bool bound = false;
+        float maxDistanceSq = propDrawDistance * propDrawDistance;
+        for (const ChunkDraw& draw : draws) {
+            const VolumeChunk* chunk = draw.chunk;
+            glm::vec3 nearest = glm::clamp(camera.position, chunk->worldMin, chunk->worldMax);
+            glm::vec3 offset = nearest - camera.position;
+            if (glm::dot(offset, offset) > maxDistanceSq) {
+                continue;
+            }
+
+            uint32_t instanceCount = 0;
+            for (uint32_t count : chunk->propCounts) {
+                instanceCount += count;
+            }
+            if (instanceCount == 0) {
+                continue;
+            }
+
+            if (!bound) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, propPipeline);
+                VkDeviceSize meshOffset = 0;
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &propMeshBuffer, &meshOffset);
+                bound = true;
+            }
+            VkDeviceSize instanceOffset = chunk->mesh.offset + sizeof(MarchingCubesVertex) * chunk->vertexCount;
+            vkCmdBindVertexBuffers(commandBuffer, 1, 1, &meshArenaBuffer, &instanceOffset);
+
+            uint32_t firstInstance = 0;
+            for (int type = 0; type < PROP_TYPE_COUNT; type++) {
+                uint32_t count = chunk->propCounts[type];
+                if (count > 0) {
+                    vkCmdDraw(commandBuffer, propMeshes.counts[type], count, propMeshes.firsts[type], firstInstance);
+                    propDrawsThisSecond++;
+                }
+                firstInstance += count;
+            }
+            propInstancesThisSecond += instanceCount;
+        }
+    }
+
+    // Solid extents of the resident chunk columns, for the horizon culler
+    void rebuildHorizonColumns() {
+        horizonChunks.clear();
+        for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+            horizonChunks.push_back({coord, chunk->solidBase});
+        }
+        buildHorizonColumns(horizonChunks, horizonColumns);
+        horizonColumnsDirty = false;
+    }
+
+    // Frustum, horizon and occlusion culling for this frame. Chunks to draw go in `draws`, hidden
+    // chunks whose boxes get tested go in `boxQueries`. Returns the number of queries used.
+    // With GPU culling the frustum and occlusion tests move to cull.comp (see planGpuCull).
+    uint32_t planChunkDraws(std::vector<ChunkDraw>& draws, std::vector<const VolumeChunk*>& boxQueries) {
+        Frustum frustum = Frustum::fromMatrix(projectionMatrix() * camera.getViewMatrix());
+        uint64_t frame = renderFrameIndex++;
+        uint32_t queryCount = 0;
+
+        // Column rebuild and sweep; the per-chunk tests are too short to time one by one (see terrain_bench)
+        auto horizonStart = std::chrono::steady_clock::now();
+        if (horizonCulling) {
+            if (horizonColumnsDirty) {
+                rebuildHorizonColumns();
+            }
+            horizonCuller.build(camera.position, horizonColumns, horizonSettings);
+        }
+        horizonMsAccum += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - horizonStart).count();
+
+        if (useGpuCulling()) {
+            planGpuCull(frustum, draws);
+            return 0;
+        }
+
+        for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+            if (!chunk->meshUploaded || chunk->vertexCount == 0 || chunk->mesh.size == 0) {
+                continue;
+            }
+
+            // Drawn bounds include the props, which reach past the chunk's own box
+            glm::vec3 boxMin = chunk->drawnMin - OCCLUSION_BOX_MARGIN;
+            glm::vec3 boxMax = chunk->drawnMax + OCCLUSION_BOX_MARGIN;
+            chunk->culled = false;
+            if (!frustum.intersectsBox(boxMin, boxMax)) {
+                // History is stale by the time it comes back into view; start it visible
+                chunk->visibility.occludedStreak = 0;
+                chunk->culled = true;
+                frustumCulledThisSecond++;
+                continue;
+            }
+
+            // Behind a ridge: no query needed, and the history restarts like for the frustum
+            if (horizonCulling && horizonCuller.isHidden(boxMin, boxMax)) {
+                chunk->visibility.occludedStreak = 0;
+                chunk->culled = true;
+                horizonCulledThisSecond++;
+                continue;
+            }
+
+            // A box around the camera is clipped by the near plane, so never test it
+            bool cameraInside = glm::all(glm::greaterThanEqual(camera.position, boxMin)) &&
+                                glm::all(glm::lessThanEqual(camera.position, boxMax));
+            if (!occlusionCulling || cameraInside) {
+                chunk->visibility.occludedStreak = 0;
+                draws.push_back({chunk.get(), false});
+                continue;
+            }
+
+            OcclusionAction action = chooseOcclusionAction(chunk->visibility, frame,
+                                                           static_cast<uint32_t>(std::hash<ChunkCoord>()(coord)),
+                                                           occlusionSettings);
+            bool haveQuery = queryCount < MAX_OCCLUSION_QUERIES;
+            if (action == OcclusionAction::QueryBox && haveQuery) {
+                boxQueries.push_back(chunk.get());
+                chunk->culled = true;
+                occludedThisSecond++;
+                trianglesOccludedThisSecond += chunk->vertexCount / 3;
+            } else {
+                // Out of queries: draw untested rather than risk a wrong cull
+                draws.push_back({chunk.get(), action != OcclusionAction::Draw && haveQuery});
+            }
+            if (action != OcclusionAction::Draw && haveQuery) {
+                queryCount++;
+            }
+        }
+
+        chunksDrawnThisSecond += static_cast<uint32_t>(draws.size());
+        occlusionQueriesThisSecond += queryCount;
+        return queryCount;
+    }
+
+    // GPU path of planChunkDraws: a cull.comp record for every chunk with a mesh, in this frame
+    // slot's mapped chunk buffer. The horizon culler still runs here, and chunks it hides go in
+    // as empty records. Frustum and Hi-Z (occlusion_culling) are left to the GPU, so the only
+    // draws chosen on the CPU are the props of nearby chunks in the frustum.
+    void planGpuCull(const Frustum& frustum, std::vector<ChunkDraw>& draws) {
+        GpuCullFrame& cull = cullFrames[currentFrame];
+        reserveCullRecords(cull, static_cast<uint32_t>(chunkManager.getChunks().size()));
+        auto* records = static_cast<GpuCullChunk*>(cull.chunkMapped);
+        float propDistanceSq = drawProps ? propDrawDistance * propDrawDistance : -1.0f;
+
+        uint32_t count = 0;
+        uint32_t live = 0;
+        for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+            if (!chunk->meshUploaded || chunk->vertexCount == 0 || chunk->mesh.size == 0) {
+                continue;
+            }
+            // Query history is unused here; start it visible if the CPU path takes over
+            chunk->visibility.occludedStreak = 0;
+            glm::vec3 boxMin = chunk->drawnMin - OCCLUSION_BOX_MARGIN;
+            glm::vec3 boxMax = chunk->drawnMax + OCCLUSION_BOX_MARGIN;
+            chunk->culled = horizonCulling && horizonCuller.isHidden(boxMin, boxMax);
+            if (chunk->culled) {
+                horizonCulledThisSecond++;
+            }
+
+            live += chunk->culled ? 0 : 1;
+            GpuCullChunk& record = records[count++];
+            record.boxMin = glm::vec4(boxMin, 0.0f);
+            record.boxMax = glm::vec4(boxMax, 0.0f);
+            record.firstVertex = static_cast<uint32_t>(chunk->mesh.offset / sizeof(MarchingCubesVertex));
+            record.vertexCount = chunk->culled ? 0 : chunk->vertexCount;
+
+            if (!chunk->culled && chunk->propCounts != std::array<uint32_t, PROP_TYPE_COUNT>{}) {
+                glm::vec3 offset = glm::clamp(camera.position, chunk->worldMin, chunk->worldMax) - camera.position;
+                if (glm::dot(offset, offset) <= propDistanceSq && frustum.intersectsBox(boxMin, boxMax)) {
+                    draws.push_back({chunk.get(), false});
+                }
+            }
+        }
+
+        glm::mat4 viewProj = projectionMatrix() * camera.getViewMatrix();
+        glm::ivec2 hiZSize(static_cast<int>(swapChainExtent.width), static_cast<int>(swapChainExtent.height));
+        uint32_t levels = (occlusionCulling && hiZValid) ? hiZLevels : 0;
+        GpuCullParams params = makeGpuCullParams(viewProj, hiZViewProj, hiZSize, levels, count);
+        memcpy(cull.paramsMapped, &params, sizeof(params));
+        cull.chunkCount = count;
+        cull.liveCount = live;
+        cull.countPending = true;
+    }
+
+    // Results of the queries recorded the last time this frame slot was used. Call once its
+    // fence has signalled, before the slot's command buffer is recorded again.
+    void collectOcclusionResults(uint32_t frame) {
+        std::vector<ChunkCoord>& queryChunks = occlusionQueryChunks[frame];
+        if (!queryChunks.empty()) {
+            std::vector<uint64_t> samples(queryChunks.size());
+            VkResult result = vkGetQueryPoolResults(device, occlusionQueryPools[frame], 0,
+                                                    static_cast<uint32_t>(samples.size()),
+                                                    samples.size() * sizeof(uint64_t), samples.data(), sizeof(uint64_t),
+                                                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+            if (result == VK_SUCCESS) {
+                for (size_t i = 0; i < queryChunks.size(); i++) {
+                    // The chunk may have been unloaded since
+                    if (VolumeChunk* chunk = chunkManager.getChunk(queryChunks[i])) {
+                        recordOcclusionResult(chunk->visibility, samples[i] != 0);
+                    }
+                }
+            }
+            queryChunks.clear();
+        }
+
+        GpuCullFrame& cull = cullFrames[frame];
+        if (cull.countPending) {
+            uint32_t drawn = std::min(*static_cast<const uint32_t*>(cull.countMapped), cull.liveCount);
+            chunksDrawnThisSecond += drawn;
+            gpuCulledThisSecond += cull.liveCount - drawn;
+            cull.countPending = false;
+        }
+
+        if (timestampsWritten[frame]) {
+            uint64_t timestamps[3];
+            if (vkGetQueryPoolResults(device, timestampQueryPools[frame], 0, 3, sizeof(timestamps), timestamps,
+                                      sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+                auto ticksToMs = [this](uint64_t begin, uint64_t end) {
+                    return static_cast<float>((end - begin) & timestampMask) * timestampPeriodNs * 1e-6f;
+                };
+                drawGpuMsAccum += ticksToMs(timestamps[0], timestamps[1]);
+                queryGpuMsAccum += ticksToMs(timestamps[1], timestamps[2]);
+                gpuTimedFrames++;
+            }
+            timestampsWritten[frame] = false;
+        }
+    }
+
+    glm::mat4 projectionMatrix() const {
+        glm::mat4 proj = glm::perspective(glm::radians(60.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 1000.0f);
+        proj[1][1] *= -1;  // GLM was designed for OpenGL, flip Y for Vulkan
+        return proj;
+    }
+
     void updateUniformBuffer(uint32_t currentImage) {
         UniformBufferObject ubo{};
         ubo.model = glm::mat4(1.0f);  // Identity - no rotation
         ubo.view = camera.getViewMatrix();
-        ubo.proj = glm::perspective(glm::radians(60.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 1000.0f);
-        ubo.proj[1][1] *= -1;  // GLM was designed for OpenGL, flip Y for Vulkan
+        ubo.proj = projectionMatrix();
 
         memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
     }
 
     void drawFrame() {
         vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        collectOcclusionResults(currentFrame);
 
         uint32_t imageIndex;
         VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
@@ -1568,10 +3672,13 @@ private:
             throw std::runtime_error("Failed to present swap chain image!");
         }
 
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        currentFrame = (currentFrame + 1) % framesInFlight;
     }
 
     void cleanupSwapChain() {
+        if (gpuCullingSupported) {
+            destroyHiZPyramid();
+        }
         vkDestroyImageView(device, depthImageView, nullptr);
         vkDestroyImage(device, depthImage, nullptr);
         vkFreeMemory(device, depthImageMemory, nullptr);
@@ -1603,6 +3710,9 @@ private:
         createImageViews();
         createDepthResources();
         createFramebuffers();
+        if (gpuCullingSupported) {
+            createHiZPyramid();
+        }
 
         std::cout << "Window resized to: " << swapChainExtent.width << "x" << swapChainExtent.height
                   << " (aspect ratio: " << (swapChainExtent.width / (float)swapChainExtent.height) << ")" << std::endl;
@@ -1618,21 +3728,40 @@ private:
             lastFrameTime = currentTime;
 
             glfwPollEvents();
+            applyTuning();
 
             // Process camera input
             camera.processKeyboard(window, deltaTime);
 
+            bool occlusionKeyPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+            if (occlusionKeyPressed && !occlusionKeyWasPressed) {
+                occlusionCulling = occlusionCulling ? 0 : 1;
+                std::cout << "Occlusion culling: " << (occlusionCulling ? "ON" : "OFF") << std::endl;
+            }
+            occlusionKeyWasPressed = occlusionKeyPressed;
+
+            bool overlayKeyPressed = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+            if (overlayKeyPressed && !overlayKeyWasPressed) {
+                streamOverlay = (streamOverlay + 1) % static_cast<int>(StreamOverlayMode::Count);
+                std::cout << "Streaming overlay: " << streamOverlay << std::endl;
+            }
+            overlayKeyWasPressed = overlayKeyPressed;
+
             // Update physics (gravity, collision)
+            ensureCollisionChunk();
             camera.updatePhysics(deltaTime, chunkManager);
 
             // Update chunks periodically (every 0.5 seconds)
             float timeSinceChunkUpdate = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - lastChunkUpdateTime).count();
-            if (timeSinceChunkUpdate > 0.5f) {
+            if (timeSinceChunkUpdate > chunkUpdateInterval) {
+                updateMemoryGovernor();
+                StreamRadii radii = streamRadii();
+
                 // Clean up GPU resources for chunks that will be removed (only very distant ones)
                 ChunkCoord cameraChunk = worldToChunkCoord(camera.position);
                 std::vector<ChunkCoord> toCleanup;
-                int horizontalUnload = 4;
-                int verticalUnload = 8;  // 2× horizontal to prevent thrashing when falling
+                int horizontalUnload = radii.unload;
+                int verticalUnload = radii.unload * 2;  // 2× horizontal to prevent thrashing when falling
                 for (const auto& [coord, chunk] : chunkManager.getChunks()) {
                     int dx = coord.x - cameraChunk.x;
                     int dy = coord.y - cameraChunk.y;
@@ -1642,28 +3771,34 @@ private:
                             chunk->uploadInProgress.load()) {
                             continue;
                         }
-                        if (chunk->vertexBuffer != VK_NULL_HANDLE) {
-                            vkDestroyBuffer(device, chunk->vertexBuffer, nullptr);
-                            vkFreeMemory(device, chunk->vertexBufferMemory, nullptr);
-                        }
+                        // Frames in flight may still draw it
+                        retireMesh(chunk->mesh);
+                        chunk->mesh = ArenaRange{};
                         toCleanup.push_back(coord);
                     }
                 }
 
-                // Update chunks (load 1 chunk ahead, keep until 4 away for caching)
-                auto newChunks = chunkManager.updateChunks(camera.position, 1, 4);
+                // Update chunks (load loadRadius ahead, keep until unloadRadius away for caching)
+                auto newChunks = chunkManager.updateChunks(camera.position, radii.load, radii.unload, radii.collision);
+                if (!newChunks.empty() || !toCleanup.empty()) {
+                    horizonColumnsDirty = true;
+                }
+                navWorld.retainChunks([this](ChunkCoord coord) { return chunkManager.getChunk(coord) != nullptr; });
 
                 // Queue generation for newly loaded chunks
                 for (VolumeChunk* chunk : newChunks) {
                     enqueueChunkGeneration(chunk);
                 }
+                updateResidencyTiers();
 
                 lastChunkUpdateTime = currentTime;
             }
 
             auto uploadStart = std::chrono::steady_clock::now();
-            int submittedUploads = processCompletedMeshes(1.5f, 3);
+            int submittedUploads = processCompletedMeshes();
             int completedFences = processUploadFences();
+            freeRetiredRanges(false);
+            navWorld.update([this](ChunkCoord coord) { return chunkManager.getChunk(coord) != nullptr; });
             auto uploadEnd = std::chrono::steady_clock::now();
 
             uploadWorkMsAccum += std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count();
@@ -1672,22 +3807,31 @@ private:
             fencesCompletedThisSecond += completedFences;
 
             drawFrame();
+            countVulkanFrame();
 
             // FPS counter
             frameCount++;
+            float frameMs = deltaTime * 1000.0f;
+            frameMsSum += frameMs;
+            frameMsSumSq += static_cast<double>(frameMs) * frameMs;
+            frameMsMax = std::max(frameMsMax, frameMs);
             float elapsed = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - lastFpsTime).count();
 
             if (elapsed >= 1.0f) {
                 float fps = frameCount / elapsed;
+                double frameMsMean = frameMsSum / frameCount;
+                double frameMsStdDev = std::sqrt(std::max(0.0, frameMsSumSq / frameCount - frameMsMean * frameMsMean));
                 ChunkCoord cameraChunk = worldToChunkCoord(camera.position);
-                size_t pendingUploadCount = pendingUploads.size();
-                size_t completedQueueSize = 0;
+                size_t pendingUploads = pendingUploadCount();
+                size_t completedQueueSize = readyMeshes.size();
                 {
                     std::lock_guard<std::mutex> lock(completedMutex);
-                    completedQueueSize = completedMeshes.size();
+                    completedQueueSize += completedMeshes.size();
                 }
                 float avgUploadMs = uploadFramesAccum > 0 ? (uploadWorkMsAccum / uploadFramesAccum) : 0.0f;
-                std::cout << "FPS: " << fps << " | Camera pos: ("
+                std::cout << "FPS: " << fps
+                         << " | Frame ms avg/sd/max: " << frameMsMean << " / " << frameMsStdDev << " / " << frameMsMax
+                         << " | Camera pos: ("
                          << camera.position.x << ", "
                          << camera.position.y << ", "
                          << camera.position.z << ") | Chunk: ("
@@ -1696,33 +3840,120 @@ private:
                          << " | Upload avg ms: " << avgUploadMs
                          << " | Uploads: +" << uploadsSubmittedThisSecond
                          << " / done " << fencesCompletedThisSecond
-                         << " | Pending: " << pendingUploadCount
+                         << " | Pending: " << pendingUploads
                          << " | ReadyQ: " << completedQueueSize
-                         << std::endl;
+                         << " | Upload KB/frame: " << uploadThroughput.frameByteBudget(uploadSettings) / 1024
+                         << " (MB/s cpu " << uploadThroughput.cpuBytesPerMs() / 1000.0f
+                         << ", gpu " << uploadThroughput.gpuBytesPerMs() / 1000.0f << ")";
+                if (coarseUploadsThisSecond > 0) {
+                    std::cout << " | Coarse: " << coarseUploadsThisSecond;
+                }
+                if (memoryGovernorEnabled) {
+                    std::cout << " | Mem: " << memoryGovernor.describe();
+                    if (memoryShedLevel() != MemoryShedLevel::None) {
+                        std::cout << " | Shed: " << memoryShedLevelName(memoryShedLevel());
+                    }
+                }
+                if (trianglesRemovedThisSecond > 0) {
+                    std::cout << " | Tris dropped: " << trianglesRemovedThisSecond << "/"
+                              << (trianglesKeptThisSecond + trianglesRemovedThisSecond);
+                }
+                // Occlusion culling: draws saved against the queries (and GPU time) spent on them
+                bool gpuCull = useGpuCulling();
+                std::cout << " | Drawn/frame: " << chunksDrawnThisSecond / frameCount;
+                if (gpuCull) {
+                    std::cout << " | GPU culled: " << gpuCulledThisSecond / frameCount;
+                } else {
+                    std::cout << " | Frustum culled: " << frustumCulledThisSecond / frameCount;
+                }
+                if (horizonCulling) {
+                    std::cout << " | Horizon: " << horizonCulledThisSecond / frameCount << " ("
+                              << horizonMsAccum / frameCount << " ms build)";
+                }
+                if (occlusionCulling && !gpuCull) {
+                    std::cout << " | Occluded: " << occludedThisSecond / frameCount
+                              << " (" << trianglesOccludedThisSecond / frameCount << " tris)"
+                              << " | Queries: " << occlusionQueriesThisSecond / frameCount;
+                }
+                if (propDrawsThisSecond > 0) {
+                    std::cout << " | Props/frame: " << propInstancesThisSecond / frameCount
+                              << " in " << propDrawsThisSecond / frameCount << " draws";
+                }
+                if (gpuTimedFrames > 0) {
+                    std::cout << " | GPU ms draw/query: " << drawGpuMsAccum / gpuTimedFrames
+                              << " / " << queryGpuMsAccum / gpuTimedFrames;
+                }
+                std::cout << " | Arena: " << meshArena.usedBytes() / (1024 * 1024) << "/"
+                          << meshArena.capacity() / (1024 * 1024) << " MB";
+                chunksDrawnThisSecond = 0;
+                frustumCulledThisSecond = 0;
+                gpuCulledThisSecond = 0;
+                horizonCulledThisSecond = 0;
+                horizonMsAccum = 0.0f;
+                occludedThisSecond = 0;
+                trianglesOccludedThisSecond = 0;
+                occlusionQueriesThisSecond = 0;
+                propDrawsThisSecond = 0;
+                propInstancesThisSecond = 0;
+                drawGpuMsAccum = 0.0f;
+                queryGpuMsAccum = 0.0f;
+                gpuTimedFrames = 0;
+
+                // Representation is fixed once sdfReady is set
+                size_t heightfieldCount = 0;
+                size_t fullSdfCount = 0;
+                size_t sdfBytes = 0;
+                for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+                    if (chunk->sdfReady.load()) {
+                        heightfieldCount += chunk->heightfield ? 1 : 0;
+                        fullSdfCount += chunk->sdf ? 1 : 0;
+                        sdfBytes += chunk->sdfMemoryBytes();
+                    }
+                }
+                std::cout << " | Heightfield chunks: " << heightfieldCount
+                          << " | Full SDFs: " << fullSdfCount
+                          << " | SDF MB: " << sdfBytes / (1024.0f * 1024.0f);
+                float urgentMs = lastUrgentLatencyMs.exchange(-1.0f);
+                if (urgentMs >= 0.0f) {
+                    std::cout << " | Urgent chunk ms: " << urgentMs;
+                }
+                // Collision that had to run ahead of chunk generation
+                uint32_t fallbackEvaluations = chunkManager.getCollisionFallback().takeEvaluationCount();
+                if (fallbackEvaluations > 0) {
+                    std::cout << " | Collision fallback evals: " << fallbackEvaluations;
+                }
+                printVulkanChurn(frameCount);
+                std::cout << std::endl;
+                drainSamplingProfiler();
                 frameCount = 0;
+                frameMsSum = 0.0;
+                frameMsSumSq = 0.0;
+                frameMsMax = 0.0f;
                 lastFpsTime = currentTime;
                 uploadWorkMsAccum = 0.0f;
                 uploadFramesAccum = 0;
                 uploadsSubmittedThisSecond = 0;
                 fencesCompletedThisSecond = 0;
+                trianglesKeptThisSecond = 0;
+                trianglesRemovedThisSecond = 0;
+                coarseUploadsThisSecond = 0;
             }
         }
         vkDeviceWaitIdle(device);
     }
 
     void cleanup() {
-        stopGenerationWorker();
+        tuning.stopConsole();
+        stopGenerationWorkers();
         flushPendingUploads();
+        freeRetiredRanges(true);
 
         cleanupSwapChain();
 
-        // Clean up chunk meshes
-        for (auto& [coord, chunk] : chunkManager.getChunks()) {
-            if (chunk->vertexBuffer != VK_NULL_HANDLE) {
-                vkDestroyBuffer(device, chunk->vertexBuffer, nullptr);
-                vkFreeMemory(device, chunk->vertexBufferMemory, nullptr);
-            }
-        }
+        // Chunk meshes all live in the arena
+        vkDestroyBuffer(device, meshArenaBuffer, nullptr);
+        vkFreeMemory(device, meshArenaMemory, nullptr);
+        destroyGpuCullingResources();
 
         vkDestroyBuffer(device, indexBuffer, nullptr);
         vkFreeMemory(device, indexBufferMemory, nullptr);
@@ -1730,9 +3961,14 @@ private:
         vkDestroyBuffer(device, vertexBuffer, nullptr);
         vkFreeMemory(device, vertexBufferMemory, nullptr);
 
+        vkDestroyBuffer(device, propMeshBuffer, nullptr);
+        vkFreeMemory(device, propMeshBufferMemory, nullptr);
+
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroyBuffer(device, uniformBuffers[i], nullptr);
             vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
+            vkDestroyBuffer(device, debugLineBuffers[i], nullptr);
+            vkFreeMemory(device, debugLineBuffersMemory[i], nullptr);
         }
 
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
@@ -1740,7 +3976,17 @@ private:
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
+        vkDestroyPipeline(device, debugLinePipeline, nullptr);
+        vkDestroyPipeline(device, propPipeline, nullptr);
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        vkDestroyPipeline(device, bboxPipeline, nullptr);
+        vkDestroyPipelineLayout(device, bboxPipelineLayout, nullptr);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            vkDestroyQueryPool(device, occlusionQueryPools[i], nullptr);
+            if (timestampQueryPools[i] != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(device, timestampQueryPools[i], nullptr);
+            }
+        }
         vkDestroyRenderPass(device, renderPass, nullptr);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
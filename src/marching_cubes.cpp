@@ -1,27 +1,177 @@
 #include "marching_cubes.h"
 #include "marching_cubes_tables.h"
+#include "sdf_mip.h"
 #include <cmath>
+#include <tuple>
+#include <utility>
+
+namespace {
+    // Crossings this close to a corner (as a fraction of the edge) snap onto it. Every cube
+    // sharing the edge computes the same snap, so the mesh stays watertight, and triangles
+    // that collapse onto a corner become exactly degenerate.
+    constexpr float SNAP_FRACTION = 0.05f;
+
+    // Triangles below this area (m^2) are dropped as slivers
+    constexpr float MIN_TRIANGLE_AREA = 1e-6f;
+
+    // Samples per axis of a grid: chunk grids are CHUNK_SIZE, mip levels carry their own size
+    template<typename Grid>
+    int gridSamples(const Grid&) {
+        return CHUNK_SIZE;
+    }
+
+    int gridSamples(const SdfMipLevel& level) {
+        return level.size;
+    }
+}
 
 MarchingCubes::MarchingCubes() : isoLevel(0.0f) {
 }
 
-std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const VolumeChunk& chunk) {
+std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const VolumeChunk& chunk, MeshStats* stats) {
+    if (chunk.heightfield) {
+        return generateHeightfieldMesh(*chunk.heightfield, chunkToWorldPos(chunk.coord), VOXEL_SIZE, stats);
+    }
+    return generateMesh(*chunk.sdf, chunkToWorldPos(chunk.coord), VOXEL_SIZE, stats);
+}
+
+std::vector<MarchingCubesVertex> MarchingCubes::generateHeightfieldMesh(const HeightfieldData& field, glm::vec3 origin,
+                                                                        float voxelSize, MeshStats* stats) {
+    // Surface point and shading of every column, shared by the four cells around it.
+    // The crossing goes through interpolate() with the same corners as the vertical cube
+    // edge, so snapping and rounding are identical to the cube mesher.
+    MarchingCubesVertex columns[CHUNK_SIZE][CHUNK_SIZE];
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            int y = field.cell[x][z];
+            glm::vec3 lower = getCornerPos(x, y, z, 0, origin, voxelSize);
+            glm::vec3 upper = getCornerPos(x, y, z, 4, origin, voxelSize);
+            MarchingCubesVertex& vertex = columns[x][z];
+            vertex.pos = interpolate(field.below[x][z], field.above[x][z], lower, upper);
+            vertex.color = calculateNormal(field, vertex.pos - origin, voxelSize) * 0.5f + 0.5f;
+        }
+    }
+
+    std::vector<MarchingCubesVertex> vertices;
+    vertices.reserve(CHUNK_CUBES * CHUNK_CUBES * 6);
+    MeshStats localStats;
+    auto addTriangle = [&](const MarchingCubesVertex& a, const MarchingCubesVertex& b, const MarchingCubesVertex& c) {
+        if (a.pos == b.pos || b.pos == c.pos || c.pos == a.pos) {
+            localStats.degenerateRemoved++;
+            return;
+        }
+        vertices.push_back(a);
+        vertices.push_back(b);
+        vertices.push_back(c);
+        localStats.trianglesEmitted++;
+    };
+
+    // The crossings on the horizontal edges of a face between two neighbouring columns,
+    // walking from column `from` to column `to`. A cube-meshed neighbour has vertices there;
+    // they come from the stored face samples, through interpolate() like the cube mesher's.
+    auto appendFaceCrossings = [&](ChunkFace face, int from, int to, std::vector<MarchingCubesVertex>& ring) {
+        auto column = [face](int i) {
+            switch (face) {
+                case ChunkFace::MinX: return std::make_pair(0, i);
+                case ChunkFace::MaxX: return std::make_pair(CHUNK_CUBES, i);
+                case ChunkFace::MinZ: return std::make_pair(i, 0);
+                default: return std::make_pair(i, CHUNK_CUBES);
+            }
+        };
+        auto [fromX, fromZ] = column(from);
+        auto [toX, toZ] = column(to);
+        int fromCell = field.cell[fromX][fromZ];
+        int toCell = field.cell[toX][toZ];
+        const float* fromSamples = field.border[static_cast<int>(face)][from];
+        const float* toSamples = field.border[static_cast<int>(face)][to];
+
+        // Crossing levels lie between the two columns' cells, so walk y from one to the other
+        int step = fromCell < toCell ? 1 : -1;
+        for (int y = fromCell + (step > 0 ? 1 : 0); y != toCell + (step > 0 ? 1 : 0); y += step) {
+            if ((fromSamples[y] < isoLevel) == (toSamples[y] < isoLevel)) {
+                continue;
+            }
+            MarchingCubesVertex vertex;
+            vertex.pos = interpolate(fromSamples[y], toSamples[y], getCornerPos(fromX, y, fromZ, 0, origin, voxelSize),
+                                     getCornerPos(toX, y, toZ, 0, origin, voxelSize));
+            vertex.color = calculateNormal(field, vertex.pos - origin, voxelSize) * 0.5f + 0.5f;
+            ring.push_back(vertex);
+        }
+    };
+
+    std::vector<MarchingCubesVertex> ring;
+    for (int x = 0; x < CHUNK_CUBES; x++) {
+        for (int z = 0; z < CHUNK_CUBES; z++) {
+            const MarchingCubesVertex& v00 = columns[x][z];
+            const MarchingCubesVertex& v10 = columns[x + 1][z];
+            const MarchingCubesVertex& v01 = columns[x][z + 1];
+            const MarchingCubesVertex& v11 = columns[x + 1][z + 1];
+
+            // Cells on the chunk border go around their outline, picking up the face
+            // crossings, and fan from the cell centre when there are any
+            if (x == 0 || z == 0 || x == CHUNK_CUBES - 1 || z == CHUNK_CUBES - 1) {
+                ring.clear();
+                ring.push_back(v00);
+                if (z == 0) {
+                    appendFaceCrossings(ChunkFace::MinZ, x, x + 1, ring);
+                }
+                ring.push_back(v10);
+                if (x == CHUNK_CUBES - 1) {
+                    appendFaceCrossings(ChunkFace::MaxX, z, z + 1, ring);
+                }
+                ring.push_back(v11);
+                if (z == CHUNK_CUBES - 1) {
+                    appendFaceCrossings(ChunkFace::MaxZ, x + 1, x, ring);
+                }
+                ring.push_back(v01);
+                if (x == 0) {
+                    appendFaceCrossings(ChunkFace::MinX, z + 1, z, ring);
+                }
+                if (ring.size() > 4) {
+                    MarchingCubesVertex center;
+                    center.pos = (v00.pos + v10.pos + v01.pos + v11.pos) * 0.25f;
+                    center.color = calculateNormal(field, center.pos - origin, voxelSize) * 0.5f + 0.5f;
+                    for (size_t i = 0; i < ring.size(); i++) {
+                        addTriangle(center, ring[(i + 1) % ring.size()], ring[i]);
+                    }
+                    continue;
+                }
+            }
+
+            // Split along the diagonal with the smaller height difference (flatter triangles)
+            bool mainDiagonal = std::abs(v00.pos.y - v11.pos.y) <= std::abs(v10.pos.y - v01.pos.y);
+            addTriangle(v00, mainDiagonal ? v11 : v01, v10);
+            addTriangle(mainDiagonal ? v00 : v10, v01, v11);
+        }
+    }
+
+    if (stats) {
+        *stats = localStats;
+    }
+    return vertices;
+}
+
+template<typename Grid>
+std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const Grid& grid, glm::vec3 origin, float voxelSize,
+                                                             MeshStats* stats) {
     std::vector<MarchingCubesVertex> vertices;
+    MeshStats localStats;
+    const int samples = gridSamples(grid);
 
     // Process each cube in the volume
-    for (int x = 0; x < CHUNK_SIZE - 1; x++) {
-        for (int y = 0; y < CHUNK_SIZE - 1; y++) {
-            for (int z = 0; z < CHUNK_SIZE - 1; z++) {
+    for (int x = 0; x < samples - 1; x++) {
+        for (int y = 0; y < samples - 1; y++) {
+            for (int z = 0; z < samples - 1; z++) {
                 // Get the 8 corner values of this cube
                 float cubeValues[8];
-                cubeValues[0] = chunk.sdf[x][y][z];
-                cubeValues[1] = chunk.sdf[x+1][y][z];
-                cubeValues[2] = chunk.sdf[x+1][y][z+1];
-                cubeValues[3] = chunk.sdf[x][y][z+1];
-                cubeValues[4] = chunk.sdf[x][y+1][z];
-                cubeValues[5] = chunk.sdf[x+1][y+1][z];
-                cubeValues[6] = chunk.sdf[x+1][y+1][z+1];
-                cubeValues[7] = chunk.sdf[x][y+1][z+1];
+                cubeValues[0] = grid.at(x, y, z);
+                cubeValues[1] = grid.at(x+1, y, z);
+                cubeValues[2] = grid.at(x+1, y, z+1);
+                cubeValues[3] = grid.at(x, y, z+1);
+                cubeValues[4] = grid.at(x, y+1, z);
+                cubeValues[5] = grid.at(x+1, y+1, z);
+                cubeValues[6] = grid.at(x+1, y+1, z+1);
+                cubeValues[7] = grid.at(x, y+1, z+1);
 
                 // Determine the index into the edge table
                 int cubeIndex = 0;
@@ -39,7 +189,7 @@ std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const VolumeChunk&
                 // Get corner positions
                 glm::vec3 cornerPos[8];
                 for (int i = 0; i < 8; i++) {
-                    cornerPos[i] = getCornerPos(x, y, z, i, chunk);
+                    cornerPos[i] = getCornerPos(x, y, z, i, origin, voxelSize);
                 }
 
                 // Find the vertices on each edge
@@ -78,14 +228,25 @@ std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const VolumeChunk&
                     v2.pos = vertList[triTable[cubeIndex][i+1]];
                     v3.pos = vertList[triTable[cubeIndex][i+2]];
 
+                    // Drop zero-area triangles before paying for their normals
+                    if (v1.pos == v2.pos || v2.pos == v3.pos || v3.pos == v1.pos) {
+                        localStats.degenerateRemoved++;
+                        continue;
+                    }
+                    glm::vec3 areaVec = glm::cross(v2.pos - v1.pos, v3.pos - v1.pos);
+                    if (glm::dot(areaVec, areaVec) < 4.0f * MIN_TRIANGLE_AREA * MIN_TRIANGLE_AREA) {
+                        localStats.sliverRemoved++;
+                        continue;
+                    }
+
                     // Calculate normals from SDF gradient
-                    glm::vec3 localPos1 = v1.pos - chunkToWorldPos(chunk.coord);
-                    glm::vec3 localPos2 = v2.pos - chunkToWorldPos(chunk.coord);
-                    glm::vec3 localPos3 = v3.pos - chunkToWorldPos(chunk.coord);
+                    glm::vec3 localPos1 = v1.pos - origin;
+                    glm::vec3 localPos2 = v2.pos - origin;
+                    glm::vec3 localPos3 = v3.pos - origin;
 
-                    glm::vec3 normal1 = calculateNormal(chunk, localPos1);
-                    glm::vec3 normal2 = calculateNormal(chunk, localPos2);
-                    glm::vec3 normal3 = calculateNormal(chunk, localPos3);
+                    glm::vec3 normal1 = calculateNormal(grid, localPos1, voxelSize);
+                    glm::vec3 normal2 = calculateNormal(grid, localPos2, voxelSize);
+                    glm::vec3 normal3 = calculateNormal(grid, localPos3, voxelSize);
 
                     // Use normals as colors for now (visualize shading)
                     v1.color = normal1 * 0.5f + 0.5f;  // Map [-1,1] to [0,1]
@@ -95,54 +256,68 @@ std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(const VolumeChunk&
                     vertices.push_back(v1);
                     vertices.push_back(v2);
                     vertices.push_back(v3);
+                    localStats.trianglesEmitted++;
                 }
             }
         }
     }
 
+    if (stats) {
+        *stats = localStats;
+    }
     return vertices;
 }
 
-glm::vec3 MarchingCubes::getCornerPos(int x, int y, int z, int corner, const VolumeChunk& chunk) {
+glm::vec3 MarchingCubes::getCornerPos(int x, int y, int z, int corner, glm::vec3 origin, float voxelSize) {
     // Corner offsets (matches lookup table convention)
     static const int cornerOffsets[8][3] = {
         {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
         {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}
     };
 
-    glm::vec3 chunkWorldPos = chunkToWorldPos(chunk.coord);
     glm::vec3 localPos = glm::vec3(
-        (x + cornerOffsets[corner][0]) * VOXEL_SIZE,
-        (y + cornerOffsets[corner][1]) * VOXEL_SIZE,
-        (z + cornerOffsets[corner][2]) * VOXEL_SIZE
+        (x + cornerOffsets[corner][0]) * voxelSize,
+        (y + cornerOffsets[corner][1]) * voxelSize,
+        (z + cornerOffsets[corner][2]) * voxelSize
     );
 
-    return chunkWorldPos + localPos;
+    return origin + localPos;
 }
 
 glm::vec3 MarchingCubes::interpolate(float val1, float val2, glm::vec3 pos1, glm::vec3 pos2) {
+    // Neighbouring cubes walk shared edges in opposite directions; a fixed order
+    // makes them compute (and snap) the exact same point. Equal values fall back to
+    // ordering by position so the flat-edge case below picks the same end too.
+    if (val1 > val2 || (val1 == val2 && std::tie(pos1.x, pos1.y, pos1.z) > std::tie(pos2.x, pos2.y, pos2.z))) {
+        std::swap(val1, val2);
+        std::swap(pos1, pos2);
+    }
+
     // Linear interpolation to find zero crossing
-    if (std::abs(isoLevel - val1) < 0.00001f)
-        return pos1;
-    if (std::abs(isoLevel - val2) < 0.00001f)
-        return pos2;
     if (std::abs(val1 - val2) < 0.00001f)
         return pos1;
 
     float t = (isoLevel - val1) / (val2 - val1);
+
+    // Snap near-corner crossings onto the corner itself
+    if (t < SNAP_FRACTION)
+        return pos1;
+    if (t > 1.0f - SNAP_FRACTION)
+        return pos2;
     return pos1 + t * (pos2 - pos1);
 }
 
-glm::vec3 MarchingCubes::calculateNormal(const VolumeChunk& chunk, glm::vec3 localPos) {
+template<typename Grid>
+glm::vec3 MarchingCubes::calculateNormal(const Grid& grid, glm::vec3 localPos, float voxelSize) {
     // Calculate gradient using central differences
-    const float h = VOXEL_SIZE * 0.5f;
+    const float h = voxelSize * 0.5f;
 
-    float dx = sampleSDF(chunk, localPos + glm::vec3(h, 0, 0)) -
-               sampleSDF(chunk, localPos - glm::vec3(h, 0, 0));
-    float dy = sampleSDF(chunk, localPos + glm::vec3(0, h, 0)) -
-               sampleSDF(chunk, localPos - glm::vec3(0, h, 0));
-    float dz = sampleSDF(chunk, localPos + glm::vec3(0, 0, h)) -
-               sampleSDF(chunk, localPos - glm::vec3(0, 0, h));
+    float dx = sampleSDF(grid, localPos + glm::vec3(h, 0, 0), voxelSize) -
+               sampleSDF(grid, localPos - glm::vec3(h, 0, 0), voxelSize);
+    float dy = sampleSDF(grid, localPos + glm::vec3(0, h, 0), voxelSize) -
+               sampleSDF(grid, localPos - glm::vec3(0, h, 0), voxelSize);
+    float dz = sampleSDF(grid, localPos + glm::vec3(0, 0, h), voxelSize) -
+               sampleSDF(grid, localPos - glm::vec3(0, 0, h), voxelSize);
 
     glm::vec3 normal = glm::vec3(dx, dy, dz);
     float len = glm::length(normal);
@@ -155,30 +330,32 @@ glm::vec3 MarchingCubes::calculateNormal(const VolumeChunk& chunk, glm::vec3 loc
     return normal;
 }
 
-float MarchingCubes::sampleSDF(const VolumeChunk& chunk, glm::vec3 localPos) {
+template<typename Grid>
+float MarchingCubes::sampleSDF(const Grid& grid, glm::vec3 localPos, float voxelSize) {
     // Convert local position to voxel coordinates
-    glm::vec3 voxelPos = localPos / VOXEL_SIZE;
+    glm::vec3 voxelPos = localPos / voxelSize;
 
     // Clamp to valid range
-    voxelPos = glm::clamp(voxelPos, glm::vec3(0.0f), glm::vec3(CHUNK_SIZE - 1.001f));
+    const int samples = gridSamples(grid);
+    voxelPos = glm::clamp(voxelPos, glm::vec3(0.0f), glm::vec3(samples - 1.001f));
 
     // Trilinear interpolation
     int x0 = (int)voxelPos.x;
     int y0 = (int)voxelPos.y;
     int z0 = (int)voxelPos.z;
-    int x1 = std::min(x0 + 1, CHUNK_SIZE - 1);
-    int y1 = std::min(y0 + 1, CHUNK_SIZE - 1);
-    int z1 = std::min(z0 + 1, CHUNK_SIZE - 1);
+    int x1 = std::min(x0 + 1, samples - 1);
+    int y1 = std::min(y0 + 1, samples - 1);
+    int z1 = std::min(z0 + 1, samples - 1);
 
     float fx = voxelPos.x - x0;
     float fy = voxelPos.y - y0;
     float fz = voxelPos.z - z0;
 
     // Interpolate along x
-    float c00 = chunk.sdf[x0][y0][z0] * (1 - fx) + chunk.sdf[x1][y0][z0] * fx;
-    float c01 = chunk.sdf[x0][y0][z1] * (1 - fx) + chunk.sdf[x1][y0][z1] * fx;
-    float c10 = chunk.sdf[x0][y1][z0] * (1 - fx) + chunk.sdf[x1][y1][z0] * fx;
-    float c11 = chunk.sdf[x0][y1][z1] * (1 - fx) + chunk.sdf[x1][y1][z1] * fx;
+    float c00 = grid.at(x0, y0, z0) * (1 - fx) + grid.at(x1, y0, z0) * fx;
+    float c01 = grid.at(x0, y0, z1) * (1 - fx) + grid.at(x1, y0, z1) * fx;
+    float c10 = grid.at(x0, y1, z0) * (1 - fx) + grid.at(x1, y1, z0) * fx;
+    float c11 = grid.at(x0, y1, z1) * (1 - fx) + grid.at(x1, y1, z1) * fx;
 
     // Interpolate along y
     float c0 = c00 * (1 - fy) + c10 * fy;
@@ -187,3 +364,13 @@ float MarchingCubes::sampleSDF(const VolumeChunk& chunk, glm::vec3 localPos) {
     // Interpolate along z
     return c0 * (1 - fz) + c1 * fz;
 }
+
+// Grids the mesher is built for: every SDF layout, plus coarse chunks from the mip stage
+template std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(
+    const SdfGrid<RowMajorLayout<CHUNK_CUBES>>&, glm::vec3, float, MeshStats*);
+template std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(
+    const SdfGrid<Tiled4Layout<CHUNK_CUBES>>&, glm::vec3, float, MeshStats*);
+template std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(
+    const SdfGrid<MortonLayout<CHUNK_CUBES>>&, glm::vec3, float, MeshStats*);
+template std::vector<MarchingCubesVertex> MarchingCubes::generateMesh(
+    const SdfMipLevel&, glm::vec3, float, MeshStats*);
@@ -2,6 +2,7 @@
 
 #include "chunk.h"
 #include <vector>
+#include <cstdint>
 
 // Vertex structure matching what Vulkan expects
 struct MarchingCubesVertex {
@@ -9,25 +10,50 @@ struct MarchingCubesVertex {
     glm::vec3 color;
 };
 
+// Per-mesh triangle accounting
+struct MeshStats {
+    uint32_t trianglesEmitted = 0;
+    uint32_t degenerateRemoved = 0;  // Two or more vertices snapped to the same point
+    uint32_t sliverRemoved = 0;      // Distinct vertices but (almost) no area
+
+    uint32_t removed() const { return degenerateRemoved + sliverRemoved; }
+};
+
 class MarchingCubes {
 public:
     MarchingCubes();
 
     // Generate mesh from chunk SDF data
-    std::vector<MarchingCubesVertex> generateMesh(const VolumeChunk& chunk);
+    std::vector<MarchingCubesVertex> generateMesh(const VolumeChunk& chunk, MeshStats* stats = nullptr);
+
+    // Mesh any CHUNK_SIZE^3 grid readable with at(x, y, z), placed at origin with the given
+    // voxel size: other SDF layouts, or a coarse chunk from aggregateSdfChunks.
+    // Instantiated in marching_cubes.cpp.
+    template<typename Grid>
+    std::vector<MarchingCubesVertex> generateMesh(const Grid& grid, glm::vec3 origin, float voxelSize,
+                                                  MeshStats* stats = nullptr);
+
+    // Heightfield chunks: one vertex per column, two triangles per column cell. Border cells
+    // also take the crossings on the horizontal edges of the chunk faces (from
+    // HeightfieldData::border), so the border matches the cube mesher's vertex for vertex
+    // and seams with volumetric neighbours as well as heightfield ones.
+    std::vector<MarchingCubesVertex> generateHeightfieldMesh(const HeightfieldData& field, glm::vec3 origin,
+                                                             float voxelSize, MeshStats* stats = nullptr);
 
 private:
     float isoLevel;  // Surface threshold (0.0 for SDF)
 
     // Get corner positions for a cube at (x,y,z)
-    glm::vec3 getCornerPos(int x, int y, int z, int corner, const VolumeChunk& chunk);
+    glm::vec3 getCornerPos(int x, int y, int z, int corner, glm::vec3 origin, float voxelSize);
 
     // Interpolate position between two corners
     glm::vec3 interpolate(float val1, float val2, glm::vec3 pos1, glm::vec3 pos2);
 
     // Calculate normal from SDF gradient (for smooth shading)
-    glm::vec3 calculateNormal(const VolumeChunk& chunk, glm::vec3 localPos);
+    template<typename Grid>
+    glm::vec3 calculateNormal(const Grid& grid, glm::vec3 localPos, float voxelSize);
 
     // Sample SDF at a local position (with trilinear interpolation)
-    float sampleSDF(const VolumeChunk& chunk, glm::vec3 localPos);
+    template<typename Grid>
+    float sampleSDF(const Grid& grid, glm::vec3 localPos, float voxelSize);
 };
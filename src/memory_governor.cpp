@@ -0,0 +1,214 @@
+#include "memory_governor.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    // cgroup v1 reports "no limit" as a page-rounded INT64_MAX
+    constexpr uint64_t V1_UNLIMITED = 1ull << 60;
+
+    bool fileExists(const std::string& path) {
+        std::ifstream file(path);
+        return file.is_open();
+    }
+
+    // Value of a number-only file; false for "max" or a missing file
+    bool readNumber(const std::string& path, uint64_t& value) {
+        std::ifstream file(path);
+        std::string word;
+        if (!(file >> word) || word == "max") {
+            return false;
+        }
+        try {
+            value = std::stoull(word);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    // "key value" lines (memory.stat, /proc/meminfo with a trailing colon on the key)
+    bool readKeyedNumber(const std::string& path, const std::string& key, uint64_t& value) {
+        std::ifstream file(path);
+        std::string name;
+        uint64_t number = 0;
+        while (file >> name >> number) {
+            if (name == key) {
+                value = number;
+                return true;
+            }
+            file.ignore(256, '\n');
+        }
+        return false;
+    }
+
+    // The "<kind> avg10=<x>" entry of a PSI file
+    bool readPressure(const std::string& path, const std::string& kind, float& avg10) {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, kind.size() + 1, kind + " ") != 0) {
+                continue;
+            }
+            size_t at = line.find("avg10=");
+            if (at == std::string::npos) {
+                return false;
+            }
+            avg10 = std::strtof(line.c_str() + at + 6, nullptr);
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t minusReclaimable(uint64_t usage, uint64_t inactiveFile) {
+        return usage > inactiveFile ? usage - inactiveFile : 0;
+    }
+}
+
+const char* memoryShedLevelName(MemoryShedLevel level) {
+    switch (level) {
+        case MemoryShedLevel::None: return "none";
+        case MemoryShedLevel::ChunkCache: return "chunk cache";
+        case MemoryShedLevel::CompactTiers: return "heightfields";
+        case MemoryShedLevel::CollisionSdf: return "collision SDFs";
+        case MemoryShedLevel::LoadRadius: return "load radius";
+        default: return "?";
+    }
+}
+
+MemoryShedLevel targetShedLevel(const MemorySignals& signals, const MemoryGovernorSettings& settings) {
+    const int maxLevel = static_cast<int>(MemoryShedLevel::Count) - 1;
+    int level = 0;
+    float usage = signals.usageFraction();
+    if (signals.hasLimit && usage >= settings.usageStart) {
+        level = 1 + static_cast<int>((usage - settings.usageStart) / std::max(settings.usageStep, 0.001f));
+    }
+    if (signals.hasPressure && settings.pressureStart > 0.0f && signals.someAvg10 >= settings.pressureStart) {
+        level = std::max(level, 1 + static_cast<int>(std::log2(signals.someAvg10 / settings.pressureStart)));
+    }
+    return static_cast<MemoryShedLevel>(std::min(level, maxLevel));
+}
+
+MemoryGovernor::MemoryGovernor() {
+    // Lines are "id:controllers:path"; v2 has id 0 and no controllers. Inside a container the
+    // path may not exist under our mount, so the mount root is the fallback.
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    std::string v2Path;
+    std::string v1Path;
+    bool haveV2 = false;
+    bool haveV1 = false;
+    while (std::getline(file, line)) {
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+            v2Path = path;
+            haveV2 = true;
+        } else if (("," + controllers + ",").find(",memory,") != std::string::npos) {
+            v1Path = path;
+            haveV1 = true;
+        }
+    }
+
+    if (haveV2) {
+        for (const std::string& dir : {"/sys/fs/cgroup" + v2Path, std::string("/sys/fs/cgroup")}) {
+            if (fileExists(dir + "/memory.max")) {
+                cgroupDir = dir;
+                break;
+            }
+        }
+    }
+    if (cgroupDir.empty() && haveV1) {
+        for (const std::string& dir : {"/sys/fs/cgroup/memory" + v1Path, std::string("/sys/fs/cgroup/memory")}) {
+            if (fileExists(dir + "/memory.limit_in_bytes")) {
+                cgroupDir = dir;
+                cgroupV1 = true;
+                break;
+            }
+        }
+    }
+
+    // The cgroup's own PSI sees only our stalls; the system-wide file also counts the neighbours'
+    if (!cgroupDir.empty() && !cgroupV1 && fileExists(cgroupDir + "/memory.pressure")) {
+        pressurePath = cgroupDir + "/memory.pressure";
+    } else if (fileExists("/proc/pressure/memory")) {
+        pressurePath = "/proc/pressure/memory";
+    }
+    calmSince = std::chrono::steady_clock::now();
+}
+
+MemorySignals MemoryGovernor::sample() const {
+    MemorySignals s;
+    uint64_t limit = 0;
+    uint64_t usage = 0;
+    uint64_t inactiveFile = 0;
+    if (!cgroupDir.empty()) {
+        if (cgroupV1) {
+            if (readNumber(cgroupDir + "/memory.limit_in_bytes", limit) && limit < V1_UNLIMITED &&
+                readNumber(cgroupDir + "/memory.usage_in_bytes", usage)) {
+                readKeyedNumber(cgroupDir + "/memory.stat", "total_inactive_file", inactiveFile);
+                s.hasLimit = true;
+            }
+        } else if (readNumber(cgroupDir + "/memory.max", limit) && readNumber(cgroupDir + "/memory.current", usage)) {
+            readKeyedNumber(cgroupDir + "/memory.stat", "inactive_file", inactiveFile);
+            s.hasLimit = true;
+        }
+        if (s.hasLimit) {
+            s.fromCgroup = true;
+            s.limitBytes = limit;
+            s.usageBytes = minusReclaimable(usage, inactiveFile);
+        }
+    }
+
+    uint64_t totalKb = 0;
+    uint64_t availableKb = 0;
+    if (!s.hasLimit && readKeyedNumber("/proc/meminfo", "MemTotal:", totalKb) &&
+        readKeyedNumber("/proc/meminfo", "MemAvailable:", availableKb)) {
+        s.hasLimit = true;
+        s.limitBytes = totalKb * 1024;
+        s.usageBytes = minusReclaimable(totalKb, availableKb) * 1024;
+    }
+
+    if (!pressurePath.empty()) {
+        s.hasPressure = readPressure(pressurePath, "some", s.someAvg10);
+        readPressure(pressurePath, "full", s.fullAvg10);
+    }
+    return s;
+}
+
+MemoryShedLevel MemoryGovernor::update(const MemoryGovernorSettings& settings) {
+    signals = sample();
+    MemoryShedLevel target = targetShedLevel(signals, settings);
+    auto now = std::chrono::steady_clock::now();
+    if (target >= level) {
+        level = target;
+        calmSince = now;
+    } else if (std::chrono::duration<float>(now - calmSince).count() >= settings.relaxSeconds) {
+        level = static_cast<MemoryShedLevel>(static_cast<int>(level) - 1);
+        calmSince = now;
+    }
+    return level;
+}
+
+std::string MemoryGovernor::describe() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (signals.hasLimit) {
+        out << (signals.fromCgroup ? "cgroup " : "RAM ") << signals.usageBytes / 1073741824.0 << " / "
+            << signals.limitBytes / 1073741824.0 << " GB (" << std::setprecision(0)
+            << signals.usageFraction() * 100.0f << "%)";
+    } else {
+        out << "no limit";
+    }
+    if (signals.hasPressure) {
+        out << std::setprecision(1) << ", PSI " << signals.someAvg10 << "%";
+    }
+    return out.str();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Memory use against the limit the process actually runs under, plus stall pressure
+struct MemorySignals {
+    bool hasLimit = false;
+    bool fromCgroup = false;   // Otherwise the machine's RAM (/proc/meminfo)
+    uint64_t limitBytes = 0;
+    uint64_t usageBytes = 0;   // Without reclaimable page cache (inactive files)
+    bool hasPressure = false;
+    float someAvg10 = 0.0f;    // PSI: % of the last 10 s in which some task stalled on memory
+    float fullAvg10 = 0.0f;    // PSI: % in which all tasks did
+
+    float usageFraction() const { return hasLimit && limitBytes > 0 ? static_cast<float>(usageBytes) / limitBytes : 0.0f; }
+};
+
+// What gets given up under pressure, cumulative: each level also sheds everything before it
+enum class MemoryShedLevel {
+    None,
+    ChunkCache,    // Unload the cached band between load and unload radius
+    CompactTiers,  // Drop heightfields of render-only chunks (regenerated if needed again)
+    CollisionSdf,  // Full SDFs only for the player's own chunk; the collision fallback covers the rest
+    LoadRadius,    // Load one chunk ring less
+    Count
+};
+
+const char* memoryShedLevelName(MemoryShedLevel level);
+
+struct MemoryGovernorSettings {
+    float usageStart = 0.75f;     // Fraction of the limit where shedding starts
+    float usageStep = 0.05f;      // Each further step of usage sheds one more level
+    float pressureStart = 5.0f;   // PSI some avg10 (%) where shedding starts; doubles per level
+    float relaxSeconds = 10.0f;   // Calm this long before a level is given back, one at a time
+};
+
+// Level the signals call for right now, without hysteresis
+MemoryShedLevel targetShedLevel(const MemorySignals& signals, const MemoryGovernorSettings& settings);
+
+// Reads the cgroup (v2 or v1) memory limit, usage and PSI. Falls back to /proc/meminfo and
+// /proc/pressure/memory when there is no cgroup limit. Main thread, about once a second.
+class MemoryGovernor {
+public:
+    MemoryGovernor();
+
+    // Samples the signals; the level rises at once and falls one step per relaxSeconds of calm
+    MemoryShedLevel update(const MemoryGovernorSettings& settings);
+
+    MemoryShedLevel getLevel() const { return level; }
+    const MemorySignals& getSignals() const { return signals; }
+
+    // e.g. "cgroup 1.4 / 4.0 GB (35%), PSI 0.2%"
+    std::string describe() const;
+
+    // Reads the signals without changing the level
+    MemorySignals sample() const;
+
+private:
+    std::string cgroupDir;       // Empty without a usable cgroup memory controller
+    bool cgroupV1 = false;
+    std::string pressurePath;    // The cgroup's memory.pressure, else /proc/pressure/memory
+
+    MemorySignals signals;
+    MemoryShedLevel level = MemoryShedLevel::None;
+    std::chrono::steady_clock::time_point calmSince;
+};
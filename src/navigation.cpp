@@ -0,0 +1,458 @@
+#include "navigation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+    constexpr float INF = std::numeric_limits<float>::max();
+
+    // Offsets to the 8 neighbouring cells
+    constexpr int NEIGHBOR_DX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    constexpr int NEIGHBOR_DZ[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+    int floorDiv(int a, int b) {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+
+    struct OpenEntry {
+        float f;
+        const ChunkNavGraph* graph;
+        uint32_t index;  // Node or region
+        bool operator>(const OpenEntry& other) const { return f > other.f; }
+    };
+    using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+
+    // Per-graph search state, allocated for the graphs a search touches
+    template<typename Info>
+    Info& searchInfo(std::unordered_map<const ChunkNavGraph*, std::vector<Info>>& state, const ChunkNavGraph* graph,
+                     uint32_t index, size_t count) {
+        std::vector<Info>& infos = state[graph];
+        if (infos.empty()) {
+            infos.resize(count);
+        }
+        return infos[index];
+    }
+}
+
+bool isWalkableSlope(glm::vec3 surfaceNormal, float maxSlopeDegrees) {
+    float slopeAngle = glm::degrees(std::acos(glm::clamp(glm::dot(surfaceNormal, glm::vec3(0, 1, 0)), -1.0f, 1.0f)));
+    return slopeAngle <= maxSlopeDegrees;
+}
+
+void buildChunkNavGraph(const VolumeChunk& chunk, const NavSettings& settings, ChunkNavGraph& graph) {
+    auto start = std::chrono::steady_clock::now();
+    graph.coord = chunk.coord;
+    graph.nodes.clear();
+    graph.edges.clear();
+    graph.links.clear();
+    graph.cellStart.assign(NAV_CELLS * NAV_CELLS + 1, 0);
+
+    glm::vec3 origin = chunkToWorldPos(chunk.coord);
+    int clearanceVoxels = static_cast<int>(std::ceil(settings.agentHeight / VOXEL_SIZE));
+
+    // Nodes: solid-below, air-above crossings at each cell centre with a walkable slope and
+    // room for the agent above
+    for (int cz = 0; cz < NAV_CELLS; cz++) {
+        for (int cx = 0; cx < NAV_CELLS; cx++) {
+            graph.cellStart[cz * NAV_CELLS + cx] = static_cast<uint32_t>(graph.nodes.size());
+            int vx = cx * NAV_CELL_VOXELS + NAV_CELL_VOXELS / 2;
+            int vz = cz * NAV_CELL_VOXELS + NAV_CELL_VOXELS / 2;
+            float below = chunk.sdfAt(vx, 0, vz);
+            for (int y = 0; y < CHUNK_CUBES; y++) {
+                float above = chunk.sdfAt(vx, y + 1, vz);
+                bool surface = below >= 0.0f && above < 0.0f;
+                float crossing = surface ? y + below / (below - above) : 0.0f;
+                below = above;
+                if (!surface) {
+                    continue;
+                }
+
+                int top = std::min(y + 1 + clearanceVoxels, CHUNK_CUBES);
+                bool clear = true;
+                for (int cy = y + 2; cy <= top && clear; cy++) {
+                    clear = chunk.sdfAt(vx, cy, vz) < 0.0f;
+                }
+                if (!clear) {
+                    continue;
+                }
+
+                int gy = std::clamp(static_cast<int>(crossing + 0.5f), 1, CHUNK_CUBES - 1);
+                glm::vec3 gradient(chunk.sdfAt(vx + 1, gy, vz) - chunk.sdfAt(vx - 1, gy, vz),
+                                   chunk.sdfAt(vx, gy + 1, vz) - chunk.sdfAt(vx, gy - 1, vz),
+                                   chunk.sdfAt(vx, gy, vz + 1) - chunk.sdfAt(vx, gy, vz - 1));
+                float length = glm::length(gradient);
+                if (length < 0.0001f || !isWalkableSlope(-gradient / length, settings.maxSlopeDegrees)) {
+                    continue;
+                }
+
+                NavNode node{};
+                node.position = origin + glm::vec3(vx, crossing, vz) * VOXEL_SIZE;
+                node.cellX = static_cast<uint8_t>(cx);
+                node.cellZ = static_cast<uint8_t>(cz);
+                graph.nodes.push_back(node);
+            }
+        }
+    }
+    graph.cellStart[NAV_CELLS * NAV_CELLS] = static_cast<uint32_t>(graph.nodes.size());
+
+    // Edges to every node of a neighbouring cell within a step
+    for (uint32_t i = 0; i < graph.nodes.size(); i++) {
+        NavNode& node = graph.nodes[i];
+        node.firstEdge = static_cast<uint32_t>(graph.edges.size());
+        for (int d = 0; d < 8; d++) {
+            int nx = node.cellX + NEIGHBOR_DX[d];
+            int nz = node.cellZ + NEIGHBOR_DZ[d];
+            if (nx < 0 || nx >= NAV_CELLS || nz < 0 || nz >= NAV_CELLS) {
+                continue;
+            }
+            int cell = nz * NAV_CELLS + nx;
+            for (uint32_t j = graph.cellStart[cell]; j < graph.cellStart[cell + 1]; j++) {
+                if (std::abs(graph.nodes[j].position.y - node.position.y) <= settings.maxStep) {
+                    graph.edges.push_back({j, glm::distance(node.position, graph.nodes[j].position)});
+                }
+            }
+        }
+        node.edgeCount = static_cast<uint16_t>(graph.edges.size() - node.firstEdge);
+    }
+
+    // Regions: connected components, the nodes of the hierarchical search
+    const uint16_t unassigned = std::numeric_limits<uint16_t>::max();
+    for (NavNode& node : graph.nodes) {
+        node.region = unassigned;
+    }
+    graph.regionCount = 0;
+    std::vector<uint32_t> stack;
+    for (uint32_t i = 0; i < graph.nodes.size(); i++) {
+        if (graph.nodes[i].region != unassigned) {
+            continue;
+        }
+        uint16_t region = graph.regionCount++;
+        graph.nodes[i].region = region;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            const NavNode& node = graph.nodes[stack.back()];
+            stack.pop_back();
+            for (uint32_t e = node.firstEdge; e < node.firstEdge + node.edgeCount; e++) {
+                NavNode& next = graph.nodes[graph.edges[e].target];
+                if (next.region == unassigned) {
+                    next.region = region;
+                    stack.push_back(graph.edges[e].target);
+                }
+            }
+        }
+    }
+
+    graph.buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void NavWorld::submit(std::unique_ptr<ChunkNavGraph> graph) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back(std::move(graph));
+}
+
+void NavWorld::update(const std::function<bool(ChunkCoord)>& keep) {
+    std::vector<std::unique_ptr<ChunkNavGraph>> ready;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        std::swap(ready, pending);
+    }
+    for (auto& graph : ready) {
+        if (keep(graph->coord)) {
+            addChunk(std::move(graph));
+        }
+    }
+}
+
+void NavWorld::addChunk(std::unique_ptr<ChunkNavGraph> graph) {
+    ChunkCoord coord = graph->coord;
+    removeChunk(coord);
+    ChunkNavGraph& added = *graph;
+    graphs[coord] = std::move(graph);
+
+    // Cells of any of the 26 surrounding chunks can be neighbours: slopes cross chunk tops too
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                auto it = graphs.find(ChunkCoord{coord.x + dx, coord.y + dy, coord.z + dz});
+                if ((dx != 0 || dy != 0 || dz != 0) && it != graphs.end()) {
+                    linkChunks(added, *it->second);
+                }
+            }
+        }
+    }
+}
+
+void NavWorld::linkChunks(ChunkNavGraph& a, ChunkNavGraph& b) {
+    for (uint32_t i = 0; i < a.nodes.size(); i++) {
+        const NavNode& node = a.nodes[i];
+        int worldX = a.coord.x * NAV_CELLS + node.cellX;
+        int worldZ = a.coord.z * NAV_CELLS + node.cellZ;
+        for (int d = 0; d < 8; d++) {
+            int nx = worldX + NEIGHBOR_DX[d];
+            int nz = worldZ + NEIGHBOR_DZ[d];
+            if (floorDiv(nx, NAV_CELLS) != b.coord.x || floorDiv(nz, NAV_CELLS) != b.coord.z) {
+                continue;
+            }
+            int cell = (nz - b.coord.z * NAV_CELLS) * NAV_CELLS + (nx - b.coord.x * NAV_CELLS);
+            for (uint32_t j = b.cellStart[cell]; j < b.cellStart[cell + 1]; j++) {
+                if (std::abs(b.nodes[j].position.y - node.position.y) <= settings.maxStep) {
+                    float cost = glm::distance(node.position, b.nodes[j].position);
+                    a.links.push_back({i, b.coord, j, cost});
+                    b.links.push_back({j, a.coord, i, cost});
+                }
+            }
+        }
+    }
+
+    // Searches look up a node's links by binary search
+    auto byNode = [](const NavLink& x, const NavLink& y) { return x.node < y.node; };
+    std::stable_sort(a.links.begin(), a.links.end(), byNode);
+    std::stable_sort(b.links.begin(), b.links.end(), byNode);
+}
+
+void NavWorld::removeChunk(ChunkCoord coord) {
+    auto it = graphs.find(coord);
+    if (it == graphs.end()) {
+        return;
+    }
+    for (const NavLink& link : it->second->links) {
+        auto neighbor = graphs.find(link.neighbor);
+        if (neighbor == graphs.end()) {
+            continue;
+        }
+        std::vector<NavLink>& links = neighbor->second->links;
+        links.erase(std::remove_if(links.begin(), links.end(),
+                                   [&](const NavLink& l) { return l.neighbor == coord; }),
+                    links.end());
+    }
+    graphs.erase(it);
+}
+
+void NavWorld::retainChunks(const std::function<bool(ChunkCoord)>& keep) {
+    std::vector<ChunkCoord> removed;
+    for (const auto& [coord, graph] : graphs) {
+        if (!keep(coord)) {
+            removed.push_back(coord);
+        }
+    }
+    for (ChunkCoord coord : removed) {
+        removeChunk(coord);
+    }
+}
+
+void NavWorld::clear() {
+    graphs.clear();
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.clear();
+}
+
+size_t NavWorld::nodeCount() const {
+    size_t count = 0;
+    for (const auto& [coord, graph] : graphs) {
+        count += graph->nodes.size();
+    }
+    return count;
+}
+
+size_t NavWorld::linkCount() const {
+    size_t count = 0;
+    for (const auto& [coord, graph] : graphs) {
+        count += graph->links.size();
+    }
+    return count / 2;
+}
+
+const ChunkNavGraph* NavWorld::findGraph(ChunkCoord coord) const {
+    auto it = graphs.find(coord);
+    return it != graphs.end() ? it->second.get() : nullptr;
+}
+
+bool NavWorld::nearestNode(glm::vec3 position, NodeRef& out) const {
+    // The surface under a point may be in the chunk below
+    ChunkCoord coord = worldToChunkCoord(position);
+    float bestDistSq = INF;
+    for (int dy = 0; dy >= -1; dy--) {
+        const ChunkNavGraph* graph = findGraph(ChunkCoord{coord.x, coord.y + dy, coord.z});
+        if (!graph) {
+            continue;
+        }
+        for (uint32_t i = 0; i < graph->nodes.size(); i++) {
+            glm::vec3 offset = graph->nodes[i].position - position;
+            float distSq = glm::dot(offset, offset);
+            if (distSq < bestDistSq) {
+                bestDistSq = distSq;
+                out = {graph, i};
+            }
+        }
+    }
+    return bestDistSq < INF;
+}
+
+bool NavWorld::findRegionCorridor(NodeRef start, NodeRef goal,
+                                  std::vector<std::pair<const ChunkNavGraph*, uint16_t>>& corridor,
+                                  NavPathStats* stats) const {
+    // Region costs are measured between the points where the route enters each region
+    struct RegionInfo {
+        float g = INF;
+        glm::vec3 entry{0.0f};
+        const ChunkNavGraph* parentGraph = nullptr;
+        uint16_t parentRegion = 0;
+        bool closed = false;
+    };
+    std::unordered_map<const ChunkNavGraph*, std::vector<RegionInfo>> state;
+    glm::vec3 goalPos = goal.graph->nodes[goal.node].position;
+    uint16_t goalRegion = goal.graph->nodes[goal.node].region;
+
+    uint16_t startRegion = start.graph->nodes[start.node].region;
+    RegionInfo& first = searchInfo(state, start.graph, startRegion, start.graph->regionCount);
+    first.g = 0.0f;
+    first.entry = start.graph->nodes[start.node].position;
+    OpenList open;
+    open.push({glm::distance(first.entry, goalPos), start.graph, startRegion});
+
+    while (!open.empty()) {
+        OpenEntry current = open.top();
+        open.pop();
+        const ChunkNavGraph* graph = current.graph;
+        uint16_t region = static_cast<uint16_t>(current.index);
+        RegionInfo& info = searchInfo(state, graph, region, graph->regionCount);
+        if (info.closed) {
+            continue;
+        }
+        info.closed = true;
+        if (stats) {
+            stats->regionsExpanded++;
+        }
+
+        if (graph == goal.graph && region == goalRegion) {
+            corridor.clear();
+            const ChunkNavGraph* g = graph;
+            uint16_t r = region;
+            while (g) {
+                corridor.push_back({g, r});
+                const RegionInfo& step = state[g][r];
+                g = step.parentGraph;
+                r = step.parentRegion;
+            }
+            return true;
+        }
+
+        for (const NavLink& link : graph->links) {
+            if (graph->nodes[link.node].region != region) {
+                continue;
+            }
+            const ChunkNavGraph* neighbor = findGraph(link.neighbor);
+            const NavNode& target = neighbor->nodes[link.neighborNode];
+            float g = info.g + glm::distance(info.entry, target.position);
+            RegionInfo& next = searchInfo(state, neighbor, target.region, neighbor->regionCount);
+            if (!next.closed && g < next.g) {
+                next.g = g;
+                next.entry = target.position;
+                next.parentGraph = graph;
+                next.parentRegion = region;
+                open.push({g + glm::distance(target.position, goalPos), neighbor, target.region});
+            }
+        }
+    }
+    return false;
+}
+
+template<typename Allowed>
+bool NavWorld::searchNodes(NodeRef start, NodeRef goal, Allowed allowed, std::vector<glm::vec3>& path,
+                           NavPathStats* stats) const {
+    struct NodeInfo {
+        float g = INF;
+        NodeRef parent{nullptr, 0};
+        bool closed = false;
+    };
+    std::unordered_map<const ChunkNavGraph*, std::vector<NodeInfo>> state;
+    glm::vec3 goalPos = goal.graph->nodes[goal.node].position;
+
+    searchInfo(state, start.graph, start.node, start.graph->nodes.size()).g = 0.0f;
+    OpenList open;
+    open.push({glm::distance(start.graph->nodes[start.node].position, goalPos), start.graph, start.node});
+
+    auto relax = [&](const NodeRef& from, float fromG, const ChunkNavGraph* graph, uint32_t node, float cost) {
+        const NavNode& target = graph->nodes[node];
+        if (!allowed(*graph, target.region)) {
+            return;
+        }
+        NodeInfo& next = searchInfo(state, graph, node, graph->nodes.size());
+        float g = fromG + cost;
+        if (!next.closed && g < next.g) {
+            next.g = g;
+            next.parent = from;
+            open.push({g + glm::distance(target.position, goalPos), graph, node});
+        }
+    };
+
+    while (!open.empty()) {
+        OpenEntry current = open.top();
+        open.pop();
+        NodeRef ref{current.graph, current.index};
+        NodeInfo& info = searchInfo(state, ref.graph, ref.node, ref.graph->nodes.size());
+        if (info.closed) {
+            continue;
+        }
+        info.closed = true;
+        if (stats) {
+            stats->nodesExpanded++;
+        }
+
+        if (ref.graph == goal.graph && ref.node == goal.node) {
+            path.clear();
+            for (NodeRef step = ref; step.graph; step = state[step.graph][step.node].parent) {
+                path.push_back(step.graph->nodes[step.node].position);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        const NavNode& node = ref.graph->nodes[ref.node];
+        float g = info.g;
+        for (uint32_t e = node.firstEdge; e < node.firstEdge + node.edgeCount; e++) {
+            relax(ref, g, ref.graph, ref.graph->edges[e].target, ref.graph->edges[e].cost);
+        }
+        const std::vector<NavLink>& links = ref.graph->links;
+        auto link = std::lower_bound(links.begin(), links.end(), ref.node,
+                                     [](const NavLink& l, uint32_t n) { return l.node < n; });
+        for (; link != links.end() && link->node == ref.node; ++link) {
+            relax(ref, g, findGraph(link->neighbor), link->neighborNode, link->cost);
+        }
+    }
+    return false;
+}
+
+bool NavWorld::findPath(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3>& path, NavPathStats* stats) const {
+    NodeRef startNode{nullptr, 0};
+    NodeRef goalNode{nullptr, 0};
+    if (!nearestNode(start, startNode) || !nearestNode(goal, goalNode)) {
+        return false;
+    }
+
+    std::vector<std::pair<const ChunkNavGraph*, uint16_t>> corridor;
+    if (!findRegionCorridor(startNode, goalNode, corridor, stats)) {
+        return false;
+    }
+    // Corridor regions are few, a linear scan beats hashing
+    auto inCorridor = [&corridor](const ChunkNavGraph& graph, uint16_t region) {
+        for (const auto& [g, r] : corridor) {
+            if (g == &graph && r == region) {
+                return true;
+            }
+        }
+        return false;
+    };
+    return searchNodes(startNode, goalNode, inCorridor, path, stats);
+}
+
+bool NavWorld::findPathFlat(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3>& path, NavPathStats* stats) const {
+    NodeRef startNode{nullptr, 0};
+    NodeRef goalNode{nullptr, 0};
+    if (!nearestNode(start, startNode) || !nearestNode(goal, goalNode)) {
+        return false;
+    }
+    return searchNodes(startNode, goalNode, [](const ChunkNavGraph&, uint16_t) { return true; }, path, stats);
+}
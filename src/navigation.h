@@ -0,0 +1,118 @@
+#pragma once
+
+#include "chunk.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// The player controller's rule (Camera::updatePhysics), shared so agents and the player agree
+bool isWalkableSlope(glm::vec3 surfaceNormal, float maxSlopeDegrees);
+
+struct NavSettings {
+    float maxSlopeDegrees = 50.0f;  // Camera::maxWalkableSlope
+    float agentHeight = 1.8f;       // Air needed above a walkable surface
+    float maxStep = 0.75f;          // Largest height change between neighbouring cells
+};
+
+constexpr int NAV_CELL_VOXELS = 2;                        // 1 m cells
+constexpr int NAV_CELLS = CHUNK_CUBES / NAV_CELL_VOXELS;  // Cells per chunk side
+
+// A walkable spot: one per surface layer (ground, cave floors) of a 1 m cell column
+struct NavNode {
+    glm::vec3 position;   // World space, on the surface
+    uint32_t firstEdge;   // Into ChunkNavGraph::edges
+    uint16_t edgeCount;
+    uint16_t region;      // Connected component within the chunk
+    uint8_t cellX;
+    uint8_t cellZ;
+};
+
+struct NavEdge {
+    uint32_t target;
+    float cost;
+};
+
+// Edge to a node in a neighbouring chunk, added when both chunks are in the NavWorld
+struct NavLink {
+    uint32_t node;
+    ChunkCoord neighbor;
+    uint32_t neighborNode;
+    float cost;
+};
+
+struct ChunkNavGraph {
+    ChunkCoord coord;
+    std::vector<NavNode> nodes;           // Sorted by cell, cellX fastest
+    std::vector<NavEdge> edges;           // Inside the chunk
+    std::vector<uint32_t> cellStart;      // Nodes of cell (x, z): cellStart[i] .. cellStart[i + 1], i = z * NAV_CELLS + x
+    std::vector<NavLink> links;           // Maintained by NavWorld, sorted by node
+    uint16_t regionCount = 0;
+    float buildMs = 0.0f;
+};
+
+// Walkable surface graph of one chunk from its SDF (full grid or heightfield). Air above the
+// chunk's top counts as clearance, so agents may walk under overhangs of the chunk above.
+// Any thread; the chunk's SDF must stay alive while this runs.
+void buildChunkNavGraph(const VolumeChunk& chunk, const NavSettings& settings, ChunkNavGraph& graph);
+
+struct NavPathStats {
+    uint32_t regionsExpanded = 0;
+    uint32_t nodesExpanded = 0;
+};
+
+// Per-chunk graphs stitched across chunk borders. Path queries run A* over chunk regions
+// first (connected components, joined where border links cross) and then over nodes of
+// the region corridor only, so long paths don't search every node in between.
+class NavWorld {
+public:
+    explicit NavWorld(const NavSettings& settings = NavSettings()) : settings(settings) {}
+
+    const NavSettings& getSettings() const { return settings; }
+
+    // Thread-safe: hand over a graph built on a worker; it is linked in on the next update()
+    void submit(std::unique_ptr<ChunkNavGraph> graph);
+    // Links in submitted graphs. Those of chunks `keep` rejects (unloaded since the worker
+    // started) are dropped, as retainChunks would only remove them on its next pass.
+    void update(const std::function<bool(ChunkCoord)>& keep);
+
+    // Replaces any graph the chunk already had
+    void addChunk(std::unique_ptr<ChunkNavGraph> graph);
+    void removeChunk(ChunkCoord coord);
+    // Drop graphs of chunks `keep` rejects (unloaded ones)
+    void retainChunks(const std::function<bool(ChunkCoord)>& keep);
+    void clear();
+
+    // Start and goal snap to the nearest node in their chunk. Fills `path` with node positions.
+    bool findPath(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3>& path, NavPathStats* stats = nullptr) const;
+    // Plain A* over every node, for comparison
+    bool findPathFlat(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3>& path, NavPathStats* stats = nullptr) const;
+
+    size_t chunkCount() const { return graphs.size(); }
+    size_t nodeCount() const;
+    size_t linkCount() const;
+
+private:
+    struct NodeRef {
+        const ChunkNavGraph* graph;
+        uint32_t node;
+    };
+
+    NavSettings settings;
+    std::unordered_map<ChunkCoord, std::unique_ptr<ChunkNavGraph>> graphs;
+    std::mutex pendingMutex;
+    std::vector<std::unique_ptr<ChunkNavGraph>> pending;
+
+    void linkChunks(ChunkNavGraph& a, ChunkNavGraph& b);
+    const ChunkNavGraph* findGraph(ChunkCoord coord) const;
+    bool nearestNode(glm::vec3 position, NodeRef& out) const;
+    // Regions along the cheapest region-level route from start to goal, as (graph, region)
+    bool findRegionCorridor(NodeRef start, NodeRef goal, std::vector<std::pair<const ChunkNavGraph*, uint16_t>>& corridor,
+                            NavPathStats* stats) const;
+    // A* over nodes whose (graph, region) passes `allowed`
+    template<typename Allowed>
+    bool searchNodes(NodeRef start, NodeRef goal, Allowed allowed, std::vector<glm::vec3>& path, NavPathStats* stats) const;
+};
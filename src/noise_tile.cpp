@@ -0,0 +1,234 @@
+#include "noise_tile.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    constexpr char TILE_MAGIC[4] = {'N', 'T', 'I', 'L'};
+    constexpr uint32_t TILE_VERSION = 1;
+    constexpr int MAX_ROW_CELLS = 64;
+    constexpr int PROBE_COUNT = 4;
+
+    // A few fixed probe points identify the noise configuration a tile was baked from
+    constexpr float PROBE_POINTS[PROBE_COUNT][3] = {
+        {12.3f, 45.6f, 78.9f}, {-301.7f, 8.2f, 144.4f}, {999.1f, -512.5f, -33.3f}, {0.5f, 0.25f, 0.125f}
+    };
+
+    struct TileHeader {
+        char magic[4];
+        uint32_t version;
+        int32_t resolution;
+        float period;
+        float probes[PROBE_COUNT];
+    };
+
+    void computeProbes(const FastNoiseLite& noise, float* probes) {
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            probes[i] = noise.GetNoise(PROBE_POINTS[i][0], PROBE_POINTS[i][1], PROBE_POINTS[i][2]);
+        }
+    }
+
+    // Smooth cross-fade weight for the unshifted copy of the field
+    float fadeWeight(float t) {
+        float s = t * t * (3.0f - 2.0f * t);
+        return 1.0f - s;
+    }
+}
+
+void NoiseTile::bake(const FastNoiseLite& noise, int newResolution, float newPeriod) {
+    if (newResolution <= 0 || (newResolution & (newResolution - 1)) != 0) {
+        throw std::runtime_error("Noise tile resolution must be a power of two!");
+    }
+
+    resolution = newResolution;
+    mask = resolution - 1;
+    period = newPeriod;
+    cellsPerUnit = resolution / period;
+    values.assign(static_cast<size_t>(resolution) * resolution * resolution, 0.0f);
+    computeProbes(noise, probes);
+
+    const float cellSize = period / resolution;
+    for (int ix = 0; ix < resolution; ix++) {
+        for (int iy = 0; iy < resolution; iy++) {
+            for (int iz = 0; iz < resolution; iz++) {
+                float px = ix * cellSize;
+                float py = iy * cellSize;
+                float pz = iz * cellSize;
+                float wx[2] = {fadeWeight(static_cast<float>(ix) / resolution), 0.0f};
+                float wy[2] = {fadeWeight(static_cast<float>(iy) / resolution), 0.0f};
+                float wz[2] = {fadeWeight(static_cast<float>(iz) / resolution), 0.0f};
+                wx[1] = 1.0f - wx[0];
+                wy[1] = 1.0f - wy[0];
+                wz[1] = 1.0f - wz[0];
+
+                // Blend the 8 period-shifted copies. Normalising by the weight norm keeps
+                // the variance of (uncorrelated) noise constant instead of washing out
+                // contrast in the middle of the tile.
+                float sum = 0.0f;
+                float weightSq = 0.0f;
+                for (int c = 0; c < 8; c++) {
+                    int cx = c & 1;
+                    int cy = (c >> 1) & 1;
+                    int cz = (c >> 2) & 1;
+                    float w = wx[cx] * wy[cy] * wz[cz];
+                    if (w <= 0.0f) {
+                        continue;
+                    }
+                    sum += w * noise.GetNoise(px - cx * period, py - cy * period, pz - cz * period);
+                    weightSq += w * w;
+                }
+                values[(static_cast<size_t>(ix) * resolution + iy) * resolution + iz] = sum / std::sqrt(weightSq);
+            }
+        }
+    }
+}
+
+bool NoiseTile::load(const std::string& path, const FastNoiseLite& noise, int expectedResolution, float expectedPeriod) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    TileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC)) != 0 ||
+        header.version != TILE_VERSION || header.resolution != expectedResolution ||
+        header.period != expectedPeriod) {
+        return false;
+    }
+
+    float currentProbes[PROBE_COUNT];
+    computeProbes(noise, currentProbes);
+    if (std::memcmp(currentProbes, header.probes, sizeof(currentProbes)) != 0) {
+        std::cout << "Noise tile " << path << " was baked from different noise settings, rebaking" << std::endl;
+        return false;
+    }
+
+    std::vector<float> loaded(static_cast<size_t>(expectedResolution) * expectedResolution * expectedResolution);
+    file.read(reinterpret_cast<char*>(loaded.data()), loaded.size() * sizeof(float));
+    if (!file) {
+        return false;
+    }
+
+    resolution = expectedResolution;
+    mask = resolution - 1;
+    period = expectedPeriod;
+    cellsPerUnit = resolution / period;
+    values = std::move(loaded);
+    std::memcpy(probes, currentProbes, sizeof(probes));
+    return true;
+}
+
+bool NoiseTile::save(const std::string& path) const {
+    if (!isReady()) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    TileHeader header{};
+    std::memcpy(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC));
+    header.version = TILE_VERSION;
+    header.resolution = resolution;
+    header.period = period;
+    std::memcpy(header.probes, probes, sizeof(probes));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    return static_cast<bool>(file);
+}
+
+float NoiseTile::sample(float x, float y, float z) const {
+    float u = x * cellsPerUnit;
+    float v = y * cellsPerUnit;
+    float w = z * cellsPerUnit;
+    float fu = std::floor(u);
+    float fv = std::floor(v);
+    float fw = std::floor(w);
+    int x0 = static_cast<int>(fu) & mask;
+    int y0 = static_cast<int>(fv) & mask;
+    int z0 = static_cast<int>(fw) & mask;
+    int x1 = (x0 + 1) & mask;
+    int y1 = (y0 + 1) & mask;
+    int z1 = (z0 + 1) & mask;
+    float tx = u - fu;
+    float ty = v - fv;
+    float tz = w - fw;
+
+    const float* l00 = line(x0, y0);
+    const float* l10 = line(x1, y0);
+    const float* l01 = line(x0, y1);
+    const float* l11 = line(x1, y1);
+
+    float c00 = l00[z0] + (l10[z0] - l00[z0]) * tx;
+    float c01 = l00[z1] + (l10[z1] - l00[z1]) * tx;
+    float c10 = l01[z0] + (l11[z0] - l01[z0]) * tx;
+    float c11 = l01[z1] + (l11[z1] - l01[z1]) * tx;
+    float c0 = c00 + (c10 - c00) * ty;
+    float c1 = c01 + (c11 - c01) * ty;
+    return c0 + (c1 - c0) * tz;
+}
+
+void NoiseTile::sampleRow(float x, float y, const float* zs, float zScale, int count, float* out) const {
+    if (count <= 0) {
+        return;
+    }
+
+    // Cell range covered by this row along z
+    float zMin = zs[0] * zScale;
+    float zMax = zMin;
+    for (int i = 1; i < count; i++) {
+        float z = zs[i] * zScale;
+        zMin = std::min(zMin, z);
+        zMax = std::max(zMax, z);
+    }
+    int cellStart = static_cast<int>(std::floor(zMin * cellsPerUnit));
+    int cellEnd = static_cast<int>(std::floor(zMax * cellsPerUnit)) + 1;
+    int cellCount = cellEnd - cellStart + 1;
+    if (cellCount > MAX_ROW_CELLS) {
+        for (int i = 0; i < count; i++) {
+            out[i] = sample(x, y, zs[i] * zScale);
+        }
+        return;
+    }
+
+    float u = x * cellsPerUnit;
+    float v = y * cellsPerUnit;
+    float fu = std::floor(u);
+    float fv = std::floor(v);
+    int x0 = static_cast<int>(fu) & mask;
+    int y0 = static_cast<int>(fv) & mask;
+    int x1 = (x0 + 1) & mask;
+    int y1 = (y0 + 1) & mask;
+    float tx = u - fu;
+    float ty = v - fv;
+
+    const float* l00 = line(x0, y0);
+    const float* l10 = line(x1, y0);
+    const float* l01 = line(x0, y1);
+    const float* l11 = line(x1, y1);
+
+    // Collapse the xy interpolation into a short 1D line covering the row
+    float collapsed[MAX_ROW_CELLS];
+    for (int k = 0; k < cellCount; k++) {
+        int z = (cellStart + k) & mask;
+        float c0 = l00[z] + (l10[z] - l00[z]) * tx;
+        float c1 = l01[z] + (l11[z] - l01[z]) * tx;
+        collapsed[k] = c0 + (c1 - c0) * ty;
+    }
+
+    // Offsets from cellStart are never negative, so truncation is floor here
+    const float origin = static_cast<float>(cellStart);
+    for (int i = 0; i < count; i++) {
+        float w = zs[i] * zScale * cellsPerUnit - origin;
+        int k = std::min(static_cast<int>(w), cellCount - 2);
+        float tz = w - k;
+        out[i] = collapsed[k] + (collapsed[k + 1] - collapsed[k]) * tz;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <FastNoiseLite.h>
+#include <string>
+#include <vector>
+
+// Periodic 3D table of a noise field, sampled with trilinear interpolation.
+// Trades memory for compute on low-frequency fields: one table lookup instead of
+// several octaves of procedural noise per sample.
+class NoiseTile {
+public:
+    // Bake resolution^3 samples (power of two) covering `period` world units per axis.
+    // The field is cross-faded against its shifted copies so it wraps seamlessly.
+    void bake(const FastNoiseLite& noise, int resolution, float period);
+
+    // Binary cache on disk. load() rejects files baked with different parameters or
+    // from a differently configured noise generator.
+    bool load(const std::string& path, const FastNoiseLite& noise, int resolution, float period);
+    bool save(const std::string& path) const;
+
+    bool isReady() const { return !values.empty(); }
+    size_t memoryBytes() const { return values.size() * sizeof(float); }
+    int getResolution() const { return resolution; }
+    float getPeriod() const { return period; }
+
+    float sample(float x, float y, float z) const;
+
+    // Sample `count` points sharing x and y, at z = zs[i] * zScale.
+    // The xy interpolation is done once per row over a whole z-line of the table,
+    // which is a contiguous loop the compiler vectorises; the per-sample work is a 1D lerp.
+    void sampleRow(float x, float y, const float* zs, float zScale, int count, float* out) const;
+
+private:
+    // Noise values at fixed probe points, identifying the generator settings baked in
+    static constexpr int PROBE_COUNT = 4;
+    float probes[PROBE_COUNT] = {};
+
+    int resolution = 0;
+    int mask = 0;
+    float period = 0.0f;
+    float cellsPerUnit = 0.0f;
+    std::vector<float> values;  // [x][y][z], z fastest
+
+    const float* line(int x, int y) const { return &values[(static_cast<size_t>(x) * resolution + y) * resolution]; }
+};
@@ -0,0 +1,53 @@
+#include "occlusion.h"
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProj) {
+    // Rows of the (column-major) matrix
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];  // Left
+    frustum.planes[1] = rows[3] - rows[0];  // Right
+    frustum.planes[2] = rows[3] + rows[1];  // Bottom
+    frustum.planes[3] = rows[3] - rows[1];  // Top
+    frustum.planes[4] = rows[2];            // Near (clip z >= 0)
+    frustum.planes[5] = rows[3] - rows[2];  // Far
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersectsBox(glm::vec3 boxMin, glm::vec3 boxMax) const {
+    for (const glm::vec4& plane : planes) {
+        // Box corner furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+                         plane.y >= 0.0f ? boxMax.y : boxMin.y,
+                         plane.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OcclusionAction chooseOcclusionAction(const ChunkVisibility& visibility, uint64_t frame, uint32_t jitter,
+                                      const OcclusionSettings& settings) {
+    if (visibility.occludedStreak >= static_cast<uint32_t>(settings.hideAfterFrames)) {
+        return OcclusionAction::QueryBox;
+    }
+    if (visibility.occludedStreak > 0) {
+        return OcclusionAction::DrawAndQuery;
+    }
+    uint64_t interval = static_cast<uint64_t>(settings.visibleRequeryInterval);
+    if (interval <= 1 || (frame + jitter) % interval == 0) {
+        return OcclusionAction::DrawAndQuery;
+    }
+    return OcclusionAction::Draw;
+}
+
+void recordOcclusionResult(ChunkVisibility& visibility, bool visible) {
+    visibility.occludedStreak = visible ? 0 : visibility.occludedStreak + 1;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// View frustum as six inward-facing planes (xyz = normal, w = offset)
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // From a Vulkan-style (depth 0..1) projection * view matrix
+    static Frustum fromMatrix(const glm::mat4& viewProj);
+
+    bool intersectsBox(glm::vec3 boxMin, glm::vec3 boxMax) const;
+};
+
+// Temporal occlusion history of one chunk (render thread only)
+struct ChunkVisibility {
+    uint32_t occludedStreak = 0;  // Consecutive query results with no samples passing
+};
+
+struct OcclusionSettings {
+    int hideAfterFrames = 3;          // Occluded results in a row before a chunk stops drawing
+    int visibleRequeryInterval = 8;   // Frames between re-tests of chunks that are drawn
+};
+
+enum class OcclusionAction {
+    Draw,           // Draw, no query this frame
+    DrawAndQuery,   // Draw inside a query: the chunk's own mesh is tested
+    QueryBox,       // Hidden: only its bounding box is tested against the depth buffer
+};
+
+// CHC++-style choice for a chunk inside the frustum. Drawn chunks are re-tested every few
+// frames (staggered by `jitter`) and every frame once a test has failed; a chunk is only
+// hidden after hideAfterFrames failed tests, and hidden chunks are re-tested every frame.
+OcclusionAction chooseOcclusionAction(const ChunkVisibility& visibility, uint64_t frame, uint32_t jitter,
+                                      const OcclusionSettings& settings);
+
+// Results arrive a few frames after the query was issued, in issue order
+void recordOcclusionResult(ChunkVisibility& visibility, bool visible);
@@ -0,0 +1,327 @@
+#include "sampling_profiler.h"
+
+// Only compiled into the app with ENABLE_SAMPLING_PROFILER (see CMakeLists.txt)
+#ifdef ENABLE_SAMPLING_PROFILER
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// Older glibc only has the raw union member
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+    constexpr int MAX_FRAMES = 48;
+    constexpr uint32_t RING_SAMPLES = 2048;  // About 2 s at 1 kHz between drains
+
+    struct StackSample {
+        uint32_t depth;
+        uintptr_t frames[MAX_FRAMES];  // Leaf first: the interrupted pc, then return addresses
+    };
+
+    struct ThreadSampler {
+        std::string name;
+        timer_t timer{};
+        bool timerActive = false;
+        uintptr_t stackLow = 0;   // Frame pointers outside [stackLow, stackHigh) end the walk
+        uintptr_t stackHigh = 0;
+
+        // Single producer (the signal handler on this thread), single consumer (the drain).
+        // Only allocated while a thread is registered.
+        std::unique_ptr<StackSample[]> ring;
+        std::atomic<uint32_t> head{0};
+        std::atomic<uint32_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+
+        std::map<std::vector<uintptr_t>, uint64_t> stacks;  // Drained totals
+        uint64_t samples = 0;
+    };
+
+    // Samplers live until exit, so a late signal never sees a freed one. A thread that
+    // unregisters leaves its sampler (totals only) to the next thread of the same name.
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadSampler>> samplers;
+    int samplingHz = 0;
+    bool started = false;
+
+    // Constant-initialised, so reading it in the handler touches no lazy TLS machinery
+    thread_local ThreadSampler* currentSampler = nullptr;
+
+    void getContextRegisters(const ucontext_t* context, uintptr_t& pc, uintptr_t& fp) {
+#if defined(__x86_64__)
+        pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+        fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+        pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+        fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+#else
+#error "Sampling profiler: unsupported architecture"
+#endif
+    }
+
+    // Async-signal-safe: only this thread's ring and atomics
+    void onSigprof(int, siginfo_t*, void* context) {
+        ThreadSampler* sampler = currentSampler;
+        if (!sampler) {
+            return;
+        }
+        int savedErrno = errno;
+        uint32_t head = sampler->head.load(std::memory_order_relaxed);
+        if (head - sampler->tail.load(std::memory_order_acquire) >= RING_SAMPLES) {
+            sampler->dropped.fetch_add(1, std::memory_order_relaxed);
+            errno = savedErrno;
+            return;
+        }
+
+        StackSample& sample = sampler->ring[head % RING_SAMPLES];
+        uintptr_t pc = 0;
+        uintptr_t fp = 0;
+        getContextRegisters(static_cast<const ucontext_t*>(context), pc, fp);
+        sample.frames[0] = pc;
+        uint32_t depth = 1;
+
+        // Each frame record is {caller's frame pointer, return address}. Code built without frame
+        // pointers (libc, drivers) breaks the chain; the checks stop the walk rather than crash.
+        while (depth < MAX_FRAMES && fp >= sampler->stackLow && fp + 2 * sizeof(uintptr_t) <= sampler->stackHigh &&
+               fp % sizeof(uintptr_t) == 0) {
+            const uintptr_t* record = reinterpret_cast<const uintptr_t*>(fp);
+            uintptr_t next = record[0];
+            uintptr_t returnAddress = record[1];
+            if (returnAddress == 0) {
+                break;
+            }
+            sample.frames[depth++] = returnAddress;
+            if (next <= fp) {
+                break;
+            }
+            fp = next;
+        }
+        sample.depth = depth;
+        sampler->head.store(head + 1, std::memory_order_release);
+        errno = savedErrno;
+    }
+
+    void armTimer(ThreadSampler& sampler, int hz) {
+        itimerspec spec{};
+        if (hz > 0) {
+            long intervalNs = 1000000000L / hz;
+            spec.it_interval.tv_sec = intervalNs / 1000000000L;
+            spec.it_interval.tv_nsec = intervalNs % 1000000000L;
+            spec.it_value = spec.it_interval;
+        }
+        timer_settime(sampler.timer, 0, &spec, nullptr);
+    }
+
+    // Call with registryMutex held
+    void drainSampler(ThreadSampler& sampler) {
+        if (!sampler.ring) {
+            return;
+        }
+        std::vector<uintptr_t> stack;
+        uint32_t head = sampler.head.load(std::memory_order_acquire);
+        uint32_t tail = sampler.tail.load(std::memory_order_relaxed);
+        for (; tail != head; tail++) {
+            const StackSample& sample = sampler.ring[tail % RING_SAMPLES];
+            stack.assign(sample.frames, sample.frames + sample.depth);
+            sampler.stacks[stack]++;
+            sampler.samples++;
+        }
+        sampler.tail.store(tail, std::memory_order_release);
+    }
+
+    void drainLocked() {
+        for (auto& sampler : samplers) {
+            drainSampler(*sampler);
+        }
+    }
+
+    // Function name if the address is in an exported symbol (the app links with -rdynamic),
+    // else module+offset for addr2line
+    std::string symbolName(uintptr_t address) {
+        Dl_info info{};
+        if (!dladdr(reinterpret_cast<void*>(address), &info)) {
+            std::ostringstream out;
+            out << "0x" << std::hex << address;
+            return out.str();
+        }
+        if (info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+        std::string module = info.dli_fname ? info.dli_fname : "?";
+        std::ostringstream out;
+        out << module.substr(module.find_last_of('/') + 1) << "+0x" << std::hex
+            << address - reinterpret_cast<uintptr_t>(info.dli_fbase);
+        return out.str();
+    }
+}
+
+void startSamplingProfiler(int hz) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    samplingHz = hz;
+    if (started) {
+        return;
+    }
+    struct sigaction action{};
+    action.sa_sigaction = onSigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        std::cout << "[profiler] Could not install the SIGPROF handler" << std::endl;
+        return;
+    }
+    started = true;
+    std::cout << "[profiler] Sampling at " << hz << " Hz" << std::endl;
+}
+
+void registerProfiledThread(const char* name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!started || currentSampler) {
+        return;
+    }
+    ThreadSampler* sampler = nullptr;
+    for (auto& idle : samplers) {
+        if (!idle->ring && idle->name == name) {
+            sampler = idle.get();
+            break;
+        }
+    }
+    if (!sampler) {
+        samplers.push_back(std::make_unique<ThreadSampler>());
+        sampler = samplers.back().get();
+        sampler->name = name;
+    }
+    sampler->ring.reset(new StackSample[RING_SAMPLES]);
+
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void* stackAddr = nullptr;
+        size_t stackSize = 0;
+        if (pthread_attr_getstack(&attr, &stackAddr, &stackSize) == 0) {
+            sampler->stackLow = reinterpret_cast<uintptr_t>(stackAddr);
+            sampler->stackHigh = sampler->stackLow + stackSize;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &sampler->timer) != 0) {
+        std::cout << "[profiler] timer_create failed for thread '" << name << "'" << std::endl;
+        sampler->ring.reset();
+        return;
+    }
+    sampler->timerActive = true;
+    currentSampler = sampler;
+    armTimer(*sampler, samplingHz);
+}
+
+void unregisterProfiledThread() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ThreadSampler* sampler = currentSampler;
+    if (!sampler) {
+        return;
+    }
+    if (sampler->timerActive) {
+        timer_delete(sampler->timer);
+        sampler->timerActive = false;
+    }
+    currentSampler = nullptr;
+    // No signal can reach the ring any more: keep what it holds, then free it
+    drainSampler(*sampler);
+    sampler->ring.reset();
+}
+
+void setSamplingRate(int hz) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    samplingHz = hz;
+    for (auto& sampler : samplers) {
+        if (sampler->timerActive) {
+            armTimer(*sampler, hz);
+        }
+    }
+}
+
+void drainSamplingProfiler() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    drainLocked();
+}
+
+void stopSamplingProfiler(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!started) {
+        return;
+    }
+    for (auto& sampler : samplers) {
+        if (sampler->timerActive) {
+            timer_delete(sampler->timer);
+            sampler->timerActive = false;
+        }
+    }
+    signal(SIGPROF, SIG_IGN);
+    started = false;
+    drainLocked();
+
+    // Fold per thread name; return addresses are looked up one byte back, inside the call
+    std::map<std::string, std::map<std::string, uint64_t>> folded;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> totals;  // Samples, dropped
+    std::unordered_map<uintptr_t, std::string> names;
+    for (const auto& sampler : samplers) {
+        auto& lines = folded[sampler->name];
+        totals[sampler->name].first += sampler->samples;
+        totals[sampler->name].second += sampler->dropped.load();
+        for (const auto& [stack, count] : sampler->stacks) {
+            std::string line = sampler->name;
+            for (size_t i = stack.size(); i-- > 0;) {
+                uintptr_t address = i == 0 ? stack[i] : stack[i] - 1;
+                auto it = names.find(address);
+                if (it == names.end()) {
+                    it = names.emplace(address, symbolName(address)).first;
+                }
+                line += ';';
+                line += it->second;
+            }
+            lines[line] += count;
+        }
+    }
+
+    for (const auto& [name, lines] : folded) {
+        std::string path = directory + "/profile_" + name + ".folded";
+        std::ofstream file(path);
+        if (!file) {
+            std::cout << "[profiler] Could not write " << path << std::endl;
+            continue;
+        }
+        for (const auto& [line, count] : lines) {
+            file << line << ' ' << count << '\n';
+        }
+        std::cout << "[profiler] " << totals[name].first << " samples (" << totals[name].second
+                  << " dropped) -> " << path << std::endl;
+    }
+}
+
+#endif  // ENABLE_SAMPLING_PROFILER
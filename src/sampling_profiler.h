@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+// Sampling profiler for what scoped timers don't cover. Every registered thread gets its own
+// CPU-time timer (timer_create) that raises SIGPROF on it; the handler walks the frame
+// pointers into that thread's lock-free ring. Samples are folded per thread name
+// ("main", "generation", "io") and written as flamegraph input on stop.
+//
+// Built in with the CMake option ENABLE_SAMPLING_PROFILER (Linux only, adds
+// -fno-omit-frame-pointer); otherwise every call below is a no-op.
+#ifdef ENABLE_SAMPLING_PROFILER
+
+// Installs the SIGPROF handler. `hz` applies to threads registered from now on; 0 = paused.
+void startSamplingProfiler(int hz);
+
+// Call on the thread itself. Threads with the same name share an output file.
+void registerProfiledThread(const char* name);
+void unregisterProfiledThread();
+
+// Rearms every registered thread's timer
+void setSamplingRate(int hz);
+
+// Moves samples out of the rings before they fill up. Call about once a second, from one thread.
+void drainSamplingProfiler();
+
+// Stops every timer and writes <directory>/profile_<name>.folded per thread name
+// ("frame;frame;frame count" lines, root first, for flamegraph.pl or speedscope)
+void stopSamplingProfiler(const std::string& directory);
+
+#else
+
+inline void startSamplingProfiler(int) {}
+inline void registerProfiledThread(const char*) {}
+inline void unregisterProfiledThread() {}
+inline void setSamplingRate(int) {}
+inline void drainSamplingProfiler() {}
+inline void stopSamplingProfiler(const std::string&) {}
+
+#endif
@@ -0,0 +1,184 @@
+#include "scatter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr int PATTERN_POINTS = 48;       // Candidate columns per chunk footprint (16 m x 16 m)
+    constexpr int CANDIDATES_PER_POINT = 8;  // Best-candidate tries per point already placed
+    constexpr float PROP_DENSITY = 0.6f;     // Fraction of surface candidates that get a prop
+    constexpr float MIN_UP = 0.6f;           // Steeper surfaces (normal.y below this) stay bare
+    constexpr float SHRUB_MIN_UP = 0.85f;    // Shrubs only grow on gentle slopes
+    constexpr float SHRUB_FRACTION = 0.7f;   // Of the candidates where shrubs can grow
+
+    uint32_t hashInts(uint32_t a, uint32_t b) {
+        uint32_t h = a * 0x9e3779b1u ^ (b + 0x7f4a7c15u + (a << 6) + (a >> 2));
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    float hashUnit(uint32_t h) {
+        return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint16_t toUnorm16(float value) {
+        return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    // Mitchell's best candidate on the unit torus: each point is the try farthest from all
+    // earlier ones. Distances wrap and every column uses the pattern unshifted, so the
+    // spacing holds across chunk edges too.
+    std::vector<glm::vec2> makeBlueNoisePattern() {
+        std::vector<glm::vec2> points;
+        uint32_t state = 12345u;
+        auto next = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return hashUnit(state);
+        };
+
+        for (int i = 0; i < PATTERN_POINTS; i++) {
+            glm::vec2 best(0.0f);
+            float bestDistSq = -1.0f;
+            for (int t = 0; t < i * CANDIDATES_PER_POINT + 1; t++) {
+                glm::vec2 candidate(next(), next());
+                float nearestSq = std::numeric_limits<float>::max();
+                for (const glm::vec2& point : points) {
+                    float dx = std::abs(candidate.x - point.x);
+                    float dz = std::abs(candidate.y - point.y);
+                    dx = std::min(dx, 1.0f - dx);
+                    dz = std::min(dz, 1.0f - dz);
+                    nearestSq = std::min(nearestSq, dx * dx + dz * dz);
+                }
+                if (nearestSq > bestDistSq) {
+                    bestDistSq = nearestSq;
+                    best = candidate;
+                }
+            }
+            points.push_back(best);
+        }
+        return points;
+    }
+
+    const std::vector<glm::vec2>& blueNoisePattern() {
+        static const std::vector<glm::vec2> pattern = makeBlueNoisePattern();
+        return pattern;
+    }
+
+    // Chunk SDF at a position in voxel units, clamped to the chunk
+    float sampleVoxel(const VolumeChunk& chunk, glm::vec3 p) {
+        p = glm::clamp(p, 0.0f, CHUNK_CUBES - 0.001f);
+        int x0 = static_cast<int>(p.x);
+        int y0 = static_cast<int>(p.y);
+        int z0 = static_cast<int>(p.z);
+        return chunk.sdfTrilinear(x0, y0, z0, p.x - x0, p.y - y0, p.z - z0);
+    }
+
+    // Upward component of the surface normal (the SDF grows into the solid)
+    float surfaceUp(const VolumeChunk& chunk, glm::vec3 p) {
+        const float h = 0.5f;
+        glm::vec3 gradient(
+            sampleVoxel(chunk, p + glm::vec3(h, 0, 0)) - sampleVoxel(chunk, p - glm::vec3(h, 0, 0)),
+            sampleVoxel(chunk, p + glm::vec3(0, h, 0)) - sampleVoxel(chunk, p - glm::vec3(0, h, 0)),
+            sampleVoxel(chunk, p + glm::vec3(0, 0, h)) - sampleVoxel(chunk, p - glm::vec3(0, 0, h)));
+        float length = glm::length(gradient);
+        return length > 0.0001f ? -gradient.y / length : 0.0f;
+    }
+
+    // Flat-shaded triangle: the terrain shader has no lighting, so bake it into the colour
+    void addTriangle(std::vector<MarchingCubesVertex>& vertices, glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 color) {
+        const glm::vec3 light = glm::normalize(glm::vec3(0.4f, 1.0f, 0.3f));
+        glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+        glm::vec3 shaded = color * (0.55f + 0.45f * std::max(glm::dot(normal, light), 0.0f));
+        vertices.push_back({a, shaded});
+        vertices.push_back({b, shaded});
+        vertices.push_back({c, shaded});
+    }
+
+    // Triangles from a ring to an apex; ring points are counter-clockwise seen from above
+    void addCone(std::vector<MarchingCubesVertex>& vertices, const std::vector<glm::vec3>& ring, glm::vec3 apex, glm::vec3 color) {
+        for (size_t i = 0; i < ring.size(); i++) {
+            addTriangle(vertices, ring[i], ring[(i + 1) % ring.size()], apex, color);
+        }
+    }
+
+    std::vector<glm::vec3> makeRing(int segments, float radius, float y, float wobble) {
+        std::vector<glm::vec3> ring;
+        for (int i = 0; i < segments; i++) {
+            float angle = -6.2831853f * i / segments;
+            float r = radius * (1.0f + wobble * ((i % 2) ? 1.0f : -1.0f));
+            ring.emplace_back(std::cos(angle) * r, y, std::sin(angle) * r);
+        }
+        return ring;
+    }
+}
+
+void scatterChunkProps(const VolumeChunk& chunk, ChunkProps& props) {
+    std::array<std::vector<PropInstance>, PROP_TYPE_COUNT> byType;
+    const ChunkCoord& coord = chunk.coord;
+    uint32_t columnHash = hashInts(static_cast<uint32_t>(coord.x), static_cast<uint32_t>(coord.z));
+    uint32_t chunkHash = hashInts(columnHash, static_cast<uint32_t>(coord.y));
+    glm::vec3 origin = chunkToWorldPos(coord);
+
+    // The same candidates in every column; which of them get a prop, and its type, size and
+    // yaw, vary per chunk through the hashes below
+    const std::vector<glm::vec2>& pattern = blueNoisePattern();
+    for (size_t i = 0; i < pattern.size(); i++) {
+        float vx = pattern[i].x * CHUNK_CUBES;
+        float vz = pattern[i].y * CHUNK_CUBES;
+
+        // Every solid-below, air-above crossing in the column: ground and cave floors
+        uint32_t crossing = 0;
+        float below = sampleVoxel(chunk, glm::vec3(vx, 0.0f, vz));
+        for (int y = 0; y < CHUNK_CUBES; y++) {
+            float above = sampleVoxel(chunk, glm::vec3(vx, static_cast<float>(y + 1), vz));
+            if (below >= 0.0f && above < 0.0f) {
+                glm::vec3 p(vx, y + below / (below - above), vz);
+                uint32_t h = hashInts(hashInts(chunkHash, static_cast<uint32_t>(i)), crossing++);
+                float up = hashUnit(h) < PROP_DENSITY ? surfaceUp(chunk, p) : 0.0f;
+                if (up >= MIN_UP) {
+                    bool shrub = up >= SHRUB_MIN_UP && hashUnit(hashInts(h, 1)) < SHRUB_FRACTION;
+                    float size = hashUnit(hashInts(h, 2));
+                    float scale = shrub ? 0.6f + 0.8f * size : 0.3f + 0.8f * size;
+                    PropInstance instance{origin + p * VOXEL_SIZE, toUnorm16(hashUnit(hashInts(h, 3))),
+                                          toUnorm16(scale / MAX_PROP_SCALE)};
+                    byType[static_cast<int>(shrub ? PropType::Shrub : PropType::Rock)].push_back(instance);
+                }
+            }
+            below = above;
+        }
+    }
+
+    props.instances.clear();
+    for (int type = 0; type < PROP_TYPE_COUNT; type++) {
+        props.counts[type] = static_cast<uint32_t>(byType[type].size());
+        props.instances.insert(props.instances.end(), byType[type].begin(), byType[type].end());
+    }
+}
+
+PropMeshes buildPropMeshes() {
+    PropMeshes meshes;
+
+    // Rock: a lumpy bipyramid, partly sunk into the ground
+    meshes.firsts[static_cast<int>(PropType::Rock)] = static_cast<uint32_t>(meshes.vertices.size());
+    std::vector<glm::vec3> rockRing = makeRing(5, 0.55f, 0.1f, 0.15f);
+    glm::vec3 rockColor(0.45f, 0.43f, 0.40f);
+    addCone(meshes.vertices, rockRing, glm::vec3(0.05f, 0.55f, 0.0f), rockColor);
+    std::reverse(rockRing.begin(), rockRing.end());
+    addCone(meshes.vertices, rockRing, glm::vec3(0.0f, -0.3f, 0.0f), rockColor);
+
+    // Shrub: two stacked cones
+    meshes.firsts[static_cast<int>(PropType::Shrub)] = static_cast<uint32_t>(meshes.vertices.size());
+    glm::vec3 shrubColor(0.18f, 0.42f, 0.15f);
+    addCone(meshes.vertices, makeRing(6, 0.5f, 0.0f, 0.1f), glm::vec3(0.0f, 0.9f, 0.0f), shrubColor);
+    addCone(meshes.vertices, makeRing(6, 0.35f, 0.5f, 0.1f), glm::vec3(0.0f, 1.3f, 0.0f), shrubColor * 1.15f);
+
+    for (int type = 0; type < PROP_TYPE_COUNT; type++) {
+        uint32_t end = type + 1 < PROP_TYPE_COUNT ? meshes.firsts[type + 1] : static_cast<uint32_t>(meshes.vertices.size());
+        meshes.counts[type] = end - meshes.firsts[type];
+    }
+    return meshes;
+}
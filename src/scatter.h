@@ -0,0 +1,38 @@
+#pragma once
+
+#include "chunk.h"
+#include "marching_cubes.h"
+#include <array>
+#include <vector>
+
+constexpr float MAX_PROP_SCALE = 2.0f;  // Scale encoded in PropInstance::scale as 0..1 of this
+constexpr float PROP_MAX_EXTENT = 1.3f; // Farthest any prop mesh vertex lies from its origin at scale 1
+
+// One prop, read by shaders/prop.vert at instance rate (R32G32B32_SFLOAT + R16G16_UNORM)
+struct PropInstance {
+    glm::vec3 position;  // World space, on the surface
+    uint16_t yaw;        // Unorm, 0..1 = one full turn
+    uint16_t scale;      // Unorm, 0..1 = 0..MAX_PROP_SCALE
+};
+
+// A chunk's instances grouped by type: counts[0] rocks first, then counts[1] shrubs
+struct ChunkProps {
+    std::vector<PropInstance> instances;
+    std::array<uint32_t, PROP_TYPE_COUNT> counts{};
+};
+
+// Places props on the upward-facing surfaces of a chunk's SDF. Candidate positions come
+// from one blue-noise point set tiled over every chunk footprint (it wraps, so spacing holds
+// across chunk edges), and every choice is a hash of the chunk coordinate and point index, so
+// the same terrain always gets the same props. Safe to call from any thread.
+void scatterChunkProps(const VolumeChunk& chunk, ChunkProps& props);
+
+// Model-space meshes for every prop type, concatenated: type t is `counts[t]` vertices
+// starting at `firsts[t]`
+struct PropMeshes {
+    std::vector<MarchingCubesVertex> vertices;
+    std::array<uint32_t, PROP_TYPE_COUNT> firsts{};
+    std::array<uint32_t, PROP_TYPE_COUNT> counts{};
+};
+
+PropMeshes buildPropMeshes();
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Storage orders for a (Cubes + 1)^3 SDF grid. Each layout maps (x, y, z) to an index
+// into a flat array of exactly (Cubes + 1)^3 floats.
+
+// Plain [x][y][z] order, z contiguous
+template<int Cubes>
+struct RowMajorLayout {
+    static constexpr int SIZE = Cubes + 1;
+    static constexpr size_t STORAGE = static_cast<size_t>(SIZE) * SIZE * SIZE;
+
+    static size_t index(int x, int y, int z) {
+        return (static_cast<size_t>(x) * SIZE + y) * SIZE + z;
+    }
+};
+
+// The far faces (any coordinate == Cubes) of a grid whose interior is Cubes^3.
+// Blocked layouts store the interior in power-of-two blocks and this shell after it,
+// so they need no padding.
+template<int Cubes>
+struct BorderShell {
+    static constexpr int SIZE = Cubes + 1;
+    static constexpr size_t INTERIOR = static_cast<size_t>(Cubes) * Cubes * Cubes;
+    static constexpr size_t X_FACE = static_cast<size_t>(SIZE) * SIZE;   // x == Cubes
+    static constexpr size_t Y_FACE = static_cast<size_t>(Cubes) * SIZE;  // y == Cubes, x < Cubes
+    static constexpr size_t Z_FACE = static_cast<size_t>(Cubes) * Cubes; // z == Cubes, x, y < Cubes
+
+    static_assert((Cubes & (Cubes - 1)) == 0, "Blocked SDF layouts need a power-of-two interior");
+
+    // Cubes is a power of two and coordinates never exceed it, so this bit is set
+    // exactly when one of them sits on a far face
+    static bool onShell(int x, int y, int z) { return ((x | y | z) & Cubes) != 0; }
+
+    static size_t index(int x, int y, int z) {
+        if (x == Cubes) {
+            return INTERIOR + static_cast<size_t>(y) * SIZE + z;
+        }
+        if (y == Cubes) {
+            return INTERIOR + X_FACE + static_cast<size_t>(x) * SIZE + z;
+        }
+        return INTERIOR + X_FACE + Y_FACE + static_cast<size_t>(x) * Cubes + y;
+    }
+};
+
+// 4x4x4 tiles (256 bytes) in row-major tile order: a marching-cubes cell and its
+// neighbours mostly fall in one or two tiles instead of four x-planes
+template<int Cubes>
+struct Tiled4Layout {
+    static constexpr int SIZE = Cubes + 1;
+    static constexpr size_t STORAGE = static_cast<size_t>(SIZE) * SIZE * SIZE;
+    static constexpr int TILES = Cubes / 4;
+
+    static_assert(Cubes % 4 == 0, "Tiled layout needs a multiple of 4 cubes");
+
+    static size_t index(int x, int y, int z) {
+        if (BorderShell<Cubes>::onShell(x, y, z)) {
+            return BorderShell<Cubes>::index(x, y, z);
+        }
+        size_t tile = (static_cast<size_t>(x >> 2) * TILES + (y >> 2)) * TILES + (z >> 2);
+        return tile * 64 + (((x & 3) << 4) | ((y & 3) << 2) | (z & 3));
+    }
+};
+
+// Z-order (Morton) curve over the interior, z in the lowest bit
+template<int Cubes>
+struct MortonLayout {
+    static constexpr int SIZE = Cubes + 1;
+    static constexpr size_t STORAGE = static_cast<size_t>(SIZE) * SIZE * SIZE;
+
+    // Bits of a coordinate spread three apart
+    struct SpreadTable {
+        uint32_t bits[Cubes];
+        constexpr SpreadTable() : bits() {
+            for (int v = 0; v < Cubes; v++) {
+                uint32_t spread = 0;
+                for (int bit = 0; (1 << bit) < Cubes; bit++) {
+                    spread |= static_cast<uint32_t>((v >> bit) & 1) << (bit * 3);
+                }
+                bits[v] = spread;
+            }
+        }
+    };
+    static constexpr SpreadTable spread{};
+
+    static size_t index(int x, int y, int z) {
+        if (BorderShell<Cubes>::onShell(x, y, z)) {
+            return BorderShell<Cubes>::index(x, y, z);
+        }
+        return (spread.bits[x] << 2) | (spread.bits[y] << 1) | spread.bits[z];
+    }
+};
+
+// SDF samples stored in a chosen layout. Everything outside this header goes through at(),
+// so the layout can be changed without touching the generator, mesher or physics.
+template<typename Layout>
+struct SdfGrid {
+    using LayoutType = Layout;
+    static constexpr int SIZE = Layout::SIZE;
+
+    float values[Layout::STORAGE];
+
+    float& at(int x, int y, int z) { return values[Layout::index(x, y, z)]; }
+    float at(int x, int y, int z) const { return values[Layout::index(x, y, z)]; }
+
+    void fill(float value) { std::fill(std::begin(values), std::end(values), value); }
+
+    // Trilinear interpolation inside cell (x0, y0, z0), which must not be on a far face
+    float trilinear(int x0, int y0, int z0, float fx, float fy, float fz) const {
+        int x1 = x0 + 1;
+        int y1 = y0 + 1;
+        int z1 = z0 + 1;
+
+        // Interpolate along x
+        float c00 = at(x0, y0, z0) * (1 - fx) + at(x1, y0, z0) * fx;
+        float c01 = at(x0, y0, z1) * (1 - fx) + at(x1, y0, z1) * fx;
+        float c10 = at(x0, y1, z0) * (1 - fx) + at(x1, y1, z0) * fx;
+        float c11 = at(x0, y1, z1) * (1 - fx) + at(x1, y1, z1) * fx;
+
+        // Interpolate along y
+        float c0 = c00 * (1 - fy) + c10 * fy;
+        float c1 = c01 * (1 - fy) + c11 * fy;
+
+        // Interpolate along z
+        return c0 * (1 - fz) + c1 * fz;
+    }
+};
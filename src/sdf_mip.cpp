@@ -0,0 +1,130 @@
+#include "sdf_mip.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+    // 1D tent weights for offsets -1, 0, +1
+    constexpr float TENT_WEIGHTS[3] = {1.0f, 2.0f, 1.0f};
+
+    // Halve one axis of a dims[0] x dims[1] x dims[2] grid (z fastest). Both filters are
+    // separable (tent product, min over a box), so three 1D passes replace a 27-tap loop.
+    // The first and last samples along the axis lie on the grid's faces, which it shares with
+    // its neighbours; they are point-sampled, because a footprint there would only see this
+    // grid's side. The other two passes then filter within the face plane, whose samples both
+    // neighbours hold, so shared faces come out identical.
+    void halveAxis(const float* src, int dims[3], int axis, SdfMipFilter filter, std::vector<float>& dst) {
+        int outDims[3] = {dims[0], dims[1], dims[2]};
+        outDims[axis] = (dims[axis] - 1) / 2 + 1;
+        dst.resize(static_cast<size_t>(outDims[0]) * outDims[1] * outDims[2]);
+
+        const size_t strides[3] = {static_cast<size_t>(dims[1]) * dims[2], static_cast<size_t>(dims[2]), 1};
+        size_t out = 0;
+        for (int x = 0; x < outDims[0]; x++) {
+            for (int y = 0; y < outDims[1]; y++) {
+                for (int z = 0; z < outDims[2]; z++) {
+                    int p[3] = {x, y, z};
+                    const int center = p[axis] * 2;
+                    p[axis] = center;
+                    const float* tap = src + p[0] * strides[0] + p[1] * strides[1] + p[2] * strides[2];
+                    if (center == 0 || center == dims[axis] - 1) {
+                        dst[out++] = *tap;
+                        continue;
+                    }
+
+                    float sum = 0.0f;
+                    float weightSum = 0.0f;
+                    float closest = *tap;
+                    for (int d = -1; d <= 1; d++) {
+                        float value = tap[d * static_cast<std::ptrdiff_t>(strides[axis])];
+                        sum += value * TENT_WEIGHTS[d + 1];
+                        weightSum += TENT_WEIGHTS[d + 1];
+                        if (std::abs(value) < std::abs(closest)) {
+                            closest = value;
+                        }
+                    }
+                    dst[out++] = filter == SdfMipFilter::MinAbs ? closest : sum / weightSum;
+                }
+            }
+        }
+        dims[axis] = outDims[axis];
+    }
+
+    // Halve a fineSize^3 grid (fineSize odd)
+    void downsample(const float* fine, int fineSize, SdfMipFilter filter, SdfMipLevel& coarse) {
+        int dims[3] = {fineSize, fineSize, fineSize};
+        std::vector<float> passX;
+        std::vector<float> passY;
+        halveAxis(fine, dims, 0, filter, passX);
+        halveAxis(passX.data(), dims, 1, filter, passY);
+        halveAxis(passY.data(), dims, 2, filter, coarse.values);
+
+        // Keep each coarse sample on the same side of the surface as the fine sample under it
+        const int size = dims[0];
+        coarse.size = size;
+        size_t out = 0;
+        for (int x = 0; x < size; x++) {
+            for (int y = 0; y < size; y++) {
+                for (int z = 0; z < size; z++, out++) {
+                    float center = fine[((static_cast<size_t>(x) * 2 * fineSize) + y * 2) * fineSize + z * 2];
+                    bool negative = center < 0.0f;
+                    float& value = coarse.values[out];
+                    if (filter == SdfMipFilter::MinAbs) {
+                        value = negative ? -std::abs(value) : std::abs(value);
+                    } else if ((value < 0.0f) != negative) {
+                        value = center;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void downsampleSdfLevel(const SdfMipLevel& fine, SdfMipFilter filter, SdfMipLevel& coarse) {
+    downsample(fine.values.data(), fine.size, filter, coarse);
+    coarse.voxelSize = fine.voxelSize * 2.0f;
+    coarse.origin = fine.origin;
+}
+
+void buildSdfMipChain(const VolumeChunk& chunk, SdfMipFilter filter, SdfMipChain& chain) {
+    // The filter passes want row-major input whatever the chunk's storage layout
+    std::vector<float> fine(static_cast<size_t>(CHUNK_SIZE) * CHUNK_SIZE * CHUNK_SIZE);
+    size_t index = 0;
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                fine[index++] = chunk.sdfAt(x, y, z);
+            }
+        }
+    }
+
+    SdfMipLevel& first = chain.levels[0];
+    downsample(fine.data(), CHUNK_SIZE, filter, first);
+    first.voxelSize = VOXEL_SIZE * 2.0f;
+    first.origin = chunkToWorldPos(chunk.coord);
+
+    for (int level = 1; level < SDF_MIP_LEVELS; level++) {
+        downsampleSdfLevel(chain.levels[level - 1], filter, chain.levels[level]);
+    }
+}
+
+void aggregateSdfChunks(const VolumeChunk* const children[2][2][2], SdfMipFilter filter, SdfMipLevel& coarse) {
+    // Stitch the 8 children into one (2 * CHUNK_CUBES + 1)^3 grid. Shared faces hold the
+    // same world samples in both neighbours, so either copy can be used.
+    const int fineSize = CHUNK_CUBES * 2 + 1;
+    std::vector<float> fine(static_cast<size_t>(fineSize) * fineSize * fineSize);
+    for (int x = 0; x < fineSize; x++) {
+        int ix = std::min(x / CHUNK_CUBES, 1);
+        for (int y = 0; y < fineSize; y++) {
+            int iy = std::min(y / CHUNK_CUBES, 1);
+            float* row = &fine[(static_cast<size_t>(x) * fineSize + y) * fineSize];
+            for (int z = 0; z < fineSize; z++) {
+                int iz = std::min(z / CHUNK_CUBES, 1);
+                row[z] = children[ix][iy][iz]->sdfAt(x - ix * CHUNK_CUBES, y - iy * CHUNK_CUBES, z - iz * CHUNK_CUBES);
+            }
+        }
+    }
+    downsample(fine.data(), fineSize, filter, coarse);
+    coarse.voxelSize = VOXEL_SIZE * 2.0f;
+    coarse.origin = chunkToWorldPos(children[0][0][0]->coord);
+}
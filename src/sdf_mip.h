@@ -0,0 +1,40 @@
+#pragma once
+
+#include "chunk.h"
+#include <vector>
+
+// Coarser copies of a chunk's SDF for LOD meshing and far-field rendering,
+// built from the resident fine samples instead of running the generator again.
+// The app only uses SdfMipLevel (VolumeGenerator::generateCoarseChunk samples its
+// progressive coarse meshes directly, before any fine SDF exists); the functions
+// are built into terrain_bench, which checks them.
+constexpr int SDF_MIP_LEVELS = 3;  // 2x, 4x, 8x
+
+enum class SdfMipFilter {
+    Average,  // Tent filter; falls back to the coincident fine sample if averaging flips the sign
+    MinAbs    // Value closest to the surface in the footprint, with the coincident sample's sign
+};
+
+struct SdfMipLevel {
+    int size = 0;               // Samples per axis (17, 9, 5 for one chunk)
+    float voxelSize = 0.0f;     // World distance between samples
+    glm::vec3 origin{0.0f};     // World position of sample (0, 0, 0)
+    std::vector<float> values;  // [x][y][z], z fastest
+
+    float at(int x, int y, int z) const { return values[(static_cast<size_t>(x) * size + y) * size + z]; }
+};
+
+struct SdfMipChain {
+    SdfMipLevel levels[SDF_MIP_LEVELS];  // levels[0] = 2x ... levels[2] = 8x
+};
+
+// Every coarse sample sits on a fine sample and keeps its sign, so surfaces
+// extracted at any level stay on the same side of the fine surface.
+void buildSdfMipChain(const VolumeChunk& chunk, SdfMipFilter filter, SdfMipChain& chain);
+void downsampleSdfLevel(const SdfMipLevel& fine, SdfMipFilter filter, SdfMipLevel& coarse);
+
+// One CHUNK_SIZE^3 coarse chunk at 2x voxel size from 2x2x2 sdfReady fine chunks, indexed [x][y][z],
+// that still hold their SDF or heightfield (render-only chunks may have dropped both).
+// Filtering runs across the borders between the children. Samples on the coarse chunk's own
+// faces are only filtered within the face, so neighbouring coarse chunks match there.
+void aggregateSdfChunks(const VolumeChunk* const children[2][2][2], SdfMipFilter filter, SdfMipLevel& coarse);
@@ -0,0 +1,261 @@
+#include "sdf_stamps.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    const char* SHAPE_NAMES[] = {"sphere", "box", "pillar", "arch", "ramp"};
+    const char* OP_NAMES[] = {"union", "smooth", "subtract"};
+
+    // Stamped values are exact within this distance of a surface (marching cubes edges, trilinear
+    // collision cells). Farther in, a voxel that stays air (or solid) keeps the terrain value.
+    constexpr float SURFACE_SKIN = 2.0f * VOXEL_SIZE;
+
+    float boxDistance(glm::vec3 q, glm::vec3 halfExtents) {
+        glm::vec3 d = glm::abs(q) - halfExtents;
+        return glm::length(glm::max(d, glm::vec3(0.0f))) + std::min(std::max(d.x, std::max(d.y, d.z)), 0.0f);
+    }
+
+    // Chunks whose lattice [c * size, (c + 1) * size] touches [lo, hi]
+    int firstChunk(float lo) {
+        return static_cast<int>(std::ceil(lo / CHUNK_WORLD_SIZE)) - 1;
+    }
+
+    int lastChunk(float hi) {
+        return static_cast<int>(std::floor(hi / CHUNK_WORLD_SIZE));
+    }
+
+    template<size_t N>
+    bool parseName(const std::string& word, const char* const (&names)[N], int& out) {
+        for (size_t i = 0; i < N; i++) {
+            if (word == names[i]) {
+                out = static_cast<int>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void StampSet::setStamps(std::vector<SdfStamp> newStamps) {
+    stamps = std::move(newStamps);
+    prepared.clear();
+    bins.clear();
+    columnRanges.clear();
+
+    for (uint32_t i = 0; i < stamps.size(); i++) {
+        SdfStamp& stamp = stamps[i];
+        if (stamp.op == StampOp::SmoothUnion && stamp.blend <= 0.0f) {
+            stamp.op = StampOp::Union;
+        }
+
+        Prepared p;
+        p.cosYaw = std::cos(stamp.yaw);
+        p.sinYaw = std::sin(stamp.yaw);
+        switch (stamp.shape) {
+            case StampShape::Sphere:
+                p.boundRadius = stamp.size.x;
+                break;
+            case StampShape::Pillar:
+                p.boundRadius = std::sqrt(stamp.size.x * stamp.size.x + stamp.size.y * stamp.size.y);
+                break;
+            default:
+                p.boundRadius = glm::length(stamp.size);
+                break;
+        }
+        // A smooth union can only raise the field to zero within two blend widths of the shape
+        float reach = p.boundRadius + (stamp.op == StampOp::SmoothUnion ? 2.0f * stamp.blend : 0.0f);
+        p.influenceMin = stamp.center - glm::vec3(reach);
+        p.influenceMax = stamp.center + glm::vec3(reach);
+        prepared.push_back(p);
+
+        for (int x = firstChunk(p.influenceMin.x); x <= lastChunk(p.influenceMax.x); x++) {
+            for (int z = firstChunk(p.influenceMin.z); z <= lastChunk(p.influenceMax.z); z++) {
+                for (int y = firstChunk(p.influenceMin.y); y <= lastChunk(p.influenceMax.y); y++) {
+                    bins[ChunkCoord{x, y, z}].push_back(i);
+                }
+                auto [range, inserted] = columnRanges.emplace(ColumnCoord{x, z}, glm::vec2(p.influenceMin.y, p.influenceMax.y));
+                if (!inserted) {
+                    range->second.x = std::min(range->second.x, p.influenceMin.y);
+                    range->second.y = std::max(range->second.y, p.influenceMax.y);
+                }
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t>* StampSet::chunkCandidates(ChunkCoord coord) const {
+    auto it = bins.find(coord);
+    return it != bins.end() ? &it->second : nullptr;
+}
+
+bool StampSet::columnRange(ColumnCoord column, float& minY, float& maxY) const {
+    auto it = columnRanges.find(column);
+    if (it == columnRanges.end()) {
+        return false;
+    }
+    minY = it->second.x;
+    maxY = it->second.y;
+    return true;
+}
+
+float StampSet::shapeDistance(uint32_t index, glm::vec3 worldPos) const {
+    const SdfStamp& stamp = stamps[index];
+    const Prepared& p = prepared[index];
+    glm::vec3 offset = worldPos - stamp.center;
+    glm::vec3 q(p.cosYaw * offset.x + p.sinYaw * offset.z, offset.y, -p.sinYaw * offset.x + p.cosYaw * offset.z);
+    const glm::vec3& size = stamp.size;
+
+    switch (stamp.shape) {
+        case StampShape::Sphere:
+            return glm::length(q) - size.x;
+        case StampShape::Box:
+            return boxDistance(q, size);
+        case StampShape::Pillar: {
+            float dr = std::sqrt(q.x * q.x + q.z * q.z) - size.x;
+            float dy = std::abs(q.y) - size.y;
+            float outside = std::sqrt(std::max(dr, 0.0f) * std::max(dr, 0.0f) + std::max(dy, 0.0f) * std::max(dy, 0.0f));
+            return outside + std::min(std::max(dr, dy), 0.0f);
+        }
+        case StampShape::Arch: {
+            float dy = q.y + size.y;
+            float opening = std::sqrt(q.x * q.x + dy * dy) - 0.6f * size.x;
+            return std::max(boxDistance(q, size), -opening);
+        }
+        case StampShape::Ramp: {
+            // Plane through the bottom -x and top +x edges
+            float inv = 1.0f / std::sqrt(size.x * size.x + size.y * size.y);
+            float slope = (q.y * size.x - q.x * size.y) * inv;
+            return std::max(boxDistance(q, size), slope);
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+float StampSet::applyOne(uint32_t index, glm::vec3 worldPos, float value) const {
+    const SdfStamp& stamp = stamps[index];
+    const Prepared& p = prepared[index];
+    if (worldPos.x < p.influenceMin.x || worldPos.y < p.influenceMin.y || worldPos.z < p.influenceMin.z ||
+        worldPos.x > p.influenceMax.x || worldPos.y > p.influenceMax.y || worldPos.z > p.influenceMax.z) {
+        return value;
+    }
+
+    // The shape is at least (centre distance - bound radius) away. Skip voxels where that
+    // already decides the result (deep ground for unions, air for carving) or where the voxel
+    // stays well clear of the surface either way (open air around a union, rock around a carve).
+    float centerDist = glm::length(worldPos - stamp.center);
+    float shapeBound = p.boundRadius - centerDist;  // Upper bound of -shapeDistance
+    switch (stamp.op) {
+        case StampOp::Union:
+            if (shapeBound <= value || std::max(value, shapeBound) < -SURFACE_SKIN) {
+                return value;
+            }
+            return std::max(value, -shapeDistance(index, worldPos));
+        case StampOp::SmoothUnion: {
+            float k = stamp.blend;
+            if (shapeBound <= value - k || std::max(value, shapeBound) < -SURFACE_SKIN - k) {
+                return value;
+            }
+            // Polynomial smooth max; exactly `value` once the shape is k below it
+            float shape = -shapeDistance(index, worldPos);
+            float h = std::clamp(0.5f + 0.5f * (shape - value) / k, 0.0f, 1.0f);
+            return value + (shape - value) * h + k * h * (1.0f - h);
+        }
+        case StampOp::Subtract:
+            if (-shapeBound >= value || std::min(value, -shapeBound) > SURFACE_SKIN) {
+                return value;
+            }
+            return std::min(value, shapeDistance(index, worldPos));
+        default:
+            return value;
+    }
+}
+
+float StampSet::apply(const std::vector<uint32_t>& candidates, glm::vec3 worldPos, float value) const {
+    for (uint32_t index : candidates) {
+        value = applyOne(index, worldPos, value);
+    }
+    return value;
+}
+
+float StampSet::apply(glm::vec3 worldPos, float value) const {
+    const std::vector<uint32_t>* candidates = chunkCandidates(worldToChunkCoord(worldPos));
+    return candidates ? apply(*candidates, worldPos, value) : value;
+}
+
+void StampSet::applyToChunk(VolumeChunk& chunk, int xBegin, int xEnd) const {
+    const std::vector<uint32_t>* candidates = chunkCandidates(chunk.coord);
+    if (!candidates) {
+        return;
+    }
+
+    // Stamps go one at a time, in order, each over the voxels inside its influence box only.
+    // Per voxel that is the same sequence apply() runs.
+    glm::vec3 origin = chunkToWorldPos(chunk.coord);
+    for (uint32_t index : *candidates) {
+        const Prepared& p = prepared[index];
+        int lo[3];
+        int hi[3];
+        for (int axis = 0; axis < 3; axis++) {
+            lo[axis] = std::max(0, static_cast<int>(std::ceil((p.influenceMin[axis] - origin[axis]) / VOXEL_SIZE)));
+            hi[axis] = std::min(CHUNK_SIZE - 1, static_cast<int>(std::floor((p.influenceMax[axis] - origin[axis]) / VOXEL_SIZE)));
+        }
+        lo[0] = std::max(lo[0], xBegin);
+        hi[0] = std::min(hi[0], xEnd - 1);
+
+        for (int x = lo[0]; x <= hi[0]; x++) {
+            for (int y = lo[1]; y <= hi[1]; y++) {
+                for (int z = lo[2]; z <= hi[2]; z++) {
+                    glm::vec3 worldPos = origin + glm::vec3(x * VOXEL_SIZE, y * VOXEL_SIZE, z * VOXEL_SIZE);
+                    float& value = chunk.sdf->at(x, y, z);
+                    value = applyOne(index, worldPos, value);
+                }
+            }
+        }
+    }
+}
+
+bool loadStampFile(const std::string& path, std::vector<SdfStamp>& stamps) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string shapeName;
+        if (!(words >> shapeName)) {
+            continue;
+        }
+
+        std::string opName;
+        SdfStamp stamp;
+        int shape = 0;
+        int op = 0;
+        float yawDegrees = 0.0f;
+        if (!(words >> opName >> stamp.center.x >> stamp.center.y >> stamp.center.z >> stamp.size.x >> stamp.size.y >>
+              stamp.size.z)) {
+            std::cout << "[stamps] " << path << ":" << lineNumber << ": expected '<shape> <op> x y z sx sy sz'" << std::endl;
+            continue;
+        }
+        if (!parseName(shapeName, SHAPE_NAMES, shape) || !parseName(opName, OP_NAMES, op)) {
+            std::cout << "[stamps] " << path << ":" << lineNumber << ": unknown shape or op" << std::endl;
+            continue;
+        }
+        if (words >> yawDegrees) {
+            words >> stamp.blend;
+        }
+        stamp.shape = static_cast<StampShape>(shape);
+        stamp.op = static_cast<StampOp>(op);
+        stamp.yaw = glm::radians(yawDegrees);
+        stamps.push_back(stamp);
+    }
+    std::cout << "[stamps] Loaded " << stamps.size() << " stamps from " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "chunk.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hand-authored primitives merged into the generated terrain
+enum class StampShape {
+    Sphere,    // size.x = radius
+    Box,       // size = half extents
+    Pillar,    // Vertical cylinder: size.x = radius, size.y = half height
+    Arch,      // Box with a half-round opening along local z, radius 0.6 * size.x
+    Ramp,      // Box cut diagonally, rising towards local +x
+    Count
+};
+
+enum class StampOp {
+    Union,        // Add material
+    SmoothUnion,  // Add material, blended into the terrain over `blend` SDF units
+    Subtract,     // Carve the shape out
+    Count
+};
+
+struct SdfStamp {
+    StampShape shape = StampShape::Box;
+    StampOp op = StampOp::Union;
+    glm::vec3 center{0.0f};
+    glm::vec3 size{1.0f};
+    float yaw = 0.0f;    // Radians around +y
+    float blend = 0.0f;  // SmoothUnion only
+};
+
+// Stamps binned by the chunks their influence overlaps. Each chunk only evaluates its own
+// candidates, in authoring order, and skips voxels outside a stamp's bounding sphere whose
+// value can't change. Results don't depend on chunk boundaries or evaluation order across
+// chunks, so generateChunk and VolumeGenerator::generateSDF agree bit for bit.
+// Primitive distances are in metres, close to the terrain field's slope near its surface.
+class StampSet {
+public:
+    // Rebuilds the bins. Not thread-safe: nothing may be generating while this runs.
+    void setStamps(std::vector<SdfStamp> newStamps);
+    const std::vector<SdfStamp>& getStamps() const { return stamps; }
+    bool empty() const { return stamps.empty(); }
+
+    // Stamps whose influence overlaps the chunk's lattice (shared border samples included), or null
+    const std::vector<uint32_t>* chunkCandidates(ChunkCoord coord) const;
+
+    // World y range the stamps over a column can put surface into; false if there are none
+    bool columnRange(ColumnCoord column, float& minY, float& maxY) const;
+
+    // Terrain value at worldPos with the given candidates applied
+    float apply(const std::vector<uint32_t>& candidates, glm::vec3 worldPos, float value) const;
+    float apply(glm::vec3 worldPos, float value) const;
+
+    // Stamp a slab [xBegin, xEnd) of a chunk's freshly generated SDF in place
+    void applyToChunk(VolumeChunk& chunk, int xBegin, int xEnd) const;
+
+private:
+    struct Prepared {
+        float cosYaw;
+        float sinYaw;
+        float boundRadius;     // Bounding sphere of the shape
+        glm::vec3 influenceMin;  // Bounding sphere grown by the blend width
+        glm::vec3 influenceMax;
+    };
+
+    std::vector<SdfStamp> stamps;
+    std::vector<Prepared> prepared;
+    std::unordered_map<ChunkCoord, std::vector<uint32_t>> bins;
+    std::unordered_map<ColumnCoord, glm::vec2> columnRanges;
+
+    // Signed distance to the shape (negative inside)
+    float shapeDistance(uint32_t index, glm::vec3 worldPos) const;
+    float applyOne(uint32_t index, glm::vec3 worldPos, float value) const;
+};
+
+// One stamp per line: <shape> <op> x y z sx sy sz [yaw_degrees] [blend], '#' starts a comment.
+// Shapes: sphere box pillar arch ramp. Ops: union smooth subtract. Returns false if the file
+// can't be opened; bad lines are reported and skipped.
+bool loadStampFile(const std::string& path, std::vector<SdfStamp>& stamps);
@@ -0,0 +1,203 @@
+#include "stream_debug.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+    constexpr int STATE_COUNT = static_cast<int>(ChunkStreamState::Count);
+
+    constexpr const char* STATE_NAMES[STATE_COUNT] = {
+        "queued", "generating", "meshing", "meshed", "uploading", "resident", "culled", "collision-only", "idle"
+    };
+
+    // One letter per state for the console map
+    constexpr char STATE_LETTERS[STATE_COUNT] = {'Q', 'G', 'M', 'W', 'U', 'R', 'C', 'X', 'I'};
+
+    const glm::vec3 STATE_COLORS[STATE_COUNT] = {
+        {0.5f, 0.5f, 0.5f},  // Queued
+        {1.0f, 0.5f, 0.0f},  // Generating
+        {1.0f, 1.0f, 0.0f},  // Meshing
+        {0.0f, 1.0f, 1.0f},  // Meshed
+        {0.2f, 0.4f, 1.0f},  // Uploading
+        {0.0f, 0.8f, 0.0f},  // Resident
+        {0.0f, 0.3f, 0.0f},  // Culled
+        {1.0f, 0.0f, 1.0f},  // CollisionOnly
+        {0.2f, 0.2f, 0.2f},  // Idle
+    };
+
+    // Chunk boxes are inset so neighbours don't share edges
+    constexpr float BOX_INSET = 0.25f;
+
+    constexpr int SLOWEST_LISTED = 8;
+
+    float chunkCostMs(const VolumeChunk& chunk) {
+        return chunk.generationMs.load() + chunk.meshMs.load();
+    }
+
+    // Green -> yellow -> red
+    glm::vec3 heatColor(float t) {
+        t = std::clamp(t, 0.0f, 1.0f);
+        return t < 0.5f ? glm::vec3(t * 2.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 2.0f - t * 2.0f, 0.0f);
+    }
+
+    void appendBox(std::vector<MarchingCubesVertex>& lines, glm::vec3 boxMin, glm::vec3 boxMax, glm::vec3 color) {
+        glm::vec3 corners[8];
+        for (int i = 0; i < 8; i++) {
+            corners[i] = glm::vec3(i & 1 ? boxMax.x : boxMin.x, i & 2 ? boxMax.y : boxMin.y, i & 4 ? boxMax.z : boxMin.z);
+        }
+        // The 12 edges join corners that differ in exactly one bit
+        for (int i = 0; i < 8; i++) {
+            for (int bit = 1; bit < 8; bit <<= 1) {
+                if (!(i & bit)) {
+                    lines.push_back({corners[i], color});
+                    lines.push_back({corners[i | bit], color});
+                }
+            }
+        }
+    }
+
+    // World box of chunks cameraChunk - radius .. cameraChunk + radius (per axis)
+    void appendChunkRange(std::vector<MarchingCubesVertex>& lines, ChunkCoord center, int radiusXZ, int radiusY,
+                          glm::vec3 color) {
+        glm::vec3 low = chunkToWorldPos({center.x - radiusXZ, center.y - radiusY, center.z - radiusXZ});
+        glm::vec3 high = chunkToWorldPos({center.x + radiusXZ + 1, center.y + radiusY + 1, center.z + radiusXZ + 1});
+        appendBox(lines, low, high, color);
+    }
+}
+
+ChunkStreamState classifyChunk(const VolumeChunk& chunk) {
+    if (chunk.generationQueued.load()) {
+        return ChunkStreamState::Queued;
+    }
+    if (chunk.generationInProgress.load()) {
+        return chunk.sdfReady.load() ? ChunkStreamState::Meshing : ChunkStreamState::Generating;
+    }
+    if (chunk.uploadInProgress.load()) {
+        return ChunkStreamState::Uploading;
+    }
+    if (!chunk.renderTier.load()) {
+        return chunk.sdfReady.load() ? ChunkStreamState::CollisionOnly : ChunkStreamState::Idle;
+    }
+    if (chunk.meshUploaded) {
+        return chunk.culled ? ChunkStreamState::Culled : ChunkStreamState::Resident;
+    }
+    if (chunk.meshBuilt.load()) {
+        return ChunkStreamState::Meshed;
+    }
+    return ChunkStreamState::Idle;
+}
+
+const char* streamStateName(ChunkStreamState state) {
+    return STATE_NAMES[static_cast<int>(state)];
+}
+
+void buildStreamOverlay(const ChunkManager& chunkManager, ChunkCoord cameraChunk, const StreamRadii& radii,
+                        StreamOverlayMode mode, size_t maxVertices, std::vector<MarchingCubesVertex>& lines) {
+    lines.clear();
+    if (mode == StreamOverlayMode::Off) {
+        return;
+    }
+
+    // Boundaries first so they survive the vertex cap
+    appendChunkRange(lines, cameraChunk, radii.load, 1, glm::vec3(1.0f));
+    appendChunkRange(lines, cameraChunk, radii.unload, radii.unload * 2, glm::vec3(1.0f, 0.0f, 0.0f));
+    appendChunkRange(lines, cameraChunk, radii.collision, radii.collision, glm::vec3(1.0f, 1.0f, 0.0f));
+
+    // Heat scales are relative to the most expensive chunk currently loaded
+    float maxCost = 0.0f;
+    uint32_t maxVertexCount = 0;
+    for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+        maxCost = std::max(maxCost, chunkCostMs(*chunk));
+        maxVertexCount = std::max(maxVertexCount, chunk->vertexCount);
+    }
+
+    for (const auto& [coord, chunk] : chunkManager.getChunks()) {
+        if (lines.size() + 24 > maxVertices) {
+            break;
+        }
+        glm::vec3 color;
+        if (mode == StreamOverlayMode::State) {
+            color = STATE_COLORS[static_cast<int>(classifyChunk(*chunk))];
+        } else if (mode == StreamOverlayMode::Time) {
+            color = heatColor(maxCost > 0.0f ? chunkCostMs(*chunk) / maxCost : 0.0f);
+        } else {
+            if (chunk->vertexCount == 0) {
+                continue;  // Empty chunks would only hide the interesting ones
+            }
+            color = heatColor(static_cast<float>(chunk->vertexCount) / maxVertexCount);
+        }
+        glm::vec3 origin = chunkToWorldPos(coord);
+        appendBox(lines, origin + glm::vec3(BOX_INSET), origin + glm::vec3(CHUNK_WORLD_SIZE - BOX_INSET), color);
+    }
+}
+
+void printStreamReport(const ChunkManager& chunkManager, ChunkCoord cameraChunk, const StreamRadii& radii) {
+    const auto& chunks = chunkManager.getChunks();
+
+    int counts[STATE_COUNT] = {};
+    std::vector<const VolumeChunk*> byCost;
+    // Furthest-behind state per column, for the map
+    std::map<std::pair<int, int>, ChunkStreamState> columns;
+    for (const auto& [coord, chunk] : chunks) {
+        ChunkStreamState state = classifyChunk(*chunk);
+        counts[static_cast<int>(state)]++;
+        byCost.push_back(chunk.get());
+
+        auto key = std::make_pair(coord.x, coord.z);
+        auto it = columns.find(key);
+        if (it == columns.end() || state < it->second) {
+            columns[key] = state;
+        }
+    }
+
+    std::cout << "=== Streaming: " << chunks.size() << " chunks, camera chunk (" << cameraChunk.x << ", "
+              << cameraChunk.y << ", " << cameraChunk.z << "), radii load " << radii.load << " / unload "
+              << radii.unload << " / collision " << radii.collision << " ===" << std::endl;
+    for (int i = 0; i < STATE_COUNT; i++) {
+        std::cout << (i > 0 ? " | " : "") << STATE_NAMES[i] << " " << counts[i];
+    }
+    std::cout << std::endl;
+
+    size_t listed = std::min<size_t>(SLOWEST_LISTED, byCost.size());
+    std::partial_sort(byCost.begin(), byCost.begin() + listed, byCost.end(),
+                      [](const VolumeChunk* a, const VolumeChunk* b) { return chunkCostMs(*a) > chunkCostMs(*b); });
+    std::cout << "Most expensive chunks:" << std::endl << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < listed; i++) {
+        const VolumeChunk& chunk = *byCost[i];
+        std::cout << "  (" << chunk.coord.x << ", " << chunk.coord.y << ", " << chunk.coord.z << ") "
+                  << std::setw(14) << std::left << streamStateName(classifyChunk(chunk)) << std::right
+                  << " gen " << chunk.generationMs.load() << " ms, mesh " << chunk.meshMs.load() << " ms, "
+                  << chunk.vertexCount / 3 << " tris" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+
+    // Top-down map, +x to the right and +z down. Upper case inside the load radius,
+    // lower case in the band kept until unload, '@' for the camera column.
+    std::cout << "Columns (furthest-behind chunk per column; ";
+    for (int i = 0; i < STATE_COUNT; i++) {
+        std::cout << STATE_LETTERS[i] << "=" << STATE_NAMES[i] << (i + 1 < STATE_COUNT ? " " : "");
+    }
+    std::cout << "):" << std::endl;
+    for (int dz = -radii.unload; dz <= radii.unload; dz++) {
+        std::cout << "  ";
+        for (int dx = -radii.unload; dx <= radii.unload; dx++) {
+            char cell = ' ';
+            auto it = columns.find(std::make_pair(cameraChunk.x + dx, cameraChunk.z + dz));
+            if (dx == 0 && dz == 0) {
+                cell = '@';
+            } else if (it != columns.end()) {
+                cell = STATE_LETTERS[static_cast<int>(it->second)];
+                if (std::max(std::abs(dx), std::abs(dz)) > radii.load) {
+                    cell = static_cast<char>(std::tolower(cell));
+                }
+            } else {
+                cell = '.';
+            }
+            std::cout << cell << ' ';
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "chunk_manager.h"
+#include "marching_cubes.h"
+#include <vector>
+
+// Where a chunk is in the streaming pipeline, as seen from the main thread. Ordered from
+// furthest behind to done, so the minimum over a set of chunks is its bottleneck.
+enum class ChunkStreamState {
+    Queued,
+    Generating,
+    Meshing,
+    Meshed,         // Mesh built, waiting for an upload slot
+    Uploading,
+    Resident,
+    Culled,         // Resident but skipped by frustum or occlusion culling last frame
+    CollisionOnly,  // Generated for physics, never meshed
+    Idle,           // SDF released and nothing pending
+    Count
+};
+
+ChunkStreamState classifyChunk(const VolumeChunk& chunk);
+const char* streamStateName(ChunkStreamState state);
+
+enum class StreamOverlayMode {
+    Off,
+    State,      // Colour by ChunkStreamState
+    Time,       // Generation + mesh time, green (cheap) to red (slowest loaded chunk)
+    Triangles,  // Triangle count, same scale
+    Count
+};
+
+// Streaming radii in chunks, for drawing and printing the boundaries
+struct StreamRadii {
+    int load;
+    int unload;     // Vertical unload radius is twice this
+    int collision;
+};
+
+// Line-list vertices: a box per loaded chunk coloured by `mode`, plus the load (white),
+// unload (red) and collision (yellow) boundaries around the camera chunk.
+// Stops adding boxes once maxVertices is reached.
+void buildStreamOverlay(const ChunkManager& chunkManager, ChunkCoord cameraChunk, const StreamRadii& radii,
+                        StreamOverlayMode mode, size_t maxVertices, std::vector<MarchingCubesVertex>& lines);
+
+// Console dump: chunks per state, the most expensive chunks, and a top-down map of columns
+void printStreamReport(const ChunkManager& chunkManager, ChunkCoord cameraChunk, const StreamRadii& radii);
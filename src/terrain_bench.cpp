@@ -0,0 +1,1180 @@
+// Offline benchmark for the terrain pipeline (no window or GPU needed)
+//
+// Usage: terrain_bench [chunk radius]
+
+#include "chunk.h"
+#include "volume_generator.h"
+#include "sdf_mip.h"
+#include "marching_cubes.h"
+#include "heightfield.h"
+#include "thread_topology.h"
+#include "collision_fallback.h"
+#include "scatter.h"
+#include "navigation.h"
+#include "upload_scheduler.h"
+#include "memory_governor.h"
+#include "horizon_culling.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <limits>
+
+namespace {
+
+constexpr int VOXELS_PER_CHUNK = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+std::vector<std::unique_ptr<VolumeChunk>> makeChunks(int radius) {
+    std::vector<std::unique_ptr<VolumeChunk>> chunks;
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                auto chunk = std::make_unique<VolumeChunk>();
+                chunk->coord = {x, y, z};
+                chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+    return chunks;
+}
+
+// Generates every chunk with the given backend, returns nanoseconds per voxel
+double timeBackend(VolumeGenerator& generator, GeneratorBackend backend,
+                   std::vector<std::unique_ptr<VolumeChunk>>& chunks) {
+    generator.setBackend(backend);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(chunks.size()) * VOXELS_PER_CHUNK);
+}
+
+float maxAbsDifference(const std::vector<std::unique_ptr<VolumeChunk>>& a,
+                       const std::vector<std::unique_ptr<VolumeChunk>>& b) {
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    maxDiff = std::max(maxDiff, std::abs(a[i]->sdf->at(x, y, z) - b[i]->sdf->at(x, y, z)));
+                }
+            }
+        }
+    }
+    return maxDiff;
+}
+
+void benchGenerator(int radius) {
+    VolumeGenerator generator;
+    auto reference = makeChunks(radius);
+    auto fused = makeChunks(radius);
+
+    std::cout << "=== Generator: " << reference.size() << " chunks ===" << std::endl;
+
+    // Warm-up pass so both backends see warm caches and lazily built tables
+    timeBackend(generator, GeneratorBackend::Reference, reference);
+
+    double referenceNs = timeBackend(generator, GeneratorBackend::Reference, reference);
+    double fusedNs = timeBackend(generator, GeneratorBackend::Fused, fused);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "reference (separate calls): " << referenceNs << " ns/voxel" << std::endl;
+    std::cout << "fused (row-batched):        " << fusedNs << " ns/voxel"
+              << "  (" << std::setprecision(2) << referenceNs / fusedNs << "x)" << std::endl;
+    std::cout << "max |reference - fused|:    " << std::scientific
+              << maxAbsDifference(reference, fused) << std::defaultfloat << std::endl;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchTiledNoise(int radius) {
+    auto procedural = makeChunks(radius);
+    auto tiled = makeChunks(radius);
+
+    std::cout << std::endl << "=== Tiled noise fields ===" << std::endl;
+
+    const auto cacheDir = std::filesystem::temp_directory_path();
+    const std::string terrainCache = (cacheDir / "terrain_bench_terrain.ntile").string();
+    const std::string caveCache = (cacheDir / "terrain_bench_caves.ntile").string();
+    std::filesystem::remove(terrainCache);
+    std::filesystem::remove(caveCache);
+
+    VolumeGenerator proceduralGenerator;
+    VolumeGenerator tiledGenerator;
+
+    auto bakeStart = std::chrono::steady_clock::now();
+    tiledGenerator.useTiledField(NoiseField::Terrain, TERRAIN_TILE_RESOLUTION, TERRAIN_TILE_PERIOD, terrainCache);
+    tiledGenerator.useTiledField(NoiseField::Caves, CAVE_TILE_RESOLUTION, CAVE_TILE_PERIOD, caveCache);
+    double bakeMs = elapsedMs(bakeStart);
+
+    // Second generator picks the tiles up from the cache written above
+    VolumeGenerator cachedGenerator;
+    auto loadStart = std::chrono::steady_clock::now();
+    bool loaded = cachedGenerator.useTiledField(NoiseField::Terrain, TERRAIN_TILE_RESOLUTION, TERRAIN_TILE_PERIOD, terrainCache);
+    loaded = cachedGenerator.useTiledField(NoiseField::Caves, CAVE_TILE_RESOLUTION, CAVE_TILE_PERIOD, caveCache) && loaded;
+    double loadMs = elapsedMs(loadStart);
+
+    timeBackend(proceduralGenerator, GeneratorBackend::Fused, procedural);
+    double proceduralNs = timeBackend(proceduralGenerator, GeneratorBackend::Fused, procedural);
+    double tiledNs = timeBackend(tiledGenerator, GeneratorBackend::Fused, tiled);
+
+    // Quality: SDF error and how many voxels end up on the other side of the surface
+    double sumSq = 0.0;
+    float maxError = 0.0f;
+    size_t signFlips = 0;
+    size_t voxels = 0;
+    for (size_t i = 0; i < procedural.size(); i++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    float a = procedural[i]->sdf->at(x, y, z);
+                    float b = tiled[i]->sdf->at(x, y, z);
+                    float error = std::abs(a - b);
+                    sumSq += static_cast<double>(error) * error;
+                    maxError = std::max(maxError, error);
+                    if ((a > 0.0f) != (b > 0.0f)) {
+                        signFlips++;
+                    }
+                    voxels++;
+                }
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "tile memory:                " << tiledGenerator.tileMemoryBytes() / 1024.0 / 1024.0 << " MB" << std::endl;
+    std::cout << "bake: " << bakeMs << " ms, load from cache: " << loadMs << " ms"
+              << (loaded ? "" : " (cache miss)") << std::endl;
+    std::cout << "procedural (fused):         " << proceduralNs << " ns/voxel" << std::endl;
+    std::cout << "tiled terrain + caves:      " << tiledNs << " ns/voxel"
+              << "  (" << std::setprecision(2) << proceduralNs / tiledNs << "x)" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "SDF error rms / max:        " << std::sqrt(sumSq / voxels) << " / " << maxError << std::endl;
+    std::cout << "voxels with flipped sign:   " << 100.0 * signFlips / voxels << "%" << std::defaultfloat << std::endl;
+
+    std::filesystem::remove(terrainCache);
+    std::filesystem::remove(caveCache);
+}
+
+// Time to a collision-ready SDF for one chunk when every thread fills x-slabs of it,
+// the way the app's urgent lane does. Thread start-up is included in the timing.
+void benchUrgentLatency(int radius) {
+    constexpr int SLAB_WIDTH = 4;
+    constexpr int SLAB_COUNT = (CHUNK_SIZE + SLAB_WIDTH - 1) / SLAB_WIDTH;
+
+    VolumeGenerator generator;
+    auto chunks = makeChunks(radius);
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::endl << "=== Urgent chunk latency: " << chunks.size() << " chunks ===" << std::endl;
+
+    for (unsigned int threadCount = 1; ; threadCount = std::min(threadCount * 2, hardwareThreads)) {
+        double worstMs = 0.0;
+        double totalMs = 0.0;
+        for (auto& chunk : chunks) {
+            auto start = std::chrono::steady_clock::now();
+            generator.initChunkBounds(*chunk);
+            std::atomic<int> nextSlab{0};
+            auto fillSlabs = [&]() {
+                int slab;
+                while ((slab = nextSlab.fetch_add(1)) < SLAB_COUNT) {
+                    int xBegin = slab * SLAB_WIDTH;
+                    generator.generateSlab(*chunk, xBegin, std::min(CHUNK_SIZE, xBegin + SLAB_WIDTH));
+                }
+            };
+            std::vector<std::thread> helpers;
+            for (unsigned int i = 1; i < threadCount; i++) {
+                helpers.emplace_back(fillSlabs);
+            }
+            fillSlabs();
+            for (std::thread& helper : helpers) {
+                helper.join();
+            }
+            double ms = elapsedMs(start);
+            worstMs = std::max(worstMs, ms);
+            totalMs += ms;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << threadCount << " thread(s): avg " << totalMs / chunks.size()
+                  << " ms, worst " << worstMs << " ms" << std::defaultfloat << std::endl;
+        if (threadCount == hardwareThreads) {
+            break;
+        }
+    }
+}
+
+// Building coarse levels from resident fine chunks vs running the generator for them again.
+// Returns false if two neighbouring coarse chunks disagree on their shared face.
+bool benchSdfMips(int radius) {
+    VolumeGenerator generator;
+    auto chunks = makeChunks(std::max(radius, 1));
+    double fusedNs = timeBackend(generator, GeneratorBackend::Fused, chunks);
+
+    std::cout << std::endl << "=== SDF mip chain: " << chunks.size() << " chunks ===" << std::endl;
+
+    int coarseSamples = 0;
+    for (int size = CHUNK_SIZE; size > 5; ) {
+        size = (size - 1) / 2 + 1;
+        coarseSamples += size * size * size;
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "regenerating 2x/4x/8x:      " << fusedNs * coarseSamples / 1000.0 << " us/chunk" << std::endl;
+
+    for (SdfMipFilter filter : {SdfMipFilter::Average, SdfMipFilter::MinAbs}) {
+        SdfMipChain chain;
+        size_t signMismatches = 0;
+        size_t samples = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& chunk : chunks) {
+            buildSdfMipChain(*chunk, filter, chain);
+
+            // Every coarse sample must agree in sign with the fine sample it sits on
+            for (int level = 0; level < SDF_MIP_LEVELS; level++) {
+                const SdfMipLevel& mip = chain.levels[level];
+                int stride = 2 << level;
+                for (int x = 0; x < mip.size; x++) {
+                    for (int y = 0; y < mip.size; y++) {
+                        for (int z = 0; z < mip.size; z++) {
+                            float fine = chunk->sdf->at(x * stride, y * stride, z * stride);
+                            if ((fine < 0.0f) != (mip.at(x, y, z) < 0.0f)) {
+                                signMismatches++;
+                            }
+                            samples++;
+                        }
+                    }
+                }
+            }
+        }
+        double us = elapsedMs(start) * 1000.0 / chunks.size();
+
+        std::cout << (filter == SdfMipFilter::Average ? "average" : "min-abs")
+                  << " chain (incl. check):    " << us << " us/chunk, sign mismatches "
+                  << signMismatches << " / " << samples << std::endl;
+    }
+
+    // 2x2x2 aggregation over the chunks at x/z 0..1, y 0..1
+    const VolumeChunk* children[2][2][2];
+    for (auto& chunk : chunks) {
+        const ChunkCoord& c = chunk->coord;
+        if (c.x >= 0 && c.x <= 1 && c.y >= 0 && c.y <= 1 && c.z >= 0 && c.z <= 1) {
+            children[c.x][c.y][c.z] = chunk.get();
+        }
+    }
+    SdfMipLevel coarse;
+    auto start = std::chrono::steady_clock::now();
+    aggregateSdfChunks(children, SdfMipFilter::MinAbs, coarse);
+    std::cout << "2x2x2 aggregate:            " << elapsedMs(start) * 1000.0 << " us ("
+              << coarse.size << "^3 at " << coarse.voxelSize << "m)" << std::defaultfloat << std::endl;
+
+    // Coarse chunks (0, 0, 0) and (1, 0, 0) must hold the same samples on their shared face
+    std::vector<std::unique_ptr<VolumeChunk>> pair;
+    const VolumeChunk* sides[2][2][2][2];
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 2; y++) {
+            for (int z = 0; z < 2; z++) {
+                auto chunk = std::make_unique<VolumeChunk>();
+                chunk->coord = {x, y, z};
+                generator.generateChunk(*chunk);
+                sides[x / 2][x % 2][y][z] = chunk.get();
+                pair.push_back(std::move(chunk));
+            }
+        }
+    }
+    bool facesMatch = true;
+    for (SdfMipFilter filter : {SdfMipFilter::Average, SdfMipFilter::MinAbs}) {
+        SdfMipLevel left;
+        SdfMipLevel right;
+        aggregateSdfChunks(sides[0], filter, left);
+        aggregateSdfChunks(sides[1], filter, right);
+        float maxDiff = 0.0f;
+        for (int y = 0; y < left.size; y++) {
+            for (int z = 0; z < left.size; z++) {
+                maxDiff = std::max(maxDiff, std::abs(left.at(left.size - 1, y, z) - right.at(0, y, z)));
+            }
+        }
+        facesMatch = facesMatch && maxDiff == 0.0f;
+        std::cout << (filter == SdfMipFilter::Average ? "average" : "min-abs")
+                  << " shared coarse face:     max difference " << maxDiff
+                  << (maxDiff == 0.0f ? "" : "  FAILED") << std::endl;
+    }
+    return facesMatch;
+}
+
+void benchMesher(int radius) {
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    auto chunks = makeChunks(radius);
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== Mesher: " << chunks.size() << " chunks ===" << std::endl;
+
+    MeshStats total;
+    uint32_t worstRemoved = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        MeshStats stats;
+        mesher.generateMesh(*chunk, &stats);
+        total.trianglesEmitted += stats.trianglesEmitted;
+        total.degenerateRemoved += stats.degenerateRemoved;
+        total.sliverRemoved += stats.sliverRemoved;
+        worstRemoved = std::max(worstRemoved, stats.removed());
+    }
+    double msPerChunk = elapsedMs(start) / chunks.size();
+
+    uint32_t produced = total.trianglesEmitted + total.removed();
+    std::cout << std::fixed << std::setprecision(2)
+              << "mesh time:                  " << msPerChunk << " ms/chunk" << std::endl
+              << "triangles kept:             " << total.trianglesEmitted << std::endl
+              << "dropped degenerate/sliver:  " << total.degenerateRemoved << " / " << total.sliverRemoved
+              << " (" << (produced > 0 ? 100.0 * total.removed() / produced : 0.0) << "%, worst chunk "
+              << worstRemoved << ")" << std::defaultfloat << std::endl;
+}
+
+// Time to first visible mesh: the progressive coarse pass against full generation + meshing
+void benchProgressive(int radius) {
+    constexpr int STRIDE = 4;  // COARSE_STRIDE in main.cpp
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    auto chunks = makeChunks(radius);
+
+    std::cout << std::endl << "=== Progressive chunks: " << chunks.size() << " chunks ===" << std::endl;
+
+    size_t coarseTriangles = 0;
+    SdfMipLevel level;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        generator.generateCoarseChunk(chunk->coord, STRIDE, level);
+        coarseTriangles += mesher.generateMesh(level, level.origin, level.voxelSize).size() / 3;
+    }
+    double coarseMs = elapsedMs(start) / chunks.size();
+
+    size_t fullTriangles = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+        fullTriangles += mesher.generateMesh(*chunk).size() / 3;
+    }
+    double fullMs = elapsedMs(start) / chunks.size();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "coarse (stride " << STRIDE << "):          " << coarseMs << " ms/chunk, "
+              << coarseTriangles << " triangles" << std::endl
+              << "full:                       " << fullMs << " ms/chunk, "
+              << fullTriangles << " triangles" << std::endl
+              << "first mesh speedup:         " << std::setprecision(1) << fullMs / coarseMs << "x"
+              << std::defaultfloat << std::endl;
+}
+
+// Collision samples without a chunk: cost of direct evaluation and agreement with the chunk SDF
+void benchCollisionFallback(int radius) {
+    constexpr int SAMPLES = 20000;
+    VolumeGenerator generator;
+    CollisionFallback fallback(generator);
+    auto chunks = makeChunks(radius);
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== Collision fallback: " << SAMPLES << " samples ===" << std::endl;
+
+    // Scattered probes miss the cache; a player-like walk mostly hits it
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(0.0f, 0.999f);
+    std::uniform_int_distribution<size_t> pick(0, chunks.size() - 1);
+    float maxDiff = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        const VolumeChunk& chunk = *chunks[pick(rng)];
+        glm::vec3 voxelPos(unit(rng) * CHUNK_CUBES, unit(rng) * CHUNK_CUBES, unit(rng) * CHUNK_CUBES);
+        float value = fallback.sample(chunkToWorldPos(chunk.coord) + voxelPos * VOXEL_SIZE);
+        glm::ivec3 cell(voxelPos);
+        float expected = chunk.sdfTrilinear(cell.x, cell.y, cell.z, voxelPos.x - cell.x,
+                                            voxelPos.y - cell.y, voxelPos.z - cell.z);
+        maxDiff = std::max(maxDiff, std::abs(value - expected));
+    }
+    double scatteredUs = elapsedMs(start) * 1000.0 / SAMPLES;
+    uint32_t scatteredEvals = fallback.takeEvaluationCount();
+
+    fallback.clear();
+    glm::vec3 position(0.0f, 4.0f, 0.0f);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        position.x += 0.15f;  // 9 m/s at 60 Hz
+        fallback.sample(position);
+        fallback.sample(position + glm::vec3(0.0f, -0.9f, 0.0f));
+    }
+    double walkUs = elapsedMs(start) * 1000.0 / (2 * SAMPLES);
+    uint32_t walkEvals = fallback.takeEvaluationCount();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "scattered:                  " << scatteredUs << " us/sample, "
+              << scatteredEvals / static_cast<float>(SAMPLES) << " evals/sample" << std::endl
+              << "walking:                    " << walkUs << " us/sample, "
+              << walkEvals / (2.0f * SAMPLES) << " evals/sample" << std::endl
+              << "max diff vs chunk SDF:      " << std::setprecision(4) << maxDiff << std::defaultfloat << std::endl;
+}
+
+// Prop scatter after meshing: worker cost, and instance data against baking props into meshes
+void benchScatter(int radius) {
+    VolumeGenerator generator;
+    auto chunks = makeChunks(radius);
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== Prop scatter: " << chunks.size() << " chunks ===" << std::endl;
+
+    PropMeshes meshes = buildPropMeshes();
+    ChunkProps props;
+    std::array<uint64_t, PROP_TYPE_COUNT> totals{};
+    uint64_t bakedVertices = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        scatterChunkProps(*chunk, props);
+        for (int type = 0; type < PROP_TYPE_COUNT; type++) {
+            totals[type] += props.counts[type];
+            bakedVertices += static_cast<uint64_t>(props.counts[type]) * meshes.counts[type];
+        }
+    }
+    double us = elapsedMs(start) * 1000.0 / chunks.size();
+
+    uint64_t instances = totals[0] + totals[1];
+    std::cout << std::fixed << std::setprecision(1)
+              << "scatter time:               " << us << " us/chunk" << std::endl
+              << "instances:                  " << instances << " (" << totals[0] << " rocks, "
+              << totals[1] << " shrubs)" << std::endl
+              << "instance data:              " << instances * sizeof(PropInstance) / 1024.0 << " KB" << std::endl
+              << "baked into meshes:          " << bakedVertices * sizeof(MarchingCubesVertex) / 1024.0
+              << " KB (" << bakedVertices << " vertices)" << std::defaultfloat << std::endl;
+}
+
+// Upload stage simulated with the real mesh sizes, arriving in random order either steadily or
+// all at once (a regenerate or teleport): the old FIFO (3 meshes or 1.5 ms per frame) against
+// the priority scheduler under its byte budget.
+// Cost model: a fixed per-mesh cost (buffer allocation, submit) plus bytes at memcpy speed.
+void benchUploadScheduling(int radius) {
+    constexpr double MESH_OVERHEAD_MS = 0.05;
+    constexpr double CPU_BYTES_PER_MS = 2.0e6;
+    constexpr double GPU_BYTES_PER_MS = 4.0e6;
+    constexpr int FIFO_UPLOADS = 3;
+    constexpr double FIFO_BUDGET_MS = 1.5;
+
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    auto chunks = makeChunks(std::max(radius, 3));
+    struct Mesh {
+        uint64_t bytes;
+        float distance;
+        bool visible;  // Camera at the origin looking down -z with a 90 degree view
+        int arrival = 0;
+        int uploaded = -1;
+    };
+    std::vector<Mesh> meshes;
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+        glm::vec3 center = chunkToWorldPos(chunk->coord) + glm::vec3(CHUNK_WORLD_SIZE * 0.5f);
+        meshes.push_back({sizeof(MarchingCubesVertex) * mesher.generateMesh(*chunk).size(), glm::length(center),
+                          -center.z > std::abs(center.x)});
+    }
+    std::mt19937 rng(3);
+    std::shuffle(meshes.begin(), meshes.end(), rng);
+
+    auto uploadMs = [](const Mesh& mesh) {
+        return mesh.bytes > 0 ? MESH_OVERHEAD_MS + mesh.bytes / CPU_BYTES_PER_MS : 0.0;
+    };
+
+    std::cout << std::endl << "=== Upload scheduling: " << meshes.size() << " meshes ===" << std::endl;
+
+    for (int run = 0; run < 4; run++) {
+        int arrivalsPerFrame = run < 2 ? 8 : static_cast<int>(meshes.size());
+        bool scheduled = run % 2 == 1;
+        std::vector<Mesh> sim = meshes;
+        std::vector<size_t> ready;
+        UploadThroughput throughput;
+        UploadSchedulerSettings settings;
+        size_t arrived = 0;
+        size_t uploaded = 0;
+        int frame = 0;
+        double maxFrameMs = 0.0;
+        for (; uploaded < sim.size(); frame++) {
+            for (int i = 0; i < arrivalsPerFrame && arrived < sim.size(); i++) {
+                sim[arrived].arrival = frame;
+                ready.push_back(arrived++);
+            }
+
+            double frameMs = 0.0;
+            uint64_t frameBytes = 0;
+            std::vector<size_t> chosen;
+            if (scheduled) {
+                std::vector<UploadCandidate> candidates;
+                for (uint32_t i = 0; i < ready.size(); i++) {
+                    const Mesh& mesh = sim[ready[i]];
+                    candidates.push_back({i, mesh.bytes, mesh.distance, mesh.visible, false});
+                }
+                size_t count = selectUploads(candidates, throughput.frameByteBudget(settings), settings.maxUploads);
+                for (size_t i = 0; i < count; i++) {
+                    chosen.push_back(candidates[i].index);
+                }
+            } else {
+                for (size_t i = 0; i < ready.size() && static_cast<int>(i) < FIFO_UPLOADS; i++) {
+                    if (frameMs >= FIFO_BUDGET_MS) {
+                        break;
+                    }
+                    frameMs += uploadMs(sim[ready[i]]);
+                    chosen.push_back(i);
+                }
+                frameMs = 0.0;
+            }
+
+            std::sort(chosen.rbegin(), chosen.rend());
+            for (size_t i : chosen) {
+                Mesh& mesh = sim[ready[i]];
+                mesh.uploaded = frame;
+                frameMs += uploadMs(mesh);
+                frameBytes += mesh.bytes;
+                ready.erase(ready.begin() + i);
+                uploaded++;
+            }
+            throughput.addCpuSample(frameBytes, static_cast<float>(frameMs));
+            throughput.addGpuSample(frameBytes, static_cast<float>(frameBytes / GPU_BYTES_PER_MS));
+            maxFrameMs = std::max(maxFrameMs, frameMs);
+        }
+
+        int visibleDone = 0;
+        double visibleWait = 0.0;
+        int visibleCount = 0;
+        for (const Mesh& mesh : sim) {
+            if (mesh.visible) {
+                visibleDone = std::max(visibleDone, mesh.uploaded);
+                visibleWait += mesh.uploaded - mesh.arrival;
+                visibleCount++;
+            }
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(3) << arrivalsPerFrame << " per frame, "
+                  << (scheduled ? "priority + byte budget: " : "FIFO 3/frame, 1.5 ms:   ")
+                  << "view complete at frame " << visibleDone << ", mean wait in view "
+                  << visibleWait / std::max(visibleCount, 1) << " frames, all done at frame " << frame
+                  << ", max " << maxFrameMs << " ms/frame" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Horizon culling from eye height at a few spots: cost of the sweep and the tests, how many
+// meshed chunks it rejects, and whether any rejected vertex is actually in sight (ray-marched
+// through the generator's SDF)
+void benchHorizonCulling(int radius) {
+    constexpr int VIEWPOINTS = 8;
+    constexpr int REPEATS = 20;
+    constexpr float EYE_HEIGHT = 1.7f;
+    constexpr float MARCH_STEP = 0.25f;
+    constexpr int VERTEX_STRIDE = 16;   // Rejected-mesh vertices ray-marched per check
+    const int columnRadius = std::max(radius, 4);
+
+    // Columns loaded like the chunk manager does: every chunk that can hold surface
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    std::vector<std::unique_ptr<VolumeChunk>> chunks;
+    std::vector<std::vector<MarchingCubesVertex>> meshes;
+    for (int x = -columnRadius; x <= columnRadius; x++) {
+        for (int z = -columnRadius; z <= columnRadius; z++) {
+            ColumnSurfaceBounds bounds = generator.estimateColumnBounds({x, z});
+            if (!bounds.hasSurface) {
+                continue;
+            }
+            int minY = worldToChunkCoord(glm::vec3(0.0f, bounds.minY, 0.0f)).y;
+            int maxY = worldToChunkCoord(glm::vec3(0.0f, bounds.maxY, 0.0f)).y;
+            for (int y = minY; y <= maxY; y++) {
+                auto chunk = std::make_unique<VolumeChunk>();
+                chunk->coord = {x, y, z};
+                generator.generateChunk(*chunk);
+                chunk->solidBase = countSolidBase(*chunk);
+                meshes.push_back(mesher.generateMesh(*chunk));
+                chunk->drawnMin = glm::vec3(std::numeric_limits<float>::max());
+                chunk->drawnMax = glm::vec3(std::numeric_limits<float>::lowest());
+                for (const MarchingCubesVertex& vertex : meshes.back()) {
+                    chunk->drawnMin = glm::min(chunk->drawnMin, vertex.pos);
+                    chunk->drawnMax = glm::max(chunk->drawnMax, vertex.pos);
+                }
+                chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+
+    std::vector<HorizonChunk> horizonChunks;
+    for (auto& chunk : chunks) {
+        horizonChunks.push_back({chunk->coord, chunk->solidBase});
+    }
+    std::vector<HorizonColumn> columns;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; i++) {
+        std::vector<HorizonChunk> scratch = horizonChunks;
+        buildHorizonColumns(scratch, columns);
+    }
+    double columnsUs = elapsedMs(start) * 1000.0 / REPEATS;
+
+    std::cout << std::endl << "=== Horizon culling: " << chunks.size() << " chunks, " << columns.size()
+              << " solid columns ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "columns rebuild:            " << columnsUs << " us" << std::endl;
+
+    HorizonCuller culler;
+    HorizonSettings settings;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> spot(-CHUNK_WORLD_SIZE * 2.0f, CHUNK_WORLD_SIZE * 2.0f);
+    double buildUs = 0.0;
+    double testUs = 0.0;
+    size_t meshed = 0;
+    size_t hidden = 0;
+    size_t checked = 0;
+    size_t visibleVertices = 0;
+    for (int view = 0; view < VIEWPOINTS; view++) {
+        // Eye height above the topmost surface at a random spot
+        glm::vec3 eye(spot(rng), 0.0f, spot(rng));
+        eye.y = 128.0f;
+        while (eye.y > -64.0f && generator.generateSDF(eye) <= 0.0f) {
+            eye.y -= MARCH_STEP;
+        }
+        eye.y += EYE_HEIGHT;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPEATS; i++) {
+            culler.build(eye, columns, settings);
+        }
+        buildUs += elapsedMs(start) * 1000.0 / REPEATS;
+
+        std::vector<size_t> rejected;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPEATS; i++) {
+            rejected.clear();
+            for (size_t c = 0; c < chunks.size(); c++) {
+                if (!meshes[c].empty() && culler.isHidden(chunks[c]->drawnMin, chunks[c]->drawnMax)) {
+                    rejected.push_back(c);
+                }
+            }
+        }
+        testUs += elapsedMs(start) * 1000.0 / REPEATS;
+
+        for (size_t c = 0; c < chunks.size(); c++) {
+            meshed += meshes[c].empty() ? 0 : 1;
+        }
+        hidden += rejected.size();
+
+        // Any sample inside solid blocks the sight line; the last voxel is the surface itself
+        for (size_t c : rejected) {
+            for (size_t v = 0; v < meshes[c].size(); v += VERTEX_STRIDE) {
+                glm::vec3 target = meshes[c][v].pos;
+                float length = glm::distance(eye, target);
+                glm::vec3 dir = (target - eye) / length;
+                bool blocked = false;
+                for (float t = MARCH_STEP; t < length - VOXEL_SIZE && !blocked; t += MARCH_STEP) {
+                    blocked = generator.generateSDF(eye + dir * t) > 0.0f;
+                }
+                checked++;
+                visibleVertices += blocked ? 0 : 1;
+            }
+        }
+    }
+
+    std::cout << "sweep:                      " << buildUs / VIEWPOINTS << " us" << std::endl
+              << "tests:                      " << testUs / VIEWPOINTS << " us ("
+              << testUs * 1000.0 / std::max<size_t>(meshed, 1) << " ns/chunk)" << std::endl
+              << "rejected:                   " << hidden / VIEWPOINTS << " of " << meshed / VIEWPOINTS
+              << " meshed chunks per view" << std::endl
+              << "rejected vertices in sight: " << visibleVertices << " of " << checked << " checked" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+// What the memory governor reads on this machine, what a poll costs, and where the
+// default thresholds put each shed level
+void benchMemoryGovernor() {
+    constexpr int POLLS = 200;
+    MemoryGovernor governor;
+    MemoryGovernorSettings settings;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < POLLS; i++) {
+        governor.update(settings);
+    }
+    double pollUs = elapsedMs(start) * 1000.0 / POLLS;
+
+    std::cout << std::endl << "=== Memory governor ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "signals:                    " << governor.describe() << std::endl
+              << "level:                      " << memoryShedLevelName(governor.getLevel()) << std::endl
+              << "poll:                       " << pollUs << " us" << std::endl;
+
+    MemorySignals signals;
+    signals.hasLimit = true;
+    signals.limitBytes = 1000;
+    for (int level = 1; level < static_cast<int>(MemoryShedLevel::Count); level++) {
+        int usage = 0;
+        while (usage < 1000 && static_cast<int>(targetShedLevel(signals, settings)) < level) {
+            signals.usageBytes = ++usage;
+        }
+        std::cout << "sheds " << std::left << std::setw(22) << memoryShedLevelName(static_cast<MemoryShedLevel>(level))
+                  << std::right << "at " << usage / 10.0 << "% of the limit or PSI "
+                  << settings.pressureStart * static_cast<float>(1 << (level - 1)) << "%" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Thousands of stamps over a 512 m square. Binned: each chunk evaluates only the stamps
+// overlapping it. Unbinned: every stamp is tested at every voxel (a few chunks only).
+void benchStamps(int radius) {
+    constexpr int STAMP_COUNT = 4000;
+    constexpr float AREA = 512.0f;
+    constexpr size_t UNBINNED_CHUNKS = 4;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<SdfStamp> stamps;
+    for (int i = 0; i < STAMP_COUNT; i++) {
+        SdfStamp stamp;
+        stamp.shape = static_cast<StampShape>(rng() % static_cast<int>(StampShape::Count));
+        stamp.op = static_cast<StampOp>(rng() % static_cast<int>(StampOp::Count));
+        stamp.center = glm::vec3((unit(rng) - 0.5f) * AREA, -8.0f + 32.0f * unit(rng), (unit(rng) - 0.5f) * AREA);
+        stamp.size = glm::vec3(1.0f + 3.0f * unit(rng), 1.0f + 5.0f * unit(rng), 1.0f + 3.0f * unit(rng));
+        stamp.yaw = 6.2831853f * unit(rng);
+        stamp.blend = 1.0f + 2.0f * unit(rng);
+        stamps.push_back(stamp);
+    }
+
+    VolumeGenerator plain;
+    VolumeGenerator stamped;
+    auto start = std::chrono::steady_clock::now();
+    stamped.setStamps(stamps);
+    double binMs = elapsedMs(start);
+
+    auto plainChunks = makeChunks(radius);
+    auto stampedChunks = makeChunks(radius);
+    std::cout << std::endl << "=== Stamps: " << STAMP_COUNT << " over " << AREA << " m, "
+              << stampedChunks.size() << " chunks ===" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (auto& chunk : plainChunks) {
+        plain.generateChunk(*chunk);
+    }
+    double plainMs = elapsedMs(start) / plainChunks.size();
+
+    start = std::chrono::steady_clock::now();
+    for (auto& chunk : stampedChunks) {
+        stamped.generateChunk(*chunk);
+    }
+    double binnedMs = elapsedMs(start) / stampedChunks.size();
+
+    size_t candidates = 0;
+    size_t changedVoxels = 0;
+    for (size_t i = 0; i < stampedChunks.size(); i++) {
+        const std::vector<uint32_t>* bin = stamped.getStamps().chunkCandidates(stampedChunks[i]->coord);
+        candidates += bin ? bin->size() : 0;
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    changedVoxels += stampedChunks[i]->sdf->at(x, y, z) != plainChunks[i]->sdf->at(x, y, z);
+                }
+            }
+        }
+    }
+
+    // Unbinned on the chunks with the most candidates, must match the binned result exactly
+    std::vector<size_t> order(stampedChunks.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    auto binSize = [&](size_t i) {
+        const std::vector<uint32_t>* bin = stamped.getStamps().chunkCandidates(stampedChunks[i]->coord);
+        return bin ? bin->size() : 0;
+    };
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return binSize(a) > binSize(b); });
+    order.resize(std::min(order.size(), UNBINNED_CHUNKS));
+
+    std::vector<uint32_t> everyStamp(STAMP_COUNT);
+    for (uint32_t i = 0; i < everyStamp.size(); i++) {
+        everyStamp[i] = i;
+    }
+    float unbinnedDiff = 0.0f;
+    start = std::chrono::steady_clock::now();
+    for (size_t i : order) {
+        glm::vec3 origin = chunkToWorldPos(plainChunks[i]->coord);
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    glm::vec3 worldPos = origin + glm::vec3(x * VOXEL_SIZE, y * VOXEL_SIZE, z * VOXEL_SIZE);
+                    float value = stamped.getStamps().apply(everyStamp, worldPos, plainChunks[i]->sdf->at(x, y, z));
+                    unbinnedDiff = std::max(unbinnedDiff, std::abs(value - stampedChunks[i]->sdf->at(x, y, z)));
+                }
+            }
+        }
+    }
+    double unbinnedMs = elapsedMs(start) / order.size() + plainMs;
+
+    // Point queries (collision fallback, coarse meshes) see the same field
+    std::uniform_int_distribution<int> voxel(0, CHUNK_SIZE - 1);
+    float pointDiff = 0.0f;
+    for (int i = 0; i < 20000; i++) {
+        const VolumeChunk& chunk = *stampedChunks[rng() % stampedChunks.size()];
+        glm::ivec3 v(voxel(rng), voxel(rng), voxel(rng));
+        glm::vec3 worldPos = chunkToWorldPos(chunk.coord) + glm::vec3(v) * VOXEL_SIZE;
+        pointDiff = std::max(pointDiff, std::abs(stamped.generateSDF(worldPos) - chunk.sdf->at(v.x, v.y, v.z)));
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "binning:                    " << binMs << " ms for all stamps" << std::endl
+              << "candidates:                 " << static_cast<double>(candidates) / stampedChunks.size()
+              << " stamps/chunk, " << 100.0 * changedVoxels / (stampedChunks.size() * VOXELS_PER_CHUNK)
+              << "% of voxels changed" << std::endl
+              << "terrain only:               " << plainMs << " ms/chunk" << std::endl
+              << "binned stamps:              " << binnedMs << " ms/chunk" << std::endl
+              << "unbinned (busiest chunks):  " << unbinnedMs << " ms/chunk" << std::endl
+              << "max |binned - unbinned|:    " << unbinnedDiff << std::endl
+              << "max |generateSDF - chunk|:  " << pointDiff << std::defaultfloat << std::endl;
+}
+
+// Per-chunk navigation graphs: build cost on a worker, stitching, and path queries/s with the
+// region-level (hierarchical) search against plain A* over every node
+void benchNavigation(int radius) {
+    constexpr int QUERIES = 200;
+    VolumeGenerator generator;
+    auto chunks = makeChunks(std::max(radius, 2));
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== Navigation: " << chunks.size() << " chunks ===" << std::endl;
+
+    NavWorld world;
+    std::vector<std::unique_ptr<ChunkNavGraph>> built;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : chunks) {
+        auto graph = std::make_unique<ChunkNavGraph>();
+        buildChunkNavGraph(*chunk, world.getSettings(), *graph);
+        built.push_back(std::move(graph));
+    }
+    double buildMs = elapsedMs(start) / chunks.size();
+
+    start = std::chrono::steady_clock::now();
+    for (auto& graph : built) {
+        world.addChunk(std::move(graph));
+    }
+    double stitchMs = elapsedMs(start) / chunks.size();
+
+    // Endpoints on random nodes, so most pairs are connected
+    std::vector<glm::vec3> positions;
+    for (auto& chunk : chunks) {
+        ChunkNavGraph graph;
+        buildChunkNavGraph(*chunk, world.getSettings(), graph);
+        for (const NavNode& node : graph.nodes) {
+            positions.push_back(node.position);
+        }
+    }
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, positions.size() - 1);
+    std::vector<std::pair<glm::vec3, glm::vec3>> queries;
+    for (int i = 0; i < QUERIES; i++) {
+        queries.emplace_back(positions[pick(rng)], positions[pick(rng)]);
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "build:                      " << buildMs << " ms/chunk" << std::endl
+              << "stitch:                     " << stitchMs << " ms/chunk" << std::endl
+              << "graph:                      " << world.nodeCount() << " nodes, " << world.linkCount()
+              << " border links" << std::endl;
+
+    std::vector<glm::vec3> path;
+    for (bool hierarchical : {true, false}) {
+        NavPathStats stats;
+        int found = 0;
+        double length = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& [from, to] : queries) {
+            bool ok = hierarchical ? world.findPath(from, to, path, &stats) : world.findPathFlat(from, to, path, &stats);
+            if (ok) {
+                found++;
+                for (size_t i = 1; i < path.size(); i++) {
+                    length += glm::distance(path[i - 1], path[i]);
+                }
+            }
+        }
+        double ms = elapsedMs(start);
+        std::cout << (hierarchical ? "hierarchical A*:            " : "flat A*:                    ")
+                  << std::setprecision(0) << QUERIES * 1000.0 / ms << " queries/s, " << found << "/" << QUERIES
+                  << " found, " << stats.nodesExpanded / QUERIES << " nodes + " << stats.regionsExpanded / QUERIES
+                  << " regions expanded, mean length " << std::setprecision(1) << (found ? length / found : 0.0)
+                  << " m" << std::setprecision(3) << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Copy a chunk's SDF into another storage layout
+template<typename Layout>
+std::unique_ptr<SdfGrid<Layout>> convertGrid(const VolumeChunk& chunk) {
+    auto grid = std::make_unique<SdfGrid<Layout>>();
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                grid->at(x, y, z) = chunk.sdf->at(x, y, z);
+            }
+        }
+    }
+    return grid;
+}
+
+template<typename Layout>
+void benchLayout(const char* name, const std::vector<std::unique_ptr<VolumeChunk>>& chunks) {
+    constexpr int SAMPLES_PER_CHUNK = 200000;
+
+    std::vector<std::unique_ptr<SdfGrid<Layout>>> grids;
+    for (const auto& chunk : chunks) {
+        grids.push_back(convertGrid<Layout>(*chunk));
+    }
+
+    MarchingCubes mesher;
+    size_t vertexCount = 0;
+    auto meshStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < grids.size(); i++) {
+        vertexCount += mesher.generateMesh(*grids[i], chunkToWorldPos(chunks[i]->coord), VOXEL_SIZE).size();
+    }
+    double meshMs = elapsedMs(meshStart) / grids.size();
+
+    // Random trilinear samples, like physics probes landing anywhere in a chunk
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coordinate(0.0f, CHUNK_SIZE - 1.001f);
+    float checksum = 0.0f;
+    auto sampleStart = std::chrono::steady_clock::now();
+    for (const auto& grid : grids) {
+        for (int i = 0; i < SAMPLES_PER_CHUNK; i++) {
+            float x = coordinate(rng);
+            float y = coordinate(rng);
+            float z = coordinate(rng);
+            int x0 = static_cast<int>(x);
+            int y0 = static_cast<int>(y);
+            int z0 = static_cast<int>(z);
+            checksum += grid->trilinear(x0, y0, z0, x - x0, y - y0, z - z0);
+        }
+    }
+    double sampleNs = elapsedMs(sampleStart) * 1e6 / (static_cast<double>(grids.size()) * SAMPLES_PER_CHUNK);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << name << "mesh " << meshMs << " ms/chunk, random sample " << std::setprecision(1)
+              << sampleNs << " ns  (" << vertexCount << " verts, checksum " << checksum << ")"
+              << std::defaultfloat << std::endl;
+}
+
+void benchSdfLayouts(int radius) {
+    VolumeGenerator generator;
+    auto chunks = makeChunks(radius);
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== SDF layouts: " << chunks.size() << " chunks ===" << std::endl;
+    benchLayout<RowMajorLayout<CHUNK_CUBES>>("row-major:  ", chunks);
+    benchLayout<Tiled4Layout<CHUNK_CUBES>>("tiled 4^3:  ", chunks);
+    benchLayout<MortonLayout<CHUNK_CUBES>>("morton:     ", chunks);
+}
+
+void benchHeightfields(int radius) {
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    auto chunks = makeChunks(radius);
+    for (auto& chunk : chunks) {
+        generator.generateChunk(*chunk);
+    }
+
+    std::cout << std::endl << "=== Heightfield chunks: " << chunks.size() << " chunks ===" << std::endl;
+
+    // Convert a copy so the volumetric mesh and samples of the same chunk stay available
+    std::vector<size_t> converted;
+    std::vector<std::unique_ptr<HeightfieldData>> fields;
+    auto buildStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        auto field = std::make_unique<HeightfieldData>();
+        if (buildHeightfield(*chunks[i]->sdf, *field)) {
+            converted.push_back(i);
+            fields.push_back(std::move(field));
+        }
+    }
+    double buildUs = elapsedMs(buildStart) * 1000.0 / chunks.size();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "convertible:                " << converted.size() << " / " << chunks.size()
+              << " (detect " << buildUs << " us/chunk)" << std::endl
+              << "memory per chunk:           " << sizeof(HeightfieldData) / 1024.0 << " KB vs "
+              << sizeof(ChunkSdfGrid) / 1024.0 << " KB" << std::endl;
+    if (converted.empty()) {
+        std::cout << std::defaultfloat;
+        return;
+    }
+
+    size_t cubeTriangles = 0;
+    auto cubeStart = std::chrono::steady_clock::now();
+    for (size_t i : converted) {
+        MeshStats stats;
+        mesher.generateMesh(*chunks[i]->sdf, chunkToWorldPos(chunks[i]->coord), VOXEL_SIZE, &stats);
+        cubeTriangles += stats.trianglesEmitted;
+    }
+    double cubeMs = elapsedMs(cubeStart) / converted.size();
+
+    size_t gridTriangles = 0;
+    auto gridStart = std::chrono::steady_clock::now();
+    for (size_t j = 0; j < converted.size(); j++) {
+        MeshStats stats;
+        mesher.generateHeightfieldMesh(*fields[j], chunkToWorldPos(chunks[converted[j]]->coord), VOXEL_SIZE, &stats);
+        gridTriangles += stats.trianglesEmitted;
+    }
+    double gridMs = elapsedMs(gridStart) / converted.size();
+
+    // Collision probes near the surface: heightfield sample vs the full SDF
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coordinate(0.0f, CHUNK_SIZE - 1.001f);
+    std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+    float maxError = 0.0f;
+    for (size_t j = 0; j < converted.size(); j++) {
+        const ChunkSdfGrid& grid = *chunks[converted[j]]->sdf;
+        for (int i = 0; i < 10000; i++) {
+            float x = coordinate(rng);
+            float z = coordinate(rng);
+            int x0 = static_cast<int>(x);
+            int z0 = static_cast<int>(z);
+            float y = std::clamp(fields[j]->cell[x0][z0] + offset(rng), 0.0f, CHUNK_SIZE - 1.001f);
+            int y0 = static_cast<int>(y);
+            float a = grid.trilinear(x0, y0, z0, x - x0, y - y0, z - z0);
+            float b = fields[j]->trilinear(x0, y0, z0, x - x0, y - y0, z - z0);
+            maxError = std::max(maxError, std::abs(a - b));
+        }
+    }
+
+    std::cout << "cube mesher:                " << cubeMs << " ms/chunk (" << cubeTriangles << " tris)" << std::endl
+              << "heightfield mesher:         " << gridMs << " ms/chunk (" << gridTriangles << " tris)" << std::endl
+              << "collision max error (+-2):  " << std::setprecision(4) << maxError << std::defaultfloat << std::endl;
+}
+
+// Main-thread frame jitter while generation workers are saturated, with the thread policy
+// off and on. A "frame" meshes one chunk, then sleeps to an 8 ms frame boundary.
+void benchThreadPolicy(int radius) {
+    constexpr int FRAMES = 120;
+    constexpr auto FRAME_PERIOD = std::chrono::milliseconds(8);
+
+    VolumeGenerator generator;
+    MarchingCubes mesher;
+    VolumeChunk frameChunk;
+    frameChunk.coord = {0, 0, 0};
+    generator.generateChunk(frameChunk);
+
+    CpuTopology topology = CpuTopology::detect();
+    std::cout << std::endl << "=== Frame jitter with saturated workers: " << topology.describe() << " ===" << std::endl;
+
+    ThreadPolicy unmanaged;
+    unmanaged.pinMainThread = 0;
+    unmanaged.workerNice = 0;
+    unmanaged.workerSchedBatch = 0;
+    ThreadLayout unpinned = planThreadLayout(topology, unmanaged);
+
+    struct Run {
+        const char* name;
+        ThreadPolicy policy;
+        bool workers;
+    };
+    const Run runs[] = {{"no workers:     ", unmanaged, false},
+                        {"no policy:      ", unmanaged, true},
+                        {"thread policy:  ", ThreadPolicy{}, true}};
+
+    for (const Run& run : runs) {
+        ThreadLayout layout = planThreadLayout(topology, run.policy);
+        bool pinned = pinCurrentThread(layout.mainCpus);
+
+        std::atomic<bool> running{true};
+        std::atomic<int> policyFailures{0};
+        std::vector<std::thread> workers;
+        for (unsigned int i = 0; run.workers && i < layout.workerCount; i++) {
+            workers.emplace_back([&, radius]() {
+                if (!pinCurrentThread(layout.workerCpus) ||
+                    !setCurrentThreadBackground(run.policy.workerNice, run.policy.workerSchedBatch != 0)) {
+                    policyFailures++;
+                }
+                auto chunks = makeChunks(radius);
+                while (running.load()) {
+                    for (auto& chunk : chunks) {
+                        generator.generateChunk(*chunk);
+                    }
+                }
+            });
+        }
+
+        std::vector<double> frameMs;
+        auto deadline = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < FRAMES; frame++) {
+            auto start = std::chrono::steady_clock::now();
+            mesher.generateMesh(frameChunk);
+            frameMs.push_back(elapsedMs(start));
+            deadline = std::max(deadline + FRAME_PERIOD, std::chrono::steady_clock::now());
+            std::this_thread::sleep_until(deadline);
+        }
+
+        running.store(false);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        double mean = 0.0;
+        for (double ms : frameMs) {
+            mean += ms / FRAMES;
+        }
+        double variance = 0.0;
+        for (double ms : frameMs) {
+            variance += (ms - mean) * (ms - mean) / FRAMES;
+        }
+        std::sort(frameMs.begin(), frameMs.end());
+        std::cout << std::fixed << std::setprecision(2) << run.name << "frame work avg " << mean
+                  << " ms, sd " << std::sqrt(variance) << ", p99 " << frameMs[FRAMES * 99 / 100]
+                  << ", max " << frameMs.back() << std::defaultfloat;
+        if (!pinned || policyFailures.load() > 0) {
+            std::cout << " (policy partly refused by the OS)";
+        }
+        std::cout << std::endl;
+    }
+
+    pinCurrentThread(unpinned.mainCpus);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int radius = argc > 1 ? std::max(0, std::atoi(argv[1])) : 1;
+
+    benchGenerator(radius);
+    benchTiledNoise(radius);
+    benchUrgentLatency(radius);
+    bool ok = benchSdfMips(radius);
+    benchMesher(radius);
+    benchProgressive(radius);
+    benchUploadScheduling(radius);
+    benchCollisionFallback(radius);
+    benchScatter(radius);
+    benchNavigation(radius);
+    benchStamps(radius);
+    benchHorizonCulling(radius);
+    benchMemoryGovernor();
+    benchSdfLayouts(radius);
+    benchHeightfields(radius);
+    benchThreadPolicy(radius);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+#include "thread_topology.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const std::string SYSFS_CPU = "/sys/devices/system/cpu/cpu";
+
+    // First integer in a sysfs file, or `fallback` if it can't be read
+    int readSysfsInt(const std::string& path, int fallback) {
+        std::ifstream file(path);
+        int value;
+        return file >> value ? value : fallback;
+    }
+
+    std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int cpu = 0; cpu < count; cpu++) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    std::vector<int> cpusOf(const std::vector<CpuCore>& cores) {
+        std::vector<int> cpus;
+        for (const CpuCore& core : cores) {
+            cpus.insert(cpus.end(), core.cpus.begin(), core.cpus.end());
+        }
+        std::sort(cpus.begin(), cpus.end());
+        return cpus;
+    }
+}
+
+CpuTopology CpuTopology::detect() {
+    // Logical CPUs without topology files become single-CPU cores with their own id
+    std::map<std::pair<int, int>, CpuCore> cores;
+    for (int cpu : allowedCpus()) {
+        std::string base = SYSFS_CPU + std::to_string(cpu);
+        int package = readSysfsInt(base + "/topology/physical_package_id", 0);
+        int coreId = readSysfsInt(base + "/topology/core_id", -1 - cpu);
+        CpuCore& core = cores[{package, coreId}];
+        core.package = package;
+        core.coreId = coreId;
+        core.maxFreqKhz = std::max(core.maxFreqKhz, readSysfsInt(base + "/cpufreq/cpuinfo_max_freq", 0));
+        core.cpus.push_back(cpu);
+    }
+
+    CpuTopology topology;
+    for (auto& [key, core] : cores) {
+        topology.cores.push_back(std::move(core));
+    }
+    // Ordered by first logical CPU, the order the OS numbers them in
+    std::sort(topology.cores.begin(), topology.cores.end(),
+              [](const CpuCore& a, const CpuCore& b) { return a.cpus.front() < b.cpus.front(); });
+    return topology;
+}
+
+size_t CpuTopology::logicalCpuCount() const {
+    size_t count = 0;
+    for (const CpuCore& core : cores) {
+        count += core.cpus.size();
+    }
+    return count;
+}
+
+std::string CpuTopology::describe() const {
+    std::ostringstream text;
+    text << cores.size() << " cores / " << logicalCpuCount() << " logical CPUs:";
+    for (const CpuCore& core : cores) {
+        text << " [";
+        for (size_t i = 0; i < core.cpus.size(); i++) {
+            text << (i > 0 ? "," : "") << core.cpus[i];
+        }
+        text << "]";
+    }
+    return text.str();
+}
+
+ThreadLayout planThreadLayout(const CpuTopology& topology, const ThreadPolicy& policy) {
+    ThreadLayout layout;
+    std::vector<int> allCpus = cpusOf(topology.cores);
+    layout.mainCpus = allCpus;
+    layout.workerCpus = allCpus;
+    // Unpinned: one worker per CPU but one, as before there was a policy
+    layout.workerCount = allCpus.size() > 1 ? static_cast<unsigned int>(allCpus.size() - 1) : 1;
+
+    if (!policy.pinMainThread || topology.cores.size() < 2) {
+        return layout;
+    }
+
+    // Fastest core, skipping the first when another is as fast
+    const CpuCore* mainCore = &topology.cores[1];
+    for (const CpuCore& core : topology.cores) {
+        if (core.maxFreqKhz > mainCore->maxFreqKhz) {
+            mainCore = &core;
+        }
+    }
+    layout.mainCpus = {mainCore->cpus.front()};
+
+    const std::vector<int>& reserved = policy.reserveSiblings ? mainCore->cpus : layout.mainCpus;
+    layout.workerCpus.clear();
+    for (int cpu : allCpus) {
+        if (std::find(reserved.begin(), reserved.end(), cpu) == reserved.end()) {
+            layout.workerCpus.push_back(cpu);
+        }
+    }
+    layout.workerCount = static_cast<unsigned int>(layout.workerCpus.size());
+    return layout;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool setCurrentThreadBackground(int nice, bool schedBatch) {
+#ifdef __linux__
+    // Linux applies both per thread: pid 0 and the thread id name the calling thread only
+    sched_param param{};
+    bool ok = sched_setscheduler(0, schedBatch ? SCHED_BATCH : SCHED_OTHER, &param) == 0;
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) == 0 && ok;
+#else
+    (void)nice;
+    (void)schedBatch;
+    return false;
+#endif
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A physical core and the logical CPUs (SMT siblings) that share it
+struct CpuCore {
+    int package = 0;
+    int coreId = 0;
+    int maxFreqKhz = 0;     // 0 if cpufreq isn't exposed
+    std::vector<int> cpus;  // Logical CPU numbers, ascending
+};
+
+// Cores this process may run on, read from sysfs and limited to the current affinity mask
+// (so taskset and cgroup cpusets are respected). Without sysfs every logical CPU counts
+// as its own core.
+struct CpuTopology {
+    std::vector<CpuCore> cores;
+
+    static CpuTopology detect();
+    size_t logicalCpuCount() const;
+    std::string describe() const;
+};
+
+// How threads are laid out over the cores; the ints are tuning switches (see registerTuning)
+struct ThreadPolicy {
+    int pinMainThread = 1;     // Main (render + simulation) thread gets a physical core to itself
+    int reserveSiblings = 1;   // Keep workers off the SMT siblings of the main thread's core
+    int workerNice = 10;       // Nice value of generation workers (0 = same as the main thread)
+    int workerSchedBatch = 1;  // Run workers under SCHED_BATCH, so they never preempt interactive threads
+};
+
+// CPU sets are never empty: unpinned threads get every CPU in the topology. New threads
+// inherit their creator's affinity, so workers must apply workerCpus themselves.
+struct ThreadLayout {
+    std::vector<int> mainCpus;
+    std::vector<int> workerCpus;
+    unsigned int workerCount = 1;
+};
+
+// The main thread goes on the fastest core other than the first one (which tends to take
+// interrupts); workers get one thread per logical CPU left over.
+ThreadLayout planThreadLayout(const CpuTopology& topology, const ThreadPolicy& policy);
+
+// Both apply to the calling thread only and return false if the OS refused (or the
+// platform has no such API)
+bool pinCurrentThread(const std::vector<int>& cpus);
+bool setCurrentThreadBackground(int nice, bool schedBatch);
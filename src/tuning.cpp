@@ -0,0 +1,290 @@
+#include "tuning.h"
+#include "sampling_profiler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <cmath>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+    constexpr float FILE_POLL_INTERVAL = 0.5f;  // Seconds between modification time checks
+    constexpr int CONSOLE_POLL_MS = 100;        // How often the console thread checks for shutdown
+
+    std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+}
+
+TuningRegistry::~TuningRegistry() {
+    stopConsole();
+}
+
+void TuningRegistry::addInt(const std::string& name, int* value, int minValue, int maxValue,
+                            const std::string& description, std::function<void()> onChange) {
+    Param param;
+    param.intValue = value;
+    param.minValue = minValue;
+    param.maxValue = maxValue;
+    param.description = description;
+    param.onChange = std::move(onChange);
+    params[name] = std::move(param);
+}
+
+void TuningRegistry::addFloat(const std::string& name, float* value, float minValue, float maxValue,
+                              const std::string& description, std::function<void()> onChange) {
+    Param param;
+    param.floatValue = value;
+    param.minValue = minValue;
+    param.maxValue = maxValue;
+    param.description = description;
+    param.onChange = std::move(onChange);
+    params[name] = std::move(param);
+}
+
+void TuningRegistry::addCommand(const std::string& name, const std::string& description, std::function<void()> action) {
+    consoleCommands[name] = Command{description, std::move(action)};
+}
+
+bool TuningRegistry::set(const std::string& name, const std::string& text, std::string& error) {
+    auto it = params.find(name);
+    if (it == params.end()) {
+        error = "unknown parameter '" + name + "'";
+        return false;
+    }
+    Param& param = it->second;
+
+    double parsed = 0.0;
+    try {
+        size_t consumed = 0;
+        parsed = param.intValue ? std::stoi(text, &consumed) : std::stod(text, &consumed);
+        if (consumed != text.size()) {
+            throw std::invalid_argument(text);
+        }
+    } catch (const std::exception&) {
+        error = "'" + text + "' is not a valid " + (param.intValue ? "integer" : "number");
+        return false;
+    }
+
+    // Written so NaN fails too
+    if (!std::isfinite(parsed) || !(parsed >= param.minValue && parsed <= param.maxValue)) {
+        std::ostringstream message;
+        message << name << " must be in [" << param.minValue << ", " << param.maxValue << "]";
+        error = message.str();
+        return false;
+    }
+
+    bool changed;
+    if (param.intValue) {
+        changed = *param.intValue != static_cast<int>(parsed);
+        *param.intValue = static_cast<int>(parsed);
+    } else {
+        changed = *param.floatValue != static_cast<float>(parsed);
+        *param.floatValue = static_cast<float>(parsed);
+    }
+
+    if (changed) {
+        std::cout << "[tuning] " << name << " = " << formatValue(param) << std::endl;
+        if (param.onChange) {
+            param.onChange();
+        }
+    }
+    return true;
+}
+
+std::string TuningRegistry::formatValue(const Param& param) const {
+    std::ostringstream text;
+    if (param.intValue) {
+        text << *param.intValue;
+    } else {
+        text << *param.floatValue;
+    }
+    return text.str();
+}
+
+void TuningRegistry::printAll() const {
+    for (const auto& [name, param] : params) {
+        std::cout << "  " << name << " = " << formatValue(param)
+                  << "  [" << param.minValue << ", " << param.maxValue << "]  "
+                  << param.description << std::endl;
+    }
+}
+
+void TuningRegistry::watchFile(const std::string& path) {
+    filePath = path;
+    std::error_code ec;
+    if (std::filesystem::exists(filePath, ec)) {
+        fileTime = std::filesystem::last_write_time(filePath, ec);
+        loadFile();
+    }
+    lastFileCheck = std::chrono::steady_clock::now();
+}
+
+void TuningRegistry::loadFile() {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        return;
+    }
+
+    std::cout << "[tuning] Loading " << filePath << std::endl;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        std::string error;
+        if (equals == std::string::npos) {
+            error = "expected 'name = value'";
+        } else {
+            set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), error);
+        }
+        if (!error.empty()) {
+            std::cout << "[tuning] " << filePath << ":" << lineNumber << ": " << error << std::endl;
+        }
+    }
+}
+
+void TuningRegistry::startConsole() {
+    if (consoleRunning.exchange(true)) {
+        return;
+    }
+
+    consoleThread = std::thread([this]() {
+        registerProfiledThread("io");
+        pollfd input{};
+        input.fd = STDIN_FILENO;
+        input.events = POLLIN;
+
+        // Raw reads of the fd rather than std::cin: poll() can't see what cin has buffered,
+        // and getline would block on a line with no newline yet
+        std::string partial;
+        char buffer[256];
+        while (consoleRunning.load()) {
+            // Poll with a timeout so stopConsole() never waits on a blocked read
+            int ready = poll(&input, 1, CONSOLE_POLL_MS);
+            if (ready <= 0) {
+                continue;
+            }
+            ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                // stdin closed; a last line without a newline still counts
+                if (!partial.empty()) {
+                    std::lock_guard<std::mutex> lock(commandMutex);
+                    pendingCommands.push(partial);
+                }
+                break;
+            }
+            partial.append(buffer, static_cast<size_t>(count));
+            size_t newline;
+            while ((newline = partial.find('\n')) != std::string::npos) {
+                std::lock_guard<std::mutex> lock(commandMutex);
+                pendingCommands.push(partial.substr(0, newline));
+                partial.erase(0, newline + 1);
+            }
+        }
+        unregisterProfiledThread();
+    });
+
+    std::cout << "[tuning] Console ready (type 'help')" << std::endl;
+}
+
+void TuningRegistry::stopConsole() {
+    consoleRunning.store(false);
+    if (consoleThread.joinable()) {
+        consoleThread.join();
+    }
+}
+
+void TuningRegistry::update() {
+    std::queue<std::string> commands;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        std::swap(commands, pendingCommands);
+    }
+    while (!commands.empty()) {
+        runCommand(commands.front());
+        commands.pop();
+    }
+
+    if (filePath.empty()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<float>(now - lastFileCheck).count() < FILE_POLL_INTERVAL) {
+        return;
+    }
+    lastFileCheck = now;
+
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(filePath, ec);
+    if (!ec && modified != fileTime) {
+        fileTime = modified;
+        loadFile();
+    }
+}
+
+void TuningRegistry::runCommand(const std::string& line) {
+    // Accepts "name = value" as well as whitespace-separated commands
+    std::string command = line;
+    size_t equals = command.find('=');
+    if (equals != std::string::npos) {
+        command = "set " + command.substr(0, equals) + " " + command.substr(equals + 1);
+    }
+
+    std::istringstream words(command);
+    std::string verb;
+    if (!(words >> verb)) {
+        return;
+    }
+
+    if (verb == "help") {
+        std::cout << "[tuning] Commands: list | get <name> | set <name> <value> | <name> = <value> | reload" << std::endl;
+        for (const auto& [name, extra] : consoleCommands) {
+            std::cout << "[tuning]   " << name << " - " << extra.description << std::endl;
+        }
+    } else if (verb == "list") {
+        printAll();
+    } else if (verb == "reload") {
+        if (filePath.empty()) {
+            std::cout << "[tuning] No config file being watched" << std::endl;
+        } else {
+            loadFile();
+        }
+    } else if (verb == "get") {
+        std::string name;
+        words >> name;
+        auto it = params.find(name);
+        if (it == params.end()) {
+            std::cout << "[tuning] unknown parameter '" << name << "'" << std::endl;
+        } else {
+            std::cout << "[tuning] " << name << " = " << formatValue(it->second) << std::endl;
+        }
+    } else if (verb == "set") {
+        std::string name;
+        std::string value;
+        words >> name >> value;
+        std::string error;
+        if (!set(name, value, error)) {
+            std::cout << "[tuning] " << error << std::endl;
+        }
+    } else if (auto it = consoleCommands.find(verb); it != consoleCommands.end()) {
+        it->second.action();
+    } else {
+        std::cout << "[tuning] Unknown command '" << verb << "' (type 'help')" << std::endl;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <queue>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+// Named, range-checked runtime parameters bound to existing variables.
+// Values come from a `name = value` file (reloaded when it changes on disk) or from
+// commands typed on stdin. Everything is applied inside update(), on the caller's thread,
+// so the bound variables need no locking.
+class TuningRegistry {
+public:
+    ~TuningRegistry();
+
+    void addInt(const std::string& name, int* value, int minValue, int maxValue,
+                const std::string& description, std::function<void()> onChange = nullptr);
+    void addFloat(const std::string& name, float* value, float minValue, float maxValue,
+                  const std::string& description, std::function<void()> onChange = nullptr);
+
+    // Extra console verb, run on the update() thread like parameter changes
+    void addCommand(const std::string& name, const std::string& description, std::function<void()> action);
+
+    // Parse and apply one value. Unknown names and out-of-range values are rejected.
+    bool set(const std::string& name, const std::string& text, std::string& error);
+
+    void printAll() const;
+
+    // Load the file now (if it exists) and again whenever its modification time changes
+    void watchFile(const std::string& path);
+
+    // Read commands from stdin on a background thread
+    void startConsole();
+    void stopConsole();
+
+    // Apply queued console commands and file changes. Call once per frame.
+    void update();
+
+private:
+    struct Param {
+        int* intValue = nullptr;
+        float* floatValue = nullptr;
+        double minValue = 0.0;
+        double maxValue = 0.0;
+        std::string description;
+        std::function<void()> onChange;
+    };
+
+    struct Command {
+        std::string description;
+        std::function<void()> action;
+    };
+
+    std::map<std::string, Param> params;
+    std::map<std::string, Command> consoleCommands;
+
+    std::string filePath;
+    std::filesystem::file_time_type fileTime{};
+    std::chrono::steady_clock::time_point lastFileCheck{};
+
+    std::thread consoleThread;
+    std::atomic<bool> consoleRunning{false};
+    std::mutex commandMutex;
+    std::queue<std::string> pendingCommands;
+
+    void loadFile();
+    void runCommand(const std::string& line);
+    std::string formatValue(const Param& param) const;
+};
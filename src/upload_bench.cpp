@@ -0,0 +1,608 @@
+// Headless benchmark of ways to get chunk meshes into GPU buffers. Needs a Vulkan device but
+// no window, so it also runs on software implementations such as lavapipe.
+//
+// Usage: upload_bench [uploads per mesh size] [uploads per frame]
+//
+// Each method uploads the same meshes, `uploads per frame` at a time, polling for completed
+// uploads after every frame the way the app does. Reported per method and mesh size:
+//   MB/s      mesh bytes over wall time from the first upload until the last one completed
+//   latency   from starting an upload until its completion was observed (median / p95)
+//   CPU       main-thread time spent issuing and retiring uploads, per upload
+
+#include "marching_cubes.h"
+
+#include <vulkan/vulkan.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Vertex counts from a sparse surface chunk up to a dense cave chunk
+const uint32_t MESH_VERTEX_COUNTS[] = {1536, 6144, 24576, 98304};
+
+// The persistent ring holds this many of the largest mesh, so a few frames can be in flight
+constexpr VkDeviceSize RING_MESHES = 8;
+
+double msSince(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct VulkanContext {
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+
+    // Returns UINT32_MAX if no memory type has all the properties
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer& buffer, VkDeviceMemory& bufferMemory) const {
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+        if (allocInfo.memoryTypeIndex == UINT32_MAX) {
+            throw std::runtime_error("Failed to find suitable memory type!");
+        }
+
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate buffer memory!");
+        }
+
+        vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    }
+};
+
+VulkanContext createContext() {
+    VulkanContext ctx;
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Upload Bench";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+
+    if (vkCreateInstance(&createInfo, nullptr, &ctx.instance) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create Vulkan instance!");
+    }
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, nullptr);
+    if (deviceCount == 0) {
+        throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+    }
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, devices.data());
+
+    // Prefer real GPUs, but take whatever is there (lavapipe reports itself as a CPU device)
+    auto rank = [](VkPhysicalDevice device) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+        switch (properties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 0;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 1;
+            default: return 2;
+        }
+    };
+    ctx.physicalDevice = *std::min_element(devices.begin(), devices.end(),
+                                           [&](VkPhysicalDevice a, VkPhysicalDevice b) { return rank(a) < rank(b); });
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice, &properties);
+    std::cout << "Device: " << properties.deviceName << std::endl;
+    vkGetPhysicalDeviceMemoryProperties(ctx.physicalDevice, &ctx.memoryProperties);
+
+    // Same queue the app uploads on
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &familyCount, families.data());
+    uint32_t family = UINT32_MAX;
+    for (uint32_t i = 0; i < familyCount; i++) {
+        if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            family = i;
+            break;
+        }
+    }
+    if (family == UINT32_MAX) {
+        throw std::runtime_error("Failed to find a graphics queue!");
+    }
+
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueCreateInfo{};
+    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfo.queueFamilyIndex = family;
+    queueCreateInfo.queueCount = 1;
+    queueCreateInfo.pQueuePriorities = &queuePriority;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueCreateInfo;
+
+    if (vkCreateDevice(ctx.physicalDevice, &deviceInfo, nullptr, &ctx.device) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create logical device!");
+    }
+    vkGetDeviceQueue(ctx.device, family, 0, &ctx.queue);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = family;
+    if (vkCreateCommandPool(ctx.device, &poolInfo, nullptr, &ctx.commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create command pool!");
+    }
+
+    return ctx;
+}
+
+void destroyContext(VulkanContext& ctx) {
+    vkDestroyCommandPool(ctx.device, ctx.commandPool, nullptr);
+    vkDestroyDevice(ctx.device, nullptr);
+    vkDestroyInstance(ctx.instance, nullptr);
+}
+
+enum class UploadMethod {
+    PerUploadStaging,  // What uploadChunkMesh does: new staging buffer, command buffer and fence per mesh
+    StagingRing,       // One persistent mapped staging buffer, reused command buffers, a submit per mesh
+    BatchedRing,       // Same ring, but every mesh of a frame goes in one command buffer and submit
+    DirectHostVisible  // Vertex buffer in host-visible memory, written through a mapping; no copy at all
+};
+
+const char* methodName(UploadMethod method) {
+    switch (method) {
+        case UploadMethod::PerUploadStaging: return "per-upload staging";
+        case UploadMethod::StagingRing: return "staging ring";
+        case UploadMethod::BatchedRing: return "batched ring";
+        case UploadMethod::DirectHostVisible: return "direct host-visible";
+    }
+    return "?";
+}
+
+// Uploads meshes with one method. upload() starts one mesh, endFrame() closes the frame and
+// poll() reports the ids of uploads that have completed since the last poll.
+class MeshUploader {
+public:
+    MeshUploader(const VulkanContext& ctx, UploadMethod method, VkDeviceSize largestMesh)
+        : ctx(ctx), method(method) {
+        if (method == UploadMethod::StagingRing || method == UploadMethod::BatchedRing) {
+            ringSize = largestMesh * RING_MESHES;
+            ctx.createBuffer(ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             ringBuffer, ringMemory);
+            vkMapMemory(ctx.device, ringMemory, 0, ringSize, 0, &ringMapped);
+        }
+        if (method == UploadMethod::DirectHostVisible) {
+            // Device-local and mappable where the hardware allows it (UMA, resizable BAR)
+            directProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            if (ctx.findMemoryType(UINT32_MAX, directProperties | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != UINT32_MAX) {
+                directProperties |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            }
+        }
+    }
+
+    ~MeshUploader() {
+        vkDeviceWaitIdle(ctx.device);
+        for (InFlight& submit : inFlight) {
+            recycle(submit);
+        }
+        if (recording.commandBuffer != VK_NULL_HANDLE) {
+            recycle(recording);
+        }
+        for (PerUploadStaging& upload : stagingUploads) {
+            destroyStaging(upload);
+        }
+        for (Submission& submission : freeSubmissions) {
+            vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &submission.commandBuffer);
+            vkDestroyFence(ctx.device, submission.fence, nullptr);
+        }
+        if (ringBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(ctx.device, ringBuffer, nullptr);
+            vkFreeMemory(ctx.device, ringMemory, nullptr);
+        }
+        for (size_t i = 0; i < destinations.size(); i++) {
+            vkDestroyBuffer(ctx.device, destinations[i], nullptr);
+            vkFreeMemory(ctx.device, destinationMemory[i], nullptr);
+        }
+    }
+
+    bool directIsDeviceLocal() const {
+        return (directProperties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    void upload(const std::vector<MarchingCubesVertex>& vertices, uint32_t id) {
+        VkDeviceSize size = sizeof(MarchingCubesVertex) * vertices.size();
+        switch (method) {
+            case UploadMethod::PerUploadStaging: uploadPerUploadStaging(vertices.data(), size, id); break;
+            case UploadMethod::StagingRing:
+            case UploadMethod::BatchedRing: uploadRing(vertices.data(), size, id); break;
+            case UploadMethod::DirectHostVisible: uploadDirect(vertices.data(), size, id); break;
+        }
+    }
+
+    void endFrame() {
+        if (method == UploadMethod::BatchedRing && recording.commandBuffer != VK_NULL_HANDLE) {
+            submitRecording();
+        }
+    }
+
+    void poll(std::vector<uint32_t>& completed) {
+        completed.insert(completed.end(), retired.begin(), retired.end());
+        retired.clear();
+
+        for (size_t i = 0; i < stagingUploads.size(); ) {
+            if (vkGetFenceStatus(ctx.device, stagingUploads[i].fence) == VK_SUCCESS) {
+                completed.push_back(stagingUploads[i].id);
+                destroyStaging(stagingUploads[i]);
+                stagingUploads[i] = stagingUploads.back();
+                stagingUploads.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        // Ring space is freed in submission order
+        while (!inFlight.empty() && vkGetFenceStatus(ctx.device, inFlight.front().fence) == VK_SUCCESS) {
+            retireOldest();
+            completed.insert(completed.end(), retired.begin(), retired.end());
+            retired.clear();
+        }
+    }
+
+private:
+    struct PerUploadStaging {
+        uint32_t id;
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingMemory;
+        VkFence fence;
+        VkCommandBuffer commandBuffer;
+    };
+
+    struct Submission {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+    };
+
+    struct InFlight : Submission {
+        VkDeviceSize ringBegin = 0;  // Start of the oldest ring range this submit reads
+        std::vector<uint32_t> ids;
+    };
+
+    const VulkanContext& ctx;
+    UploadMethod method;
+
+    std::vector<VkBuffer> destinations;
+    std::vector<VkDeviceMemory> destinationMemory;
+
+    std::vector<PerUploadStaging> stagingUploads;
+
+    VkBuffer ringBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory ringMemory = VK_NULL_HANDLE;
+    void* ringMapped = nullptr;
+    VkDeviceSize ringSize = 0;
+    VkDeviceSize ringHead = 0;
+    std::deque<InFlight> inFlight;
+    InFlight recording;  // Batch being recorded (batched ring only)
+    std::vector<Submission> freeSubmissions;
+
+    VkMemoryPropertyFlags directProperties = 0;
+
+    std::vector<uint32_t> retired;  // Completed outside poll(), reported by the next poll()
+
+    VkBuffer createDestination(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+        VkBuffer buffer;
+        VkDeviceMemory memory;
+        ctx.createBuffer(size, usage, properties, buffer, memory);
+        destinations.push_back(buffer);
+        destinationMemory.push_back(memory);
+        return buffer;
+    }
+
+    // Mirrors VulkanApp::uploadChunkMesh and processUploadFences
+    void uploadPerUploadStaging(const void* vertices, VkDeviceSize size, uint32_t id) {
+        PerUploadStaging upload{id, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE};
+        ctx.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         upload.stagingBuffer, upload.stagingMemory);
+
+        void* data;
+        vkMapMemory(ctx.device, upload.stagingMemory, 0, size, 0, &data);
+        memcpy(data, vertices, static_cast<size_t>(size));
+        vkUnmapMemory(ctx.device, upload.stagingMemory);
+
+        VkBuffer destination = createDestination(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = ctx.commandPool;
+        allocInfo.commandBufferCount = 1;
+        vkAllocateCommandBuffers(ctx.device, &allocInfo, &upload.commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(upload.commandBuffer, &beginInfo);
+
+        VkBufferCopy copyRegion{};
+        copyRegion.size = size;
+        vkCmdCopyBuffer(upload.commandBuffer, upload.stagingBuffer, destination, 1, &copyRegion);
+        vkEndCommandBuffer(upload.commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vkCreateFence(ctx.device, &fenceInfo, nullptr, &upload.fence);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &upload.commandBuffer;
+        vkQueueSubmit(ctx.queue, 1, &submitInfo, upload.fence);
+
+        stagingUploads.push_back(upload);
+    }
+
+    void destroyStaging(PerUploadStaging& upload) {
+        vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &upload.commandBuffer);
+        vkDestroyFence(ctx.device, upload.fence, nullptr);
+        vkDestroyBuffer(ctx.device, upload.stagingBuffer, nullptr);
+        vkFreeMemory(ctx.device, upload.stagingMemory, nullptr);
+    }
+
+    void uploadRing(const void* vertices, VkDeviceSize size, uint32_t id) {
+        VkDeviceSize offset = reserveRing(size);
+        memcpy(static_cast<char*>(ringMapped) + offset, vertices, static_cast<size_t>(size));
+
+        if (recording.commandBuffer == VK_NULL_HANDLE) {
+            static_cast<Submission&>(recording) = acquireSubmission();
+            recording.ringBegin = offset;
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(recording.commandBuffer, &beginInfo);
+        }
+
+        VkBuffer destination = createDestination(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = offset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(recording.commandBuffer, ringBuffer, destination, 1, &copyRegion);
+        recording.ids.push_back(id);
+
+        if (method == UploadMethod::StagingRing) {
+            submitRecording();
+        }
+    }
+
+    // Space for `size` bytes at ringHead (wrapping to 0 if needed), waiting for the oldest
+    // submits to finish while the ring is full
+    VkDeviceSize reserveRing(VkDeviceSize size) {
+        if (size > ringSize) {
+            throw std::runtime_error("Mesh larger than the staging ring!");
+        }
+        while (true) {
+            bool busy = !inFlight.empty() || recording.commandBuffer != VK_NULL_HANDLE;
+            VkDeviceSize tail = !inFlight.empty() ? inFlight.front().ringBegin : recording.ringBegin;
+            if (!busy) {
+                ringHead = size <= ringSize - ringHead ? ringHead : 0;
+            } else if (ringHead > tail) {
+                // Free: [ringHead, ringSize) then [0, tail)
+                if (size > ringSize - ringHead && size <= tail) {
+                    ringHead = 0;
+                } else if (size > ringSize - ringHead) {
+                    ringHead = ringSize;  // Can't fit either side yet
+                }
+            }
+            bool fits = !busy || (ringHead < tail ? size <= tail - ringHead
+                                                  : ringHead > tail && size <= ringSize - ringHead);
+            if (fits) {
+                VkDeviceSize offset = ringHead;
+                ringHead += size;
+                return offset;
+            }
+
+            // Full: wait for the oldest submit, flushing the batch being recorded if it is the only one
+            if (inFlight.empty()) {
+                submitRecording();
+            }
+            vkWaitForFences(ctx.device, 1, &inFlight.front().fence, VK_TRUE, UINT64_MAX);
+            retireOldest();
+        }
+    }
+
+    void submitRecording() {
+        vkEndCommandBuffer(recording.commandBuffer);
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &recording.commandBuffer;
+        vkQueueSubmit(ctx.queue, 1, &submitInfo, recording.fence);
+        inFlight.push_back(std::move(recording));
+        recording = InFlight{};
+    }
+
+    void retireOldest() {
+        InFlight& oldest = inFlight.front();
+        retired.insert(retired.end(), oldest.ids.begin(), oldest.ids.end());
+        recycle(oldest);
+        inFlight.pop_front();
+    }
+
+    Submission acquireSubmission() {
+        if (!freeSubmissions.empty()) {
+            Submission submission = freeSubmissions.back();
+            freeSubmissions.pop_back();
+            return submission;
+        }
+        Submission submission;
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = ctx.commandPool;
+        allocInfo.commandBufferCount = 1;
+        vkAllocateCommandBuffers(ctx.device, &allocInfo, &submission.commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vkCreateFence(ctx.device, &fenceInfo, nullptr, &submission.fence);
+        return submission;
+    }
+
+    void recycle(Submission& submission) {
+        vkResetCommandBuffer(submission.commandBuffer, 0);
+        vkResetFences(ctx.device, 1, &submission.fence);
+        freeSubmissions.push_back(submission);
+    }
+
+    void uploadDirect(const void* vertices, VkDeviceSize size, uint32_t id) {
+        createDestination(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, directProperties);
+        void* data;
+        vkMapMemory(ctx.device, destinationMemory.back(), 0, size, 0, &data);
+        memcpy(data, vertices, static_cast<size_t>(size));
+        vkUnmapMemory(ctx.device, destinationMemory.back());
+        // Coherent memory: visible to the next submit without any GPU work
+        retired.push_back(id);
+    }
+};
+
+struct UploadResult {
+    double mbPerSecond;
+    double latencyMedianMs;
+    double latencyP95Ms;
+    double cpuUsPerUpload;
+};
+
+UploadResult runUploads(const VulkanContext& ctx, UploadMethod method, uint32_t vertexCount,
+                        uint32_t uploadCount, uint32_t uploadsPerFrame, VkDeviceSize largestMesh) {
+    // Contents don't matter, but touch every byte so nothing is lazily zero-filled
+    std::vector<MarchingCubesVertex> vertices(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        float f = static_cast<float>(i);
+        vertices[i] = {glm::vec3(f, f * 0.5f, f * 0.25f), glm::vec3(0.5f)};
+    }
+
+    MeshUploader uploader(ctx, method, largestMesh);
+    std::vector<Clock::time_point> starts(uploadCount);
+    std::vector<double> latencies;
+    std::vector<uint32_t> completed;
+    double cpuMs = 0.0;
+
+    auto runStart = Clock::now();
+    uint32_t issued = 0;
+    while (latencies.size() < uploadCount) {
+        auto frameStart = Clock::now();
+        for (uint32_t i = 0; i < uploadsPerFrame && issued < uploadCount; i++, issued++) {
+            starts[issued] = Clock::now();
+            uploader.upload(vertices, issued);
+        }
+        uploader.endFrame();
+
+        completed.clear();
+        uploader.poll(completed);
+        auto frameEnd = Clock::now();
+        for (uint32_t id : completed) {
+            latencies.push_back(msSince(starts[id], frameEnd));
+        }
+        // Idle polls once everything is submitted only measure the wait for the device
+        if (issued < uploadCount || !completed.empty()) {
+            cpuMs += msSince(frameStart, frameEnd);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    double wallMs = msSince(runStart, Clock::now());
+
+    std::sort(latencies.begin(), latencies.end());
+    double megabytes = static_cast<double>(uploadCount) * vertexCount * sizeof(MarchingCubesVertex) / (1024.0 * 1024.0);
+    return UploadResult{
+        megabytes / (wallMs / 1000.0),
+        latencies[latencies.size() / 2],
+        latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)],
+        cpuMs * 1000.0 / uploadCount
+    };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t uploadCount = argc > 1 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[1]))) : 64;
+    uint32_t uploadsPerFrame = argc > 2 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[2]))) : 3;
+
+    try {
+        VulkanContext ctx = createContext();
+        VkDeviceSize largestMesh = sizeof(MarchingCubesVertex) *
+                                   *std::max_element(std::begin(MESH_VERTEX_COUNTS), std::end(MESH_VERTEX_COUNTS));
+        {
+            MeshUploader probe(ctx, UploadMethod::DirectHostVisible, largestMesh);
+            std::cout << "Direct writes go to " << (probe.directIsDeviceLocal() ? "device-local" : "system")
+                      << " memory" << std::endl;
+        }
+
+        const UploadMethod methods[] = {UploadMethod::PerUploadStaging, UploadMethod::StagingRing,
+                                        UploadMethod::BatchedRing, UploadMethod::DirectHostVisible};
+
+        std::cout << std::fixed << std::setprecision(2);
+        for (uint32_t vertexCount : MESH_VERTEX_COUNTS) {
+            std::cout << "=== " << uploadCount << " uploads of " << vertexCount << " vertices ("
+                      << vertexCount * sizeof(MarchingCubesVertex) / 1024 << " KB), " << uploadsPerFrame
+                      << " per frame ===" << std::endl;
+            for (UploadMethod method : methods) {
+                UploadResult result = runUploads(ctx, method, vertexCount, uploadCount, uploadsPerFrame, largestMesh);
+                std::cout << "  " << std::setw(20) << std::left << methodName(method) << std::right
+                          << std::setw(9) << result.mbPerSecond << " MB/s"
+                          << "   latency " << std::setw(7) << result.latencyMedianMs << " / "
+                          << std::setw(7) << result.latencyP95Ms << " ms (median / p95)"
+                          << "   CPU " << std::setw(8) << result.cpuUsPerUpload << " us/upload" << std::endl;
+            }
+        }
+
+        destroyContext(ctx);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include "upload_scheduler.h"
+#include <algorithm>
+
+namespace {
+    constexpr float RATE_SMOOTHING = 0.2f;             // Weight of the newest batch
+    constexpr float MIN_SAMPLE_MS = 0.01f;             // Shorter batches are timer noise
+    constexpr uint64_t MIN_FRAME_BYTES = 64 * 1024;    // Keeps uploads moving if a rate collapses
+    constexpr uint64_t MAX_FRAME_BYTES = 64ull << 20;
+
+    constexpr float HIDDEN_PENALTY = 4.0f;   // Out of view counts as this much farther away
+    constexpr float REPLACE_PENALTY = 2.0f;  // Something is drawn there already
+
+    void addSample(float& rate, uint64_t bytes, float ms) {
+        if (bytes == 0 || ms < MIN_SAMPLE_MS) {
+            return;
+        }
+        rate += RATE_SMOOTHING * (static_cast<float>(bytes) / ms - rate);
+    }
+}
+
+void UploadThroughput::addCpuSample(uint64_t bytes, float ms) {
+    addSample(cpuRate, bytes, ms);
+}
+
+void UploadThroughput::addGpuSample(uint64_t bytes, float ms) {
+    addSample(gpuRate, bytes, ms);
+}
+
+uint64_t UploadThroughput::frameByteBudget(const UploadSchedulerSettings& settings) const {
+    float bytes = std::min(cpuRate * settings.cpuBudgetMs, gpuRate * settings.gpuBudgetMs);
+    return std::clamp(static_cast<uint64_t>(std::max(bytes, 0.0f)), MIN_FRAME_BYTES, MAX_FRAME_BYTES);
+}
+
+float uploadPriority(const UploadCandidate& candidate) {
+    float priority = candidate.distance;
+    if (!candidate.visible) {
+        priority *= HIDDEN_PENALTY;
+    }
+    if (candidate.replacesMesh) {
+        priority *= REPLACE_PENALTY;
+    }
+    return priority;
+}
+
+size_t selectUploads(std::vector<UploadCandidate>& candidates, uint64_t byteBudget, int maxUploads) {
+    if (candidates.empty() || maxUploads <= 0) {
+        return 0;
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const UploadCandidate& a, const UploadCandidate& b) {
+        return uploadPriority(a) < uploadPriority(b);
+    });
+
+    // Stable compaction keeps the chosen ones in priority order
+    size_t chosen = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < candidates.size() && chosen < static_cast<size_t>(maxUploads); i++) {
+        if (chosen > 0 && bytes + candidates[i].bytes > byteBudget) {
+            continue;
+        }
+        bytes += candidates[i].bytes;
+        std::swap(candidates[chosen], candidates[i]);
+        chosen++;
+    }
+    return chosen;
+}
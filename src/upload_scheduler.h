@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A finished mesh waiting for upload, as the scheduler sees it
+struct UploadCandidate {
+    uint32_t index;     // Caller's handle
+    uint64_t bytes;
+    float distance;     // Camera to chunk centre
+    bool visible;       // Chunk box in the view frustum
+    bool replacesMesh;  // The chunk already draws something (a coarse or older mesh)
+};
+
+struct UploadSchedulerSettings {
+    float cpuBudgetMs = 1.5f;  // Main-thread time per frame for staging copies and submits
+    float gpuBudgetMs = 1.0f;  // Transfer time per frame on the GPU
+    int maxUploads = 32;       // Meshes per frame regardless of size (each is an arena allocation and a copy)
+};
+
+// Bytes per millisecond of the two halves of an upload, smoothed over recent batches.
+// Both start from a guess and follow what batches actually achieve.
+class UploadThroughput {
+public:
+    void addCpuSample(uint64_t bytes, float ms);
+    void addGpuSample(uint64_t bytes, float ms);
+
+    // Bytes that fit in this frame's CPU and GPU budgets
+    uint64_t frameByteBudget(const UploadSchedulerSettings& settings) const;
+
+    float cpuBytesPerMs() const { return cpuRate; }
+    float gpuBytesPerMs() const { return gpuRate; }
+
+private:
+    float cpuRate = 1024.0f * 1024.0f;  // 1 GB/s until measured
+    float gpuRate = 1024.0f * 1024.0f;
+};
+
+// Lower goes first: near before far, in view before behind, holes before replacements
+float uploadPriority(const UploadCandidate& candidate);
+
+// Sorts `candidates` by priority and moves the ones to upload this frame to the front; returns
+// how many. The most urgent always goes, even alone over budget; after that, meshes that no
+// longer fit are passed over so smaller ones behind them can fill the budget.
+size_t selectUploads(std::vector<UploadCandidate>& candidates, uint64_t byteBudget, int maxUploads);
@@ -0,0 +1,67 @@
+#include "vertex_arena.h"
+#include <algorithm>
+#include <iterator>
+
+void VertexArena::reset(uint64_t bytes, uint64_t unitBytes) {
+    granularity = std::max<uint64_t>(unitBytes, 1);
+    totalBytes = bytes / granularity * granularity;
+    freeBytes = totalBytes;
+    freeRanges.clear();
+    if (totalBytes > 0) {
+        freeRanges[0] = totalBytes;
+    }
+}
+
+bool VertexArena::allocate(uint64_t size, ArenaRange& range) {
+    uint64_t rounded = (size + granularity - 1) / granularity * granularity;
+    if (rounded == 0) {
+        range = ArenaRange{};
+        return true;
+    }
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < rounded) {
+            continue;
+        }
+        range = ArenaRange{it->first, rounded};
+        uint64_t rest = it->second - rounded;
+        uint64_t restOffset = it->first + rounded;
+        freeRanges.erase(it);
+        if (rest > 0) {
+            freeRanges[restOffset] = rest;
+        }
+        freeBytes -= rounded;
+        return true;
+    }
+    return false;
+}
+
+void VertexArena::free(const ArenaRange& range) {
+    if (range.size == 0) {
+        return;
+    }
+    freeBytes += range.size;
+    auto next = freeRanges.lower_bound(range.offset);
+    uint64_t offset = range.offset;
+    uint64_t size = range.size;
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            freeRanges.erase(previous);
+        }
+    }
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        freeRanges.erase(next);
+    }
+    freeRanges[offset] = size;
+}
+
+uint64_t VertexArena::largestFreeRange() const {
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : freeRanges) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+// A byte range inside the shared vertex arena; size 0 = nothing allocated
+struct ArenaRange {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// First-fit suballocator for the one big vertex buffer every chunk mesh lives in. Only the
+// bookkeeping: the caller owns the Vulkan buffer and decides when a range may be reused.
+// Offsets and sizes are multiples of `unitBytes`, so with the vertex size as the unit every
+// offset is also a whole vertex index for firstVertex.
+class VertexArena {
+public:
+    void reset(uint64_t bytes, uint64_t unitBytes);
+
+    // False if no free range is large enough (the arena is full or fragmented)
+    bool allocate(uint64_t size, ArenaRange& range);
+    // Adjacent free ranges are merged. Freeing an empty range does nothing.
+    void free(const ArenaRange& range);
+
+    uint64_t capacity() const { return totalBytes; }
+    uint64_t usedBytes() const { return totalBytes - freeBytes; }
+    uint64_t largestFreeRange() const;
+    size_t freeRangeCount() const { return freeRanges.size(); }
+
+private:
+    uint64_t totalBytes = 0;
+    uint64_t freeBytes = 0;
+    uint64_t granularity = 1;
+    std::map<uint64_t, uint64_t> freeRanges;  // Offset -> size, never adjacent
+};
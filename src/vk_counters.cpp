@@ -0,0 +1,96 @@
+#include "vk_counters.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+    // Sites are registered once per entry point and never move
+    std::vector<std::unique_ptr<VkCallSite>> callSites;
+    VkFrameCounters currentFrame;
+}
+
+const char* vkObjectKindName(VkObjectKind kind) {
+    switch (kind) {
+        case VkObjectKind::None: return "none";
+        case VkObjectKind::Buffer: return "buffer";
+        case VkObjectKind::Memory: return "memory";
+        case VkObjectKind::CommandBuffer: return "cmd";
+        case VkObjectKind::Fence: return "fence";
+        case VkObjectKind::Semaphore: return "semaphore";
+        case VkObjectKind::QueryPool: return "query pool";
+        case VkObjectKind::Image: return "image";
+        case VkObjectKind::Pipeline: return "pipeline";
+        case VkObjectKind::Other: return "other";
+        default: return "?";
+    }
+}
+
+uint32_t VkFrameCounters::totalCreated() const {
+    uint32_t total = 0;
+    for (uint32_t count : created) {
+        total += count;
+    }
+    return total;
+}
+
+uint32_t VkFrameCounters::totalDestroyed() const {
+    uint32_t total = 0;
+    for (uint32_t count : destroyed) {
+        total += count;
+    }
+    return total;
+}
+
+void VkFrameCounters::add(const VkFrameCounters& other) {
+    calls += other.calls;
+    ms += other.ms;
+    waitMs += other.waitMs;
+    for (size_t kind = 0; kind < VK_OBJECT_KIND_COUNT; kind++) {
+        created[kind] += other.created[kind];
+        destroyed[kind] += other.destroyed[kind];
+    }
+}
+
+VkCallSite& registerVkCallSite(const char* name, bool wait) {
+    callSites.push_back(std::make_unique<VkCallSite>());
+    callSites.back()->name = name;
+    callSites.back()->wait = wait;
+    return *callSites.back();
+}
+
+VkFrameCounters& vkFrameCounters() {
+    return currentFrame;
+}
+
+VkFrameCounters takeVkFrameCounters() {
+    VkFrameCounters finished = currentFrame;
+    currentFrame = VkFrameCounters{};
+    return finished;
+}
+
+void printVkCallReport(uint64_t frames) {
+    std::vector<VkCallSite*> sites;
+    for (auto& site : callSites) {
+        if (site->calls > 0) {
+            sites.push_back(site.get());
+        }
+    }
+    std::sort(sites.begin(), sites.end(), [](const VkCallSite* a, const VkCallSite* b) { return a->ms > b->ms; });
+
+    double perFrame = 1.0 / std::max<uint64_t>(frames, 1);
+    std::cout << "[vulkan] Calls over " << frames << " frames (per frame):" << std::endl;
+    std::cout << std::fixed;
+    for (const VkCallSite* site : sites) {
+        std::cout << "  " << std::left << std::setw(44) << site->name << std::right
+                  << std::setprecision(1) << std::setw(9) << site->calls * perFrame << " calls"
+                  << std::setprecision(3) << std::setw(9) << site->ms * perFrame << " ms"
+                  << (site->wait ? " (waiting)" : "") << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    for (auto& site : callSites) {
+        site->calls = 0;
+        site->ms = 0.0;
+    }
+}
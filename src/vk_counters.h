@@ -0,0 +1,256 @@
+#pragma once
+
+// Thin counting layer over the Vulkan entry points main.cpp uses: every call is counted and
+// timed, and object creations and destructions are tallied per frame by kind, so per-chunk
+// object churn shows up in the stats. Include after the Vulkan headers and only from main.cpp;
+// the macros at the bottom reroute the plain vk* calls through VkCounted. Main thread only.
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+enum class VkObjectKind {
+    None,
+    Buffer,
+    Memory,
+    CommandBuffer,
+    Fence,
+    Semaphore,
+    QueryPool,
+    Image,
+    Pipeline,
+    Other,  // Everything else (views, layouts, pools, ...)
+    Count
+};
+
+const char* vkObjectKindName(VkObjectKind kind);
+
+constexpr size_t VK_OBJECT_KIND_COUNT = static_cast<size_t>(VkObjectKind::Count);
+
+struct VkFrameCounters {
+    uint32_t calls = 0;
+    double ms = 0.0;      // In non-blocking calls (driver CPU cost), timer overhead included
+    double waitMs = 0.0;  // In calls that block on the GPU or presentation (isVkWaitFunction)
+    std::array<uint32_t, VK_OBJECT_KIND_COUNT> created{};
+    std::array<uint32_t, VK_OBJECT_KIND_COUNT> destroyed{};
+
+    uint32_t totalCreated() const;
+    uint32_t totalDestroyed() const;
+    void add(const VkFrameCounters& other);
+};
+
+// Totals of one entry point since the last printVkCallReport
+struct VkCallSite {
+    const char* name = nullptr;
+    uint64_t calls = 0;
+    double ms = 0.0;
+    bool wait = false;  // Blocking entry point, see isVkWaitFunction
+};
+
+VkCallSite& registerVkCallSite(const char* name, bool wait);
+
+// The frame being counted
+VkFrameCounters& vkFrameCounters();
+
+// Returns the finished frame's counters and starts counting the next one
+VkFrameCounters takeVkFrameCounters();
+
+// Per entry point: calls and ms per frame over `frames`, busiest first. Resets the sites.
+void printVkCallReport(uint64_t frames);
+
+template<auto A, auto B>
+constexpr bool isSameVkFunction() {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
+// Entry points whose time is mostly spent waiting for the GPU, vsync or the compositor.
+// Their time goes to VkFrameCounters::waitMs so it doesn't read as driver overhead.
+template<auto Fn>
+constexpr bool isVkWaitFunction() {
+    return isSameVkFunction<Fn, &::vkWaitForFences>() || isSameVkFunction<Fn, &::vkAcquireNextImageKHR>() ||
+           isSameVkFunction<Fn, &::vkQueuePresentKHR>() || isSameVkFunction<Fn, &::vkDeviceWaitIdle>() ||
+           isSameVkFunction<Fn, &::vkQueueWaitIdle>();
+}
+
+template<auto Fn, VkObjectKind Created, VkObjectKind Destroyed>
+struct VkCounted;
+
+template<typename R, typename... P, R (VKAPI_PTR* Fn)(P...), VkObjectKind Created, VkObjectKind Destroyed>
+struct VkCounted<Fn, Created, Destroyed> {
+    static R call(const char* name, P... args) {
+        static VkCallSite& site = registerVkCallSite(name, isVkWaitFunction<Fn>());
+        VkFrameCounters& frame = vkFrameCounters();
+        if constexpr (Destroyed != VkObjectKind::None) {
+            frame.destroyed[static_cast<size_t>(Destroyed)] += destroyedCount(args...);
+        }
+        auto start = std::chrono::steady_clock::now();
+        if constexpr (std::is_void_v<R>) {
+            Fn(args...);
+            finish(site, frame, start);
+        } else {
+            R result = Fn(args...);
+            finish(site, frame, start);
+            if constexpr (Created != VkObjectKind::None) {
+                if (result == VK_SUCCESS) {
+                    frame.created[static_cast<size_t>(Created)] += createdCount(args...);
+                }
+            }
+            return result;
+        }
+    }
+
+private:
+    static void finish(VkCallSite& site, VkFrameCounters& frame, std::chrono::steady_clock::time_point start) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        site.calls++;
+        site.ms += ms;
+        frame.calls++;
+        if constexpr (isVkWaitFunction<Fn>()) {
+            frame.waitMs += ms;
+        } else {
+            frame.ms += ms;
+        }
+    }
+
+    // Batch entry points make several objects per call
+    static uint32_t createdCount([[maybe_unused]] P... args) {
+        if constexpr (isSameVkFunction<Fn, &::vkAllocateCommandBuffers>()) {
+            return std::get<1>(std::tie(args...))->commandBufferCount;
+        } else if constexpr (isSameVkFunction<Fn, &::vkAllocateDescriptorSets>()) {
+            return std::get<1>(std::tie(args...))->descriptorSetCount;
+        } else if constexpr (isSameVkFunction<Fn, &::vkCreateGraphicsPipelines>() ||
+                             isSameVkFunction<Fn, &::vkCreateComputePipelines>()) {
+            return std::get<2>(std::tie(args...));
+        } else {
+            return 1;
+        }
+    }
+
+    // Destroying VK_NULL_HANDLE is legal and destroys nothing. The handle is always the
+    // parameter before pAllocator.
+    static uint32_t destroyedCount([[maybe_unused]] P... args) {
+        if constexpr (isSameVkFunction<Fn, &::vkFreeCommandBuffers>()) {
+            return std::get<2>(std::tie(args...));
+        } else {
+            return std::get<sizeof...(P) - 2>(std::tie(args...)) != VK_NULL_HANDLE ? 1 : 0;
+        }
+    }
+};
+
+// vkCmdDrawIndirectCount is core in 1.2 and vkCmdDrawIndirectCountKHR before; main.cpp resolves
+// whichever the device has, and calls it through here so it is counted like the rest
+inline PFN_vkCmdDrawIndirectCount drawIndirectCountProc = nullptr;
+
+inline VKAPI_ATTR void VKAPI_CALL cmdDrawIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset,
+                                                       VkBuffer countBuffer, VkDeviceSize countBufferOffset,
+                                                       uint32_t maxDrawCount, uint32_t stride) {
+    drawIndirectCountProc(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+
+#define VK_COUNTED(fn, created, destroyed, ...) \
+    VkCounted<::fn, VkObjectKind::created, VkObjectKind::destroyed>::call(#fn, __VA_ARGS__)
+
+// Every entry point main.cpp calls; a new one needs a line here to be counted
+#define cmdDrawIndirectCount(...) VK_COUNTED(cmdDrawIndirectCount, None, None, __VA_ARGS__)
+#define vkAcquireNextImageKHR(...) VK_COUNTED(vkAcquireNextImageKHR, None, None, __VA_ARGS__)
+#define vkAllocateCommandBuffers(...) VK_COUNTED(vkAllocateCommandBuffers, CommandBuffer, None, __VA_ARGS__)
+#define vkAllocateDescriptorSets(...) VK_COUNTED(vkAllocateDescriptorSets, Other, None, __VA_ARGS__)
+#define vkAllocateMemory(...) VK_COUNTED(vkAllocateMemory, Memory, None, __VA_ARGS__)
+#define vkBeginCommandBuffer(...) VK_COUNTED(vkBeginCommandBuffer, None, None, __VA_ARGS__)
+#define vkBindBufferMemory(...) VK_COUNTED(vkBindBufferMemory, None, None, __VA_ARGS__)
+#define vkBindImageMemory(...) VK_COUNTED(vkBindImageMemory, None, None, __VA_ARGS__)
+#define vkCmdBeginQuery(...) VK_COUNTED(vkCmdBeginQuery, None, None, __VA_ARGS__)
+#define vkCmdBeginRenderPass(...) VK_COUNTED(vkCmdBeginRenderPass, None, None, __VA_ARGS__)
+#define vkCmdBindDescriptorSets(...) VK_COUNTED(vkCmdBindDescriptorSets, None, None, __VA_ARGS__)
+#define vkCmdBindPipeline(...) VK_COUNTED(vkCmdBindPipeline, None, None, __VA_ARGS__)
+#define vkCmdBindVertexBuffers(...) VK_COUNTED(vkCmdBindVertexBuffers, None, None, __VA_ARGS__)
+#define vkCmdCopyBuffer(...) VK_COUNTED(vkCmdCopyBuffer, None, None, __VA_ARGS__)
+#define vkCmdDispatch(...) VK_COUNTED(vkCmdDispatch, None, None, __VA_ARGS__)
+#define vkCmdDraw(...) VK_COUNTED(vkCmdDraw, None, None, __VA_ARGS__)
+#define vkCmdEndQuery(...) VK_COUNTED(vkCmdEndQuery, None, None, __VA_ARGS__)
+#define vkCmdEndRenderPass(...) VK_COUNTED(vkCmdEndRenderPass, None, None, __VA_ARGS__)
+#define vkCmdFillBuffer(...) VK_COUNTED(vkCmdFillBuffer, None, None, __VA_ARGS__)
+#define vkCmdPipelineBarrier(...) VK_COUNTED(vkCmdPipelineBarrier, None, None, __VA_ARGS__)
+#define vkCmdPushConstants(...) VK_COUNTED(vkCmdPushConstants, None, None, __VA_ARGS__)
+#define vkCmdResetQueryPool(...) VK_COUNTED(vkCmdResetQueryPool, None, None, __VA_ARGS__)
+#define vkCmdSetScissor(...) VK_COUNTED(vkCmdSetScissor, None, None, __VA_ARGS__)
+#define vkCmdSetViewport(...) VK_COUNTED(vkCmdSetViewport, None, None, __VA_ARGS__)
+#define vkCmdWriteTimestamp(...) VK_COUNTED(vkCmdWriteTimestamp, None, None, __VA_ARGS__)
+#define vkCreateBuffer(...) VK_COUNTED(vkCreateBuffer, Buffer, None, __VA_ARGS__)
+#define vkCreateCommandPool(...) VK_COUNTED(vkCreateCommandPool, Other, None, __VA_ARGS__)
+#define vkCreateComputePipelines(...) VK_COUNTED(vkCreateComputePipelines, Pipeline, None, __VA_ARGS__)
+#define vkCreateDescriptorPool(...) VK_COUNTED(vkCreateDescriptorPool, Other, None, __VA_ARGS__)
+#define vkCreateDescriptorSetLayout(...) VK_COUNTED(vkCreateDescriptorSetLayout, Other, None, __VA_ARGS__)
+#define vkCreateDevice(...) VK_COUNTED(vkCreateDevice, Other, None, __VA_ARGS__)
+#define vkCreateFence(...) VK_COUNTED(vkCreateFence, Fence, None, __VA_ARGS__)
+#define vkCreateFramebuffer(...) VK_COUNTED(vkCreateFramebuffer, Other, None, __VA_ARGS__)
+#define vkCreateGraphicsPipelines(...) VK_COUNTED(vkCreateGraphicsPipelines, Pipeline, None, __VA_ARGS__)
+#define vkCreateImage(...) VK_COUNTED(vkCreateImage, Image, None, __VA_ARGS__)
+#define vkCreateImageView(...) VK_COUNTED(vkCreateImageView, Other, None, __VA_ARGS__)
+#define vkCreateInstance(...) VK_COUNTED(vkCreateInstance, Other, None, __VA_ARGS__)
+#define vkCreatePipelineLayout(...) VK_COUNTED(vkCreatePipelineLayout, Other, None, __VA_ARGS__)
+#define vkCreateQueryPool(...) VK_COUNTED(vkCreateQueryPool, QueryPool, None, __VA_ARGS__)
+#define vkCreateRenderPass(...) VK_COUNTED(vkCreateRenderPass, Other, None, __VA_ARGS__)
+#define vkCreateSampler(...) VK_COUNTED(vkCreateSampler, Other, None, __VA_ARGS__)
+#define vkCreateSemaphore(...) VK_COUNTED(vkCreateSemaphore, Semaphore, None, __VA_ARGS__)
+#define vkCreateShaderModule(...) VK_COUNTED(vkCreateShaderModule, Other, None, __VA_ARGS__)
+#define vkCreateSwapchainKHR(...) VK_COUNTED(vkCreateSwapchainKHR, Other, None, __VA_ARGS__)
+#define vkDestroyBuffer(...) VK_COUNTED(vkDestroyBuffer, None, Buffer, __VA_ARGS__)
+#define vkDestroyCommandPool(...) VK_COUNTED(vkDestroyCommandPool, None, Other, __VA_ARGS__)
+#define vkDestroyDescriptorPool(...) VK_COUNTED(vkDestroyDescriptorPool, None, Other, __VA_ARGS__)
+#define vkDestroyDescriptorSetLayout(...) VK_COUNTED(vkDestroyDescriptorSetLayout, None, Other, __VA_ARGS__)
+#define vkDestroyDevice(...) VK_COUNTED(vkDestroyDevice, None, Other, __VA_ARGS__)
+#define vkDestroyFence(...) VK_COUNTED(vkDestroyFence, None, Fence, __VA_ARGS__)
+#define vkDestroyFramebuffer(...) VK_COUNTED(vkDestroyFramebuffer, None, Other, __VA_ARGS__)
+#define vkDestroyImage(...) VK_COUNTED(vkDestroyImage, None, Image, __VA_ARGS__)
+#define vkDestroyImageView(...) VK_COUNTED(vkDestroyImageView, None, Other, __VA_ARGS__)
+#define vkDestroyInstance(...) VK_COUNTED(vkDestroyInstance, None, Other, __VA_ARGS__)
+#define vkDestroyPipeline(...) VK_COUNTED(vkDestroyPipeline, None, Pipeline, __VA_ARGS__)
+#define vkDestroyPipelineLayout(...) VK_COUNTED(vkDestroyPipelineLayout, None, Other, __VA_ARGS__)
+#define vkDestroyQueryPool(...) VK_COUNTED(vkDestroyQueryPool, None, QueryPool, __VA_ARGS__)
+#define vkDestroyRenderPass(...) VK_COUNTED(vkDestroyRenderPass, None, Other, __VA_ARGS__)
+#define vkDestroySampler(...) VK_COUNTED(vkDestroySampler, None, Other, __VA_ARGS__)
+#define vkDestroySemaphore(...) VK_COUNTED(vkDestroySemaphore, None, Semaphore, __VA_ARGS__)
+#define vkDestroyShaderModule(...) VK_COUNTED(vkDestroyShaderModule, None, Other, __VA_ARGS__)
+#define vkDestroySurfaceKHR(...) VK_COUNTED(vkDestroySurfaceKHR, None, Other, __VA_ARGS__)
+#define vkDestroySwapchainKHR(...) VK_COUNTED(vkDestroySwapchainKHR, None, Other, __VA_ARGS__)
+#define vkDeviceWaitIdle(...) VK_COUNTED(vkDeviceWaitIdle, None, None, __VA_ARGS__)
+#define vkEndCommandBuffer(...) VK_COUNTED(vkEndCommandBuffer, None, None, __VA_ARGS__)
+#define vkEnumerateDeviceExtensionProperties(...) VK_COUNTED(vkEnumerateDeviceExtensionProperties, None, None, __VA_ARGS__)
+#define vkEnumeratePhysicalDevices(...) VK_COUNTED(vkEnumeratePhysicalDevices, None, None, __VA_ARGS__)
+#define vkFreeCommandBuffers(...) VK_COUNTED(vkFreeCommandBuffers, None, CommandBuffer, __VA_ARGS__)
+#define vkFreeMemory(...) VK_COUNTED(vkFreeMemory, None, Memory, __VA_ARGS__)
+#define vkGetBufferMemoryRequirements(...) VK_COUNTED(vkGetBufferMemoryRequirements, None, None, __VA_ARGS__)
+#define vkGetDeviceProcAddr(...) VK_COUNTED(vkGetDeviceProcAddr, None, None, __VA_ARGS__)
+#define vkGetDeviceQueue(...) VK_COUNTED(vkGetDeviceQueue, None, None, __VA_ARGS__)
+#define vkGetFenceStatus(...) VK_COUNTED(vkGetFenceStatus, None, None, __VA_ARGS__)
+#define vkGetImageMemoryRequirements(...) VK_COUNTED(vkGetImageMemoryRequirements, None, None, __VA_ARGS__)
+#define vkGetInstanceProcAddr(...) VK_COUNTED(vkGetInstanceProcAddr, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceFeatures(...) VK_COUNTED(vkGetPhysicalDeviceFeatures, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceFeatures2(...) VK_COUNTED(vkGetPhysicalDeviceFeatures2, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceFormatProperties(...) VK_COUNTED(vkGetPhysicalDeviceFormatProperties, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceMemoryProperties(...) VK_COUNTED(vkGetPhysicalDeviceMemoryProperties, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceProperties(...) VK_COUNTED(vkGetPhysicalDeviceProperties, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceQueueFamilyProperties(...) VK_COUNTED(vkGetPhysicalDeviceQueueFamilyProperties, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceCapabilitiesKHR(...) VK_COUNTED(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceFormatsKHR(...) VK_COUNTED(vkGetPhysicalDeviceSurfaceFormatsKHR, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfacePresentModesKHR(...) VK_COUNTED(vkGetPhysicalDeviceSurfacePresentModesKHR, None, None, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceSupportKHR(...) VK_COUNTED(vkGetPhysicalDeviceSurfaceSupportKHR, None, None, __VA_ARGS__)
+#define vkGetQueryPoolResults(...) VK_COUNTED(vkGetQueryPoolResults, None, None, __VA_ARGS__)
+#define vkGetSwapchainImagesKHR(...) VK_COUNTED(vkGetSwapchainImagesKHR, None, None, __VA_ARGS__)
+#define vkMapMemory(...) VK_COUNTED(vkMapMemory, None, None, __VA_ARGS__)
+#define vkQueuePresentKHR(...) VK_COUNTED(vkQueuePresentKHR, None, None, __VA_ARGS__)
+#define vkQueueSubmit(...) VK_COUNTED(vkQueueSubmit, None, None, __VA_ARGS__)
+#define vkQueueWaitIdle(...) VK_COUNTED(vkQueueWaitIdle, None, None, __VA_ARGS__)
+#define vkResetCommandBuffer(...) VK_COUNTED(vkResetCommandBuffer, None, None, __VA_ARGS__)
+#define vkResetFences(...) VK_COUNTED(vkResetFences, None, None, __VA_ARGS__)
+#define vkUnmapMemory(...) VK_COUNTED(vkUnmapMemory, None, None, __VA_ARGS__)
+#define vkUpdateDescriptorSets(...) VK_COUNTED(vkUpdateDescriptorSets, None, None, __VA_ARGS__)
+#define vkWaitForFences(...) VK_COUNTED(vkWaitForFences, None, None, __VA_ARGS__)
@@ -1,13 +1,33 @@
 #include "volume_generator.h"
 #include <iostream>
+#include <algorithm>
+#include <limits>
+#include <chrono>
 #include <glm/glm.hpp>
 
+namespace {
+    // Column prepass sampling: 3x3 points across the column footprint, one level every 8m
+    constexpr int COLUMN_SAMPLES_XZ = 3;
+    constexpr float COLUMN_SCAN_MIN_Y = -128.0f;
+    constexpr float COLUMN_SCAN_MAX_Y = 128.0f;
+    constexpr float COLUMN_SCAN_STEP = 8.0f;
+    constexpr int COLUMN_SCAN_LEVELS = static_cast<int>((COLUMN_SCAN_MAX_Y - COLUMN_SCAN_MIN_Y) / COLUMN_SCAN_STEP) + 1;
+
+    // Density slack for terms the prepass doesn't sample: fine detail (+-0.5) plus
+    // variation of the base noise between coarse samples
+    constexpr float COLUMN_DENSITY_MARGIN = 1.5f;
+
+    // Caves only carve, so they can open the ground up below the smooth surface.
+    // Extend the range down far enough that cave mouths still get loaded.
+    constexpr float COLUMN_CAVE_MOUTH_DEPTH = 16.0f;
+}
+
 VolumeGenerator::VolumeGenerator() {
     // Large-scale terrain shapes (continents, mountains)
     terrainNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
     terrainNoise.SetFrequency(0.005f);  // Very large features
     terrainNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
-    terrainNoise.SetFractalOctaves(4);
+    terrainNoise.SetFractalOctaves(octaves.terrain);
     terrainNoise.SetFractalLacunarity(2.0f);
     terrainNoise.SetFractalGain(0.5f);
 
@@ -15,24 +35,106 @@ VolumeGenerator::VolumeGenerator() {
     caveNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
     caveNoise.SetFrequency(0.02f);  // Medium-sized caves
     caveNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
-    caveNoise.SetFractalOctaves(2);
+    caveNoise.SetFractalOctaves(octaves.caves);
 
     // Small-scale detail (bumps, cracks)
     detailNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
     detailNoise.SetFrequency(0.05f);  // Fine detail
     detailNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
-    detailNoise.SetFractalOctaves(2);
+    detailNoise.SetFractalOctaves(octaves.detail);
+}
+
+void VolumeGenerator::setOctaves(const NoiseOctaves& newOctaves) {
+    octaves = newOctaves;
+    terrainNoise.SetFractalOctaves(octaves.terrain);
+    caveNoise.SetFractalOctaves(octaves.caves);
+    detailNoise.SetFractalOctaves(octaves.detail);
+
+    // Tiles hold the old field; bake them again with the same layout
+    for (NoiseField field : {NoiseField::Terrain, NoiseField::Caves}) {
+        NoiseTile& tile = fieldTile(field);
+        if (tile.isReady()) {
+            tile.bake(fieldNoise(field), tile.getResolution(), tile.getPeriod());
+        }
+    }
+}
+
+bool VolumeGenerator::useTiledField(NoiseField field, int resolution, float period, const std::string& cachePath) {
+    const char* name = field == NoiseField::Terrain ? "terrain" : "cave";
+    NoiseTile& tile = fieldTile(field);
+
+    if (!cachePath.empty() && tile.load(cachePath, fieldNoise(field), resolution, period)) {
+        std::cout << "Loaded " << name << " noise tile from " << cachePath << std::endl;
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    tile.bake(fieldNoise(field), resolution, period);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Baked " << name << " noise tile (" << resolution << "^3, "
+              << tile.memoryBytes() / (1024 * 1024) << " MB) in "
+              << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+    if (!cachePath.empty() && !tile.save(cachePath)) {
+        std::cout << "Failed to write noise tile cache " << cachePath << std::endl;
+    }
+    return false;
+}
+
+void VolumeGenerator::useProceduralField(NoiseField field) {
+    fieldTile(field) = NoiseTile();
+}
+
+float VolumeGenerator::sampleField(NoiseField field, float x, float y, float z) const {
+    const NoiseTile& tile = fieldTile(field);
+    if (tile.isReady()) {
+        return tile.sample(x, y, z);
+    }
+    return fieldNoise(field).GetNoise(x, y, z);
+}
+
+void VolumeGenerator::sampleFieldRow(NoiseField field, float x, float y, const float* zs, float zScale,
+                                     int count, float* out) const {
+    const NoiseTile& tile = fieldTile(field);
+    if (tile.isReady()) {
+        tile.sampleRow(x, y, zs, zScale, count, out);
+        return;
+    }
+    const FastNoiseLite& noise = fieldNoise(field);
+    for (int i = 0; i < count; i++) {
+        out[i] = noise.GetNoise(x, y, zs[i] * zScale);
+    }
 }
 
 void VolumeGenerator::generateChunk(VolumeChunk& chunk) {
+    initChunkBounds(chunk);
+    generateSlab(chunk, 0, CHUNK_SIZE);
+}
+
+void VolumeGenerator::initChunkBounds(VolumeChunk& chunk) const {
     glm::vec3 chunkWorldPos = chunkToWorldPos(chunk.coord);
 
     // Set chunk bounds
     chunk.worldMin = chunkWorldPos;
     chunk.worldMax = chunkWorldPos + glm::vec3(CHUNK_WORLD_SIZE);
+}
+
+void VolumeGenerator::generateSlab(VolumeChunk& chunk, int xBegin, int xEnd) {
+    if (backend == GeneratorBackend::Fused) {
+        generateSlabFused(chunk, xBegin, xEnd);
+    } else {
+        generateSlabReference(chunk, xBegin, xEnd);
+    }
+
+    // Only the stamps binned to this chunk, and only over their bounds
+    stamps.applyToChunk(chunk, xBegin, xEnd);
+}
+
+void VolumeGenerator::generateSlabReference(VolumeChunk& chunk, int xBegin, int xEnd) {
+    glm::vec3 chunkWorldPos = chunkToWorldPos(chunk.coord);
 
     // Generate SDF for each voxel
-    for (int x = 0; x < CHUNK_SIZE; x++) {
+    for (int x = xBegin; x < xEnd; x++) {
         for (int y = 0; y < CHUNK_SIZE; y++) {
             for (int z = 0; z < CHUNK_SIZE; z++) {
                 // World position of this voxel
@@ -43,18 +145,186 @@ void VolumeGenerator::generateChunk(VolumeChunk& chunk) {
                 );
 
                 // Generate SDF value
-                chunk.sdf[x][y][z] = generateSDF(voxelWorldPos);
+                chunk.sdf->at(x, y, z) = terrainSDF(voxelWorldPos);
+            }
+        }
+    }
+
+}
+
+void VolumeGenerator::generateCoarseChunk(ChunkCoord coord, int stride, SdfMipLevel& level) {
+    level.size = CHUNK_CUBES / stride + 1;
+    level.voxelSize = VOXEL_SIZE * stride;
+    level.origin = chunkToWorldPos(coord);
+    level.values.resize(static_cast<size_t>(level.size) * level.size * level.size);
+
+    // Every sample is on the chunk's lattice, so its bin holds all stamps that can reach it
+    const std::vector<uint32_t>* candidates = stamps.chunkCandidates(coord);
+    size_t out = 0;
+    for (int x = 0; x < level.size; x++) {
+        for (int y = 0; y < level.size; y++) {
+            for (int z = 0; z < level.size; z++) {
+                glm::vec3 worldPos = level.origin + glm::vec3(x, y, z) * level.voxelSize;
+                float value = terrainSDF(worldPos);
+                level.values[out++] = candidates ? stamps.apply(*candidates, worldPos, value) : value;
+            }
+        }
+    }
+}
+
+void VolumeGenerator::generateSlabFused(VolumeChunk& chunk, int xBegin, int xEnd) {
+    // Same terms and the same float operations as terrainSDF, so results are bit-identical.
+    // The differences are evaluation order and hoisting:
+    // - ground variation only depends on (x, z): sampled once per column, not per voxel
+    // - each noise field is swept across a whole z-row before the next one, so one
+    //   generator's state and lookup tables stay hot instead of cycling through all four
+    // - y-dependent terms (vertical gradient, island band test) are computed once per row
+    glm::vec3 chunkWorldPos = chunkToWorldPos(chunk.coord);
+
+    float worldX[CHUNK_SIZE];
+    float worldY[CHUNK_SIZE];
+    float worldZ[CHUNK_SIZE];
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+        worldX[i] = chunkWorldPos.x + i * VOXEL_SIZE;
+        worldY[i] = chunkWorldPos.y + i * VOXEL_SIZE;
+        worldZ[i] = chunkWorldPos.z + i * VOXEL_SIZE;
+    }
+
+    float ground[CHUNK_SIZE][CHUNK_SIZE];
+    for (int x = xBegin; x < xEnd; x++) {
+        sampleFieldRow(NoiseField::Terrain, worldX[x] * 0.2f, 0.0f, worldZ, 0.2f, CHUNK_SIZE, ground[x]);
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            ground[x][z] *= 15.0f;
+        }
+    }
+
+    float base[CHUNK_SIZE];
+    float caves[CHUNK_SIZE];
+    float island[CHUNK_SIZE];
+    float detail[CHUNK_SIZE];
+    const float caveThreshold = 0.3f;
+
+    for (int x = xBegin; x < xEnd; x++) {
+        const float wx = worldX[x];
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            const float wy = worldY[y];
+            const float verticalGradient = -wy * 0.04f;
+            const bool islandBand = wy > 15.0f && wy < 40.0f;
+
+            sampleFieldRow(NoiseField::Terrain, wx, wy, worldZ, 1.0f, CHUNK_SIZE, base);
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                base[z] *= 3.0f;
+            }
+            if (islandBand) {
+                sampleFieldRow(NoiseField::Terrain, wx * 0.4f, wy * 0.4f, worldZ, 0.4f, CHUNK_SIZE, island);
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    island[z] *= 4.0f;
+                }
+            }
+            sampleFieldRow(NoiseField::Caves, wx, wy, worldZ, 1.0f, CHUNK_SIZE, caves);
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                detail[z] = detailNoise.GetNoise(wx, wy, worldZ[z]) * 0.5f;
+            }
+
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                float density = base[z] + verticalGradient;
+                density += (ground[x][z] - wy) * 0.03f;
+                if (caves[z] > caveThreshold) {
+                    density -= (caves[z] - caveThreshold) * 8.0f;
+                }
+                if (islandBand) {
+                    density += island[z];
+                }
+                density += detail[z];
+                chunk.sdf->at(x, y, z) = density * 3.0f;
             }
         }
     }
+}
+
+ColumnSurfaceBounds VolumeGenerator::estimateColumnBounds(ColumnCoord column) const {
+    const float step = CHUNK_WORLD_SIZE / (COLUMN_SAMPLES_XZ - 1);
+    const float baseX = column.x * CHUNK_WORLD_SIZE;
+    const float baseZ = column.z * CHUNK_WORLD_SIZE;
+
+    // Ground variation doesn't depend on y, so sample it once per xz point
+    float ground[COLUMN_SAMPLES_XZ][COLUMN_SAMPLES_XZ];
+    for (int i = 0; i < COLUMN_SAMPLES_XZ; i++) {
+        for (int k = 0; k < COLUMN_SAMPLES_XZ; k++) {
+            float x = baseX + i * step;
+            float z = baseZ + k * step;
+            ground[i][k] = sampleField(NoiseField::Terrain, x * 0.2f, 0.0f, z * 0.2f) * 15.0f;
+        }
+    }
+
+    // Min/max of the smooth density terms (same as terrainSDF minus caves and detail) per level
+    float levelMin[COLUMN_SCAN_LEVELS];
+    float levelMax[COLUMN_SCAN_LEVELS];
+    for (int level = 0; level < COLUMN_SCAN_LEVELS; level++) {
+        float y = COLUMN_SCAN_MIN_Y + level * COLUMN_SCAN_STEP;
+        levelMin[level] = std::numeric_limits<float>::max();
+        levelMax[level] = std::numeric_limits<float>::lowest();
+
+        for (int i = 0; i < COLUMN_SAMPLES_XZ; i++) {
+            for (int k = 0; k < COLUMN_SAMPLES_XZ; k++) {
+                float x = baseX + i * step;
+                float z = baseZ + k * step;
+
+                float density = sampleField(NoiseField::Terrain, x, y, z) * 3.0f - y * 0.04f;
+                density += (ground[i][k] - y) * 0.03f;
+                if (y > 15.0f && y < 40.0f) {
+                    density += sampleField(NoiseField::Terrain, x * 0.4f, y * 0.4f, z * 0.4f) * 4.0f;
+                }
+
+                levelMin[level] = std::min(levelMin[level], density);
+                levelMax[level] = std::max(levelMax[level], density);
+            }
+        }
+    }
+
+    // A slab between two levels can hold surface if its density range straddles zero
+    ColumnSurfaceBounds bounds;
+    for (int level = 0; level + 1 < COLUMN_SCAN_LEVELS; level++) {
+        float lo = std::min(levelMin[level], levelMin[level + 1]) - COLUMN_DENSITY_MARGIN;
+        float hi = std::max(levelMax[level], levelMax[level + 1]) + COLUMN_DENSITY_MARGIN;
+        if (lo >= 0.0f || hi <= 0.0f) {
+            continue;
+        }
+
+        float slabBottom = COLUMN_SCAN_MIN_Y + level * COLUMN_SCAN_STEP;
+        float slabTop = slabBottom + COLUMN_SCAN_STEP;
+        if (!bounds.hasSurface) {
+            bounds.minY = slabBottom;
+            bounds.hasSurface = true;
+        }
+        bounds.maxY = slabTop;
+    }
+
+    if (bounds.hasSurface) {
+        bounds.minY -= COLUMN_CAVE_MOUTH_DEPTH;
+    }
+
+    // Stamps can add surface anywhere inside their bounds (a pillar above the ground, an arch in the sky)
+    float stampMinY = 0.0f;
+    float stampMaxY = 0.0f;
+    if (stamps.columnRange(column, stampMinY, stampMaxY)) {
+        bounds.minY = bounds.hasSurface ? std::min(bounds.minY, stampMinY) : stampMinY;
+        bounds.maxY = bounds.hasSurface ? std::max(bounds.maxY, stampMaxY) : stampMaxY;
+        bounds.hasSurface = true;
+    }
+
+    return bounds;
+}
 
+float VolumeGenerator::generateSDF(glm::vec3 worldPos) const {
+    return stamps.apply(worldPos, terrainSDF(worldPos));
 }
 
-float VolumeGenerator::generateSDF(glm::vec3 worldPos) {
+float VolumeGenerator::terrainSDF(glm::vec3 worldPos) const {
     // True volumetric terrain generation using 3D density functions
 
     // 1. Start with STRONG 3D base terrain density
-    float baseDensity = terrainNoise.GetNoise(worldPos.x, worldPos.y, worldPos.z) * 3.0f;  // Amplified!
+    float baseDensity = sampleField(NoiseField::Terrain, worldPos.x, worldPos.y, worldPos.z) * 3.0f;  // Amplified!
 
     // 2. WEAK vertical gradient so overhangs can form
     float verticalGradient = -worldPos.y * 0.04f;  // Reduced from 0.08
@@ -63,11 +333,11 @@ float VolumeGenerator::generateSDF(glm::vec3 worldPos) {
     float density = baseDensity + verticalGradient;
 
     // 4. Add dramatic ground variation
-    float groundVariation = terrainNoise.GetNoise(worldPos.x * 0.2f, 0.0f, worldPos.z * 0.2f) * 15.0f;  // More dramatic!
+    float groundVariation = sampleField(NoiseField::Terrain, worldPos.x * 0.2f, 0.0f, worldPos.z * 0.2f) * 15.0f;  // More dramatic!
     density += (groundVariation - worldPos.y) * 0.03f;
 
     // 5. AGGRESSIVE cave carving
-    float caves = caveNoise.GetNoise(worldPos.x, worldPos.y, worldPos.z);
+    float caves = sampleField(NoiseField::Caves, worldPos.x, worldPos.y, worldPos.z);
     float caveThreshold = 0.3f;  // Lower threshold = more caves
 
     // Caves everywhere (not just underground)
@@ -78,7 +348,7 @@ float VolumeGenerator::generateSDF(glm::vec3 worldPos) {
 
     // 6. STRONG floating islands in sky (y > 15)
     if (worldPos.y > 15.0f && worldPos.y < 40.0f) {
-        float islandNoise = terrainNoise.GetNoise(worldPos.x * 0.4f, worldPos.y * 0.4f, worldPos.z * 0.4f);
+        float islandNoise = sampleField(NoiseField::Terrain, worldPos.x * 0.4f, worldPos.y * 0.4f, worldPos.z * 0.4f);
         float islandDensity = islandNoise * 4.0f;  // Much stronger!
         density += islandDensity;
     }
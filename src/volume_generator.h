@@ -1,7 +1,43 @@
 #pragma once
 
 #include "chunk.h"
+#include "noise_tile.h"
+#include "sdf_mip.h"
+#include "sdf_stamps.h"
 #include <FastNoiseLite.h>
+#include <string>
+
+// Estimated world-space height range in which a chunk column can contain surface
+struct ColumnSurfaceBounds {
+    float minY = 0.0f;
+    float maxY = 0.0f;
+    bool hasSurface = false;  // False if the whole scanned range is solid or air
+};
+
+// How generateChunk evaluates the noise fields
+enum class GeneratorBackend {
+    Reference,  // terrainSDF per voxel: every field sampled independently
+    Fused       // Row-batched: shares coordinate setup and y-invariant terms across fields
+};
+
+// Fractal octave counts for each noise field (detail vs cost)
+struct NoiseOctaves {
+    int terrain = 4;
+    int caves = 2;
+    int detail = 2;
+};
+
+// Low-frequency noise fields that can be swapped for a precomputed tile
+enum class NoiseField {
+    Terrain,  // Base shapes, ground variation and islands
+    Caves
+};
+
+// Tile layouts used for the tiled fields (vulkan_app's tiled_noise setting and terrain_bench)
+constexpr int TERRAIN_TILE_RESOLUTION = 128;
+constexpr float TERRAIN_TILE_PERIOD = 1024.0f;
+constexpr int CAVE_TILE_RESOLUTION = 64;
+constexpr float CAVE_TILE_PERIOD = 256.0f;
 
 class VolumeGenerator {
 public:
@@ -10,11 +46,68 @@ public:
     // Generate SDF volume data for a chunk
     void generateChunk(VolumeChunk& chunk);
 
+    // Split form of generateChunk so several threads can fill one chunk:
+    // initChunkBounds once, then generateSlab over disjoint x-ranges [xBegin, xEnd)
+    void initChunkBounds(VolumeChunk& chunk) const;
+    void generateSlab(VolumeChunk& chunk, int xBegin, int xEnd);
+
+    // Every stride-th sample of a chunk's SDF, (CHUNK_CUBES / stride + 1)^3 in all, for a quick
+    // first mesh. Samples coincide with full-resolution ones, so the surface only loses detail.
+    void generateCoarseChunk(ChunkCoord coord, int stride, SdfMipLevel& level);
+
+    // SDF value at any world position; at voxel positions it matches what generateChunk
+    // stores there. Safe to call while chunks generate.
+    float generateSDF(glm::vec3 worldPos) const;
+
+    // Hand-authored primitives merged into the noise terrain, applied in order.
+    // Not thread-safe: no chunk may be generating while this runs.
+    void setStamps(std::vector<SdfStamp> newStamps) { stamps.setStamps(std::move(newStamps)); }
+    const StampSet& getStamps() const { return stamps; }
+
+    void setBackend(GeneratorBackend newBackend) { backend = newBackend; }
+    GeneratorBackend getBackend() const { return backend; }
+
+    // Not thread-safe: no chunk may be generating while this runs. Tiled fields are rebaked.
+    void setOctaves(const NoiseOctaves& newOctaves);
+    const NoiseOctaves& getOctaves() const { return octaves; }
+
+    // Cheap prepass: estimate where the surface can be in a chunk column from coarse
+    // samples of the smooth terrain terms (base density, ground and island shapes)
+    ColumnSurfaceBounds estimateColumnBounds(ColumnCoord column) const;
+
+    // Sample a field from a periodic tile instead of procedural noise. Loads the tile
+    // from cachePath if it matches, otherwise bakes it (and saves it if a path is given).
+    // Tiled fields are an approximation; returns false if the tile had to be baked.
+    bool useTiledField(NoiseField field, int resolution, float period, const std::string& cachePath = "");
+    void useProceduralField(NoiseField field);
+    bool isFieldTiled(NoiseField field) const { return fieldTile(field).isReady(); }
+    size_t tileMemoryBytes() const { return terrainTile.memoryBytes() + caveTile.memoryBytes(); }
+
 private:
     FastNoiseLite terrainNoise;    // Large-scale terrain shapes
     FastNoiseLite caveNoise;       // Cave systems
     FastNoiseLite detailNoise;     // Small-scale detail
 
-    // Generate SDF value at a world position
-    float generateSDF(glm::vec3 worldPos);
+    // Optional tabulated versions of the low-frequency fields (empty = procedural)
+    NoiseTile terrainTile;
+    NoiseTile caveTile;
+
+    GeneratorBackend backend = GeneratorBackend::Fused;
+    NoiseOctaves octaves;
+    StampSet stamps;
+
+    const FastNoiseLite& fieldNoise(NoiseField field) const { return field == NoiseField::Terrain ? terrainNoise : caveNoise; }
+    const NoiseTile& fieldTile(NoiseField field) const { return field == NoiseField::Terrain ? terrainTile : caveTile; }
+    NoiseTile& fieldTile(NoiseField field) { return field == NoiseField::Terrain ? terrainTile : caveTile; }
+
+    // Field lookups that go to the tile when one is loaded
+    float sampleField(NoiseField field, float x, float y, float z) const;
+    void sampleFieldRow(NoiseField field, float x, float y, const float* zs, float zScale, int count, float* out) const;
+
+    // The noise terrain alone, before stamps
+    float terrainSDF(glm::vec3 worldPos) const;
+
+    void generateSlabReference(VolumeChunk& chunk, int xBegin, int xEnd);
+    // Fused backend: evaluates one z-row of voxels per field pass
+    void generateSlabFused(VolumeChunk& chunk, int xBegin, int xEnd);
 };